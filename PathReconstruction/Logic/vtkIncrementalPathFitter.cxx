@@ -0,0 +1,296 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkIncrementalPathFitter.h"
+
+// vtk includes
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// STD includes
+#include <cmath>
+
+vtkStandardNewMacro( vtkIncrementalPathFitter );
+
+//------------------------------------------------------------------------------
+vtkIncrementalPathFitter::vtkIncrementalPathFitter()
+{
+  this->TubeRadius = 1.0;
+  this->TubeNumberOfSides = 8;
+  this->OutputTube = true;
+  this->CurveLength = 0.0;
+  this->InputPoints = vtkSmartPointer< vtkPoints >::New();
+
+  this->Output = vtkSmartPointer< vtkPolyData >::New();
+  vtkSmartPointer< vtkPoints > outputPoints = vtkSmartPointer< vtkPoints >::New();
+  this->Output->SetPoints( outputPoints );
+  vtkSmartPointer< vtkCellArray > outputPolys = vtkSmartPointer< vtkCellArray >::New();
+  this->Output->SetPolys( outputPolys );
+  vtkSmartPointer< vtkCellArray > outputLines = vtkSmartPointer< vtkCellArray >::New();
+  this->Output->SetLines( outputLines );
+  this->OutputNormals = vtkSmartPointer< vtkFloatArray >::New();
+  this->OutputNormals->SetName( "Normals" );
+  this->OutputNormals->SetNumberOfComponents( 3 );
+  this->Output->GetPointData()->SetNormals( this->OutputNormals );
+}
+
+//------------------------------------------------------------------------------
+vtkIncrementalPathFitter::~vtkIncrementalPathFitter()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkIncrementalPathFitter::PrintSelf( ostream& os, vtkIndent indent )
+{
+  this->Superclass::PrintSelf( os, indent );
+  os << indent << "TubeRadius: " << this->TubeRadius << std::endl;
+  os << indent << "TubeNumberOfSides: " << this->TubeNumberOfSides << std::endl;
+  os << indent << "OutputTube: " << this->OutputTube << std::endl;
+  os << indent << "NumberOfPoints: " << this->InputPoints->GetNumberOfPoints() << std::endl;
+  os << indent << "CurveLength: " << this->CurveLength << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void vtkIncrementalPathFitter::Reset()
+{
+  this->InputPoints->Reset();
+  this->RingTangents.clear();
+  this->RingNormals.clear();
+  this->CurveLength = 0.0;
+
+  this->Output->GetPoints()->Reset();
+  this->Output->GetPolys()->Reset();
+  this->Output->GetLines()->Reset();
+  this->OutputNormals->Reset();
+  // a polyline has no surface normals
+  this->Output->GetPointData()->SetNormals( this->OutputTube ? this->OutputNormals.GetPointer() : NULL );
+  this->Output->GetPoints()->Modified();
+  this->Output->GetPolys()->Modified();
+  this->Output->GetLines()->Modified();
+  this->Output->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkIncrementalPathFitter::SetOutputTube( bool outputTube )
+{
+  if ( this->OutputTube == outputTube )
+  {
+    return;
+  }
+  this->OutputTube = outputTube;
+  this->Reset();
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkIncrementalPathFitter::AppendPoints( vtkPoints* points, vtkIdType firstPointIndex )
+{
+  if ( points == NULL )
+  {
+    vtkErrorMacro( "Points are null. Cannot append points." );
+    return;
+  }
+
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  for ( vtkIdType pointIndex = firstPointIndex; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    double point[ 3 ];
+    points->GetPoint( pointIndex, point );
+    this->AppendPoint( point );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkIncrementalPathFitter::AppendPoint( const double point[ 3 ] )
+{
+  int ringIndex = this->InputPoints->GetNumberOfPoints();
+  double previousPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+  if ( ringIndex > 0 )
+  {
+    this->InputPoints->GetPoint( ringIndex - 1, previousPoint );
+    double segmentLength2 = vtkMath::Distance2BetweenPoints( previousPoint, point );
+    if ( segmentLength2 <= 0.0 )
+    {
+      return; // a zero-length segment has no direction
+    }
+    this->CurveLength += std::sqrt( segmentLength2 );
+  }
+
+  this->InputPoints->InsertNextPoint( point );
+  this->RingTangents.resize( 3 * ( ringIndex + 1 ), 0.0 );
+  this->RingNormals.resize( 3 * ( ringIndex + 1 ), 0.0 );
+
+  if ( !this->OutputTube )
+  {
+    this->AppendPolylinePoint( ringIndex, point );
+    return;
+  }
+
+  if ( ringIndex == 0 )
+  {
+    return; // a single sample does not define a tube yet
+  }
+
+  double segmentDirection[ 3 ];
+  vtkMath::Subtract( point, previousPoint, segmentDirection );
+  vtkMath::Normalize( segmentDirection );
+
+  if ( ringIndex == 1 )
+  {
+    this->ComputeRingFrame( 0, segmentDirection );
+    this->SetRing( 0 );
+  }
+  else
+  {
+    // The previous sample now has a segment on both sides,
+    // so its ring is re-oriented to the average of the two directions.
+    double averageDirection[ 3 ];
+    vtkMath::Add( &this->RingTangents[ 3 * ( ringIndex - 1 ) ], segmentDirection, averageDirection );
+    if ( vtkMath::Normalize( averageDirection ) == 0.0 )
+    {
+      averageDirection[ 0 ] = segmentDirection[ 0 ];
+      averageDirection[ 1 ] = segmentDirection[ 1 ];
+      averageDirection[ 2 ] = segmentDirection[ 2 ];
+    }
+    this->ComputeRingFrame( ringIndex - 1, averageDirection );
+    this->SetRing( ringIndex - 1 );
+  }
+
+  this->ComputeRingFrame( ringIndex, segmentDirection );
+  this->SetRing( ringIndex );
+  this->AddRingConnections( ringIndex );
+
+  this->Output->GetPoints()->Modified();
+  this->Output->GetPolys()->Modified();
+  this->OutputNormals->Modified();
+  this->Output->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkIncrementalPathFitter::AppendPolylinePoint( int pointIndex, const double point[ 3 ] )
+{
+  this->Output->GetPoints()->InsertPoint( pointIndex, point );
+  if ( pointIndex > 0 )
+  {
+    vtkIdType line[ 2 ];
+    line[ 0 ] = pointIndex - 1;
+    line[ 1 ] = pointIndex;
+    this->Output->GetLines()->InsertNextCell( 2, line );
+  }
+  this->Output->GetPoints()->Modified();
+  this->Output->GetLines()->Modified();
+  this->Output->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkIncrementalPathFitter::ComputeRingFrame( int ringIndex, const double tangent[ 3 ] )
+{
+  double* ringTangent = &this->RingTangents[ 3 * ringIndex ];
+  double* ringNormal = &this->RingNormals[ 3 * ringIndex ];
+  ringTangent[ 0 ] = tangent[ 0 ];
+  ringTangent[ 1 ] = tangent[ 1 ];
+  ringTangent[ 2 ] = tangent[ 2 ];
+
+  // Carry the normal over from the previous ring (parallel transport) so the tube does not twist
+  double normalLength = 0.0;
+  if ( ringIndex > 0 )
+  {
+    const double* previousNormal = &this->RingNormals[ 3 * ( ringIndex - 1 ) ];
+    double projection = vtkMath::Dot( previousNormal, tangent );
+    ringNormal[ 0 ] = previousNormal[ 0 ] - projection * tangent[ 0 ];
+    ringNormal[ 1 ] = previousNormal[ 1 ] - projection * tangent[ 1 ];
+    ringNormal[ 2 ] = previousNormal[ 2 ] - projection * tangent[ 2 ];
+    normalLength = vtkMath::Normalize( ringNormal );
+  }
+  if ( normalLength <= 0.0 )
+  {
+    double binormal[ 3 ];
+    vtkMath::Perpendiculars( tangent, ringNormal, binormal, 0.0 );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkIncrementalPathFitter::SetRing( int ringIndex )
+{
+  double center[ 3 ];
+  this->InputPoints->GetPoint( ringIndex, center );
+  const double* tangent = &this->RingTangents[ 3 * ringIndex ];
+  const double* normal = &this->RingNormals[ 3 * ringIndex ];
+  double binormal[ 3 ];
+  vtkMath::Cross( tangent, normal, binormal );
+
+  vtkPoints* outputPoints = this->Output->GetPoints();
+  vtkDataArray* outputNormals = this->OutputNormals;
+  for ( int sideIndex = 0; sideIndex < this->TubeNumberOfSides; sideIndex++ )
+  {
+    double angle = 2.0 * vtkMath::Pi() * sideIndex / this->TubeNumberOfSides;
+    double cosAngle = std::cos( angle );
+    double sinAngle = std::sin( angle );
+    double direction[ 3 ];
+    direction[ 0 ] = cosAngle * normal[ 0 ] + sinAngle * binormal[ 0 ];
+    direction[ 1 ] = cosAngle * normal[ 1 ] + sinAngle * binormal[ 1 ];
+    direction[ 2 ] = cosAngle * normal[ 2 ] + sinAngle * binormal[ 2 ];
+    double surfacePoint[ 3 ];
+    surfacePoint[ 0 ] = center[ 0 ] + this->TubeRadius * direction[ 0 ];
+    surfacePoint[ 1 ] = center[ 1 ] + this->TubeRadius * direction[ 1 ];
+    surfacePoint[ 2 ] = center[ 2 ] + this->TubeRadius * direction[ 2 ];
+    vtkIdType surfacePointId = ringIndex * this->TubeNumberOfSides + sideIndex;
+    outputPoints->InsertPoint( surfacePointId, surfacePoint );
+    outputNormals->InsertTuple( surfacePointId, direction );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkIncrementalPathFitter::AddRingConnections( int ringIndex )
+{
+  vtkCellArray* outputPolys = this->Output->GetPolys();
+  vtkIdType previousRingStart = ( ringIndex - 1 ) * this->TubeNumberOfSides;
+  vtkIdType currentRingStart = ringIndex * this->TubeNumberOfSides;
+  for ( int sideIndex = 0; sideIndex < this->TubeNumberOfSides; sideIndex++ )
+  {
+    int nextSideIndex = ( sideIndex + 1 ) % this->TubeNumberOfSides;
+    vtkIdType quad[ 4 ];
+    quad[ 0 ] = previousRingStart + sideIndex;
+    quad[ 1 ] = previousRingStart + nextSideIndex;
+    quad[ 2 ] = currentRingStart + nextSideIndex;
+    quad[ 3 ] = currentRingStart + sideIndex;
+    outputPolys->InsertNextCell( 4, quad );
+  }
+}
+
+//------------------------------------------------------------------------------
+int vtkIncrementalPathFitter::GetNumberOfPoints()
+{
+  return this->InputPoints->GetNumberOfPoints();
+}
+
+//------------------------------------------------------------------------------
+double vtkIncrementalPathFitter::GetCurveLength()
+{
+  return this->CurveLength;
+}
+
+//------------------------------------------------------------------------------
+vtkPolyData* vtkIncrementalPathFitter::GetOutput()
+{
+  return this->Output;
+}
@@ -0,0 +1,101 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkIncrementalPathFitter_h
+#define __vtkIncrementalPathFitter_h
+
+// vtk includes
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <vector>
+
+class vtkFloatArray;
+class vtkPoints;
+class vtkPolyData;
+
+#include "vtkSlicerPathReconstructionModuleLogicExport.h"
+
+/// \ingroup Slicer_QtModules_PathReconstruction
+/// Builds a tube (or a polyline) around a path one sample at a time.
+/// Appending a sample only touches the last ring of the tube and adds one new ring,
+/// so the cost per sample does not depend on the length of the path. This is
+/// intended for live display while recording - a full refit through MarkupsToModel
+/// should be done once recording is finished.
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_LOGIC_EXPORT vtkIncrementalPathFitter : public vtkObject
+{
+public:
+  static vtkIncrementalPathFitter* New();
+  vtkTypeMacro( vtkIncrementalPathFitter, vtkObject );
+  void PrintSelf( ostream& os, vtkIndent indent );
+
+  vtkGetMacro( TubeRadius, double );
+  vtkSetMacro( TubeRadius, double );
+
+  vtkGetMacro( TubeNumberOfSides, int );
+  vtkSetClampMacro( TubeNumberOfSides, int, 3, VTK_INT_MAX );
+
+  // If false, the output is a polyline through the samples instead of a tube.
+  // Changing it resets the fitter.
+  vtkGetMacro( OutputTube, bool );
+  void SetOutputTube( bool outputTube );
+  vtkBooleanMacro( OutputTube, bool );
+
+  // Remove all samples and clear the output (the output object itself is kept)
+  void Reset();
+
+  // Extend the path by one sample. Samples that coincide with the previous sample are ignored.
+  void AppendPoint( const double point[ 3 ] );
+
+  // Append all points from index firstPointIndex onwards
+  void AppendPoints( vtkPoints* points, vtkIdType firstPointIndex );
+
+  int GetNumberOfPoints();
+  double GetCurveLength();
+
+  // The tube surface. The same object is returned for the lifetime of the fitter.
+  vtkPolyData* GetOutput();
+
+protected:
+  vtkIncrementalPathFitter();
+  virtual ~vtkIncrementalPathFitter();
+
+private:
+  void ComputeRingFrame( int ringIndex, const double tangent[ 3 ] );
+  void SetRing( int ringIndex );
+  void AddRingConnections( int ringIndex );
+  void AppendPolylinePoint( int pointIndex, const double point[ 3 ] );
+
+  double TubeRadius;
+  int TubeNumberOfSides;
+  bool OutputTube;
+  double CurveLength;
+
+  // input samples, and the tangent/normal frame at each sample
+  vtkSmartPointer< vtkPoints > InputPoints;
+  std::vector< double > RingTangents;
+  std::vector< double > RingNormals;
+
+  vtkSmartPointer< vtkPolyData > Output;
+  vtkSmartPointer< vtkFloatArray > OutputNormals;
+
+  vtkIncrementalPathFitter( const vtkIncrementalPathFitter& ); // Not implemented
+  void operator=( const vtkIncrementalPathFitter& ); // Not implemented
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkPathFitter.h"
+
+// MarkupsToModel includes
+#include "vtkCurveGenerator.h"
+#include "vtkMRMLMarkupsToModelNode.h"
+
+// vtk includes
+#include <vtkCellArray.h>
+#include <vtkCleanPolyData.h>
+#include <vtkIdTypeArray.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkTubeFilter.h>
+
+// Constants ------------------------------------------------------------------
+// Same tolerance as MarkupsToModel uses to clean the markups before fitting a curve
+static const double CLEAN_MARKUPS_TOLERANCE = 0.01;
+
+vtkStandardNewMacro( vtkPathFitter );
+
+//------------------------------------------------------------------------------
+vtkPathFitter::vtkPathFitter()
+{
+  this->TubeRadius = 1.0;
+  this->TubeNumberOfSides = 8;
+  this->CleanMarkups = true;
+  this->OutputCurveLength = 0.0;
+  this->PointCleaner = vtkSmartPointer< vtkCleanPolyData >::New();
+  this->PointCleaner->SetTolerance( CLEAN_MARKUPS_TOLERANCE );
+  this->CurveGenerator = vtkSmartPointer< vtkCurveGenerator >::New();
+  this->CurveGenerator->SetCurveTypeToLinearSpline();
+  this->TubeFilter = vtkSmartPointer< vtkTubeFilter >::New();
+  this->TubeFilter->CappingOn();
+}
+
+//------------------------------------------------------------------------------
+vtkPathFitter::~vtkPathFitter()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkPathFitter::PrintSelf( ostream& os, vtkIndent indent )
+{
+  this->Superclass::PrintSelf( os, indent );
+  os << indent << "TubeRadius: " << this->TubeRadius << std::endl;
+  os << indent << "TubeNumberOfSides: " << this->TubeNumberOfSides << std::endl;
+  os << indent << "CleanMarkups: " << this->CleanMarkups << std::endl;
+  os << indent << "OutputCurveLength: " << this->OutputCurveLength << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathFitter::SetParametersFromMarkupsToModelNode( vtkMRMLMarkupsToModelNode* markupsToModelNode )
+{
+  if ( markupsToModelNode == NULL )
+  {
+    vtkErrorMacro( "MarkupsToModel node is null. Cannot copy fitting parameters." );
+    return;
+  }
+
+  this->TubeRadius = markupsToModelNode->GetTubeRadius();
+  this->TubeNumberOfSides = markupsToModelNode->GetTubeNumberOfSides();
+  this->CleanMarkups = markupsToModelNode->GetCleanMarkups();
+
+  // a closed loop has no ends to cap, caps would only add faces inside the tube
+  this->CurveGenerator->SetCurveIsLoop( markupsToModelNode->GetTubeLoop() );
+  this->TubeFilter->SetCapping( !markupsToModelNode->GetTubeLoop() );
+  this->CurveGenerator->SetNumberOfPointsPerInterpolatingSegment( markupsToModelNode->GetTubeSegmentsBetweenControlPoints() );
+  switch ( markupsToModelNode->GetCurveType() )
+  {
+  case vtkMRMLMarkupsToModelNode::CardinalSpline:
+    this->CurveGenerator->SetCurveTypeToCardinalSpline();
+    break;
+  case vtkMRMLMarkupsToModelNode::KochanekSpline:
+    this->CurveGenerator->SetCurveTypeToKochanekSpline();
+    this->CurveGenerator->SetKochanekBias( markupsToModelNode->GetKochanekBias() );
+    this->CurveGenerator->SetKochanekContinuity( markupsToModelNode->GetKochanekContinuity() );
+    this->CurveGenerator->SetKochanekTension( markupsToModelNode->GetKochanekTension() );
+    this->CurveGenerator->SetKochanekEndsCopyNearestDerivatives( markupsToModelNode->GetKochanekEndsCopyNearestDerivatives() );
+    break;
+  case vtkMRMLMarkupsToModelNode::Polynomial:
+    this->CurveGenerator->SetCurveTypeToPolynomial();
+    break;
+  default:
+    this->CurveGenerator->SetCurveTypeToLinearSpline();
+    break;
+  }
+
+  this->CurveGenerator->SetPolynomialOrder( markupsToModelNode->GetPolynomialOrder() );
+  this->CurveGenerator->SetPolynomialSampleWidth( markupsToModelNode->GetPolynomialSampleWidth() );
+  if ( markupsToModelNode->GetPointParameterType() == vtkMRMLMarkupsToModelNode::MinimumSpanningTree )
+  {
+    this->CurveGenerator->SetPolynomialPointSortingMethodToMinimumSpanningTreePosition();
+  }
+  else
+  {
+    this->CurveGenerator->SetPolynomialPointSortingMethodToIndex();
+  }
+  if ( markupsToModelNode->GetPolynomialFitType() == vtkMRMLMarkupsToModelNode::MovingLeastSquares )
+  {
+    this->CurveGenerator->SetPolynomialFitMethodToMovingLeastSquares();
+  }
+  else
+  {
+    this->CurveGenerator->SetPolynomialFitMethodToGlobalLeastSquares();
+  }
+  switch ( markupsToModelNode->GetPolynomialWeightType() )
+  {
+  case vtkMRMLMarkupsToModelNode::Triangular:
+    this->CurveGenerator->SetPolynomialWeightFunctionToTriangular();
+    break;
+  case vtkMRMLMarkupsToModelNode::Cosine:
+    this->CurveGenerator->SetPolynomialWeightFunctionToCosine();
+    break;
+  case vtkMRMLMarkupsToModelNode::Gaussian:
+    this->CurveGenerator->SetPolynomialWeightFunctionToGaussian();
+    break;
+  default:
+    this->CurveGenerator->SetPolynomialWeightFunctionToRectangular();
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkPathFitter::Fit( vtkPoints* inputPoints, vtkPolyData* outputPolyData )
+{
+  if ( outputPolyData == NULL )
+  {
+    vtkErrorMacro( "Output poly data is null. Cannot fit path." );
+    return false;
+  }
+
+  this->OutputCurveLength = 0.0;
+  if ( inputPoints == NULL || inputPoints->GetNumberOfPoints() < 2 )
+  {
+    outputPolyData->Initialize();
+    return false;
+  }
+
+  if ( this->CleanMarkups )
+  {
+    // merge coincident points (e.g. while the tool was still), keeping the order of the first occurrences
+    vtkIdType numberOfInputPoints = inputPoints->GetNumberOfPoints();
+    vtkSmartPointer< vtkIdTypeArray > vertConnectivity = vtkSmartPointer< vtkIdTypeArray >::New();
+    vertConnectivity->SetNumberOfValues( 2 * numberOfInputPoints );
+    vtkIdType* vertIds = vertConnectivity->GetPointer( 0 );
+    for ( vtkIdType pointIndex = 0; pointIndex < numberOfInputPoints; pointIndex++ )
+    {
+      vertIds[ 2 * pointIndex + 0 ] = 1;
+      vertIds[ 2 * pointIndex + 1 ] = pointIndex;
+    }
+    vtkSmartPointer< vtkCellArray > verts = vtkSmartPointer< vtkCellArray >::New();
+    verts->SetCells( numberOfInputPoints, vertConnectivity );
+    vtkSmartPointer< vtkPolyData > inputPolyData = vtkSmartPointer< vtkPolyData >::New();
+    inputPolyData->SetPoints( inputPoints );
+    inputPolyData->SetVerts( verts );
+    this->PointCleaner->SetInputData( inputPolyData );
+    this->PointCleaner->Update();
+    inputPoints = this->PointCleaner->GetOutput()->GetPoints();
+    if ( inputPoints == NULL || inputPoints->GetNumberOfPoints() < 2 )
+    {
+      outputPolyData->Initialize();
+      return false;
+    }
+  }
+
+  this->CurveGenerator->SetInputPoints( inputPoints );
+  this->CurveGenerator->Update();
+  vtkPoints* curvePoints = this->CurveGenerator->GetOutputPoints();
+  if ( curvePoints == NULL || curvePoints->GetNumberOfPoints() < 2 )
+  {
+    outputPolyData->Initialize();
+    return false;
+  }
+  this->OutputCurveLength = this->CurveGenerator->GetOutputCurveLength();
+
+  vtkIdType numberOfCurvePoints = curvePoints->GetNumberOfPoints();
+  vtkSmartPointer< vtkCellArray > curveLines = vtkSmartPointer< vtkCellArray >::New();
+  curveLines->InsertNextCell( numberOfCurvePoints );
+  for ( vtkIdType curvePointIndex = 0; curvePointIndex < numberOfCurvePoints; curvePointIndex++ )
+  {
+    curveLines->InsertCellPoint( curvePointIndex );
+  }
+  vtkSmartPointer< vtkPolyData > curvePolyData = vtkSmartPointer< vtkPolyData >::New();
+  curvePolyData->SetPoints( curvePoints );
+  curvePolyData->SetLines( curveLines );
+
+  this->TubeFilter->SetInputData( curvePolyData );
+  this->TubeFilter->SetRadius( this->TubeRadius );
+  this->TubeFilter->SetNumberOfSides( this->TubeNumberOfSides );
+  this->TubeFilter->Update();
+  outputPolyData->DeepCopy( this->TubeFilter->GetOutput() );
+  return true;
+}
@@ -0,0 +1,85 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkPathFitter_h
+#define __vtkPathFitter_h
+
+// vtk includes
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+class vtkCleanPolyData;
+class vtkCurveGenerator;
+class vtkMRMLMarkupsToModelNode;
+class vtkPoints;
+class vtkPolyData;
+class vtkTubeFilter;
+
+#include "vtkSlicerPathReconstructionModuleLogicExport.h"
+
+/// \ingroup Slicer_QtModules_PathReconstruction
+/// Fits a curve and tube through a set of points without going through the scene.
+/// The fitting parameters are copied from a MarkupsToModel node up front, so that
+/// Fit() does not touch any MRML node. Each fitter owns its own pipeline, so
+/// several fitters can run at the same time on different threads.
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_LOGIC_EXPORT vtkPathFitter : public vtkObject
+{
+public:
+  static vtkPathFitter* New();
+  vtkTypeMacro( vtkPathFitter, vtkObject );
+  void PrintSelf( ostream& os, vtkIndent indent );
+
+  // Copy curve and tube parameters. Must be called from the main thread.
+  void SetParametersFromMarkupsToModelNode( vtkMRMLMarkupsToModelNode* markupsToModelNode );
+
+  vtkGetMacro( TubeRadius, double );
+  vtkSetMacro( TubeRadius, double );
+
+  vtkGetMacro( TubeNumberOfSides, int );
+  vtkSetMacro( TubeNumberOfSides, int );
+
+  // If true, coincident input points are merged before fitting, like MarkupsToModel does
+  vtkGetMacro( CleanMarkups, bool );
+  vtkSetMacro( CleanMarkups, bool );
+  vtkBooleanMacro( CleanMarkups, bool );
+
+  // Fit a tube through the input points and store it in outputPolyData.
+  // Returns false if there are not enough points to define a curve.
+  bool Fit( vtkPoints* inputPoints, vtkPolyData* outputPolyData );
+
+  // Length of the curve computed by the last call to Fit()
+  vtkGetMacro( OutputCurveLength, double );
+
+protected:
+  vtkPathFitter();
+  virtual ~vtkPathFitter();
+
+private:
+  double TubeRadius;
+  int TubeNumberOfSides;
+  bool CleanMarkups;
+  double OutputCurveLength;
+
+  vtkSmartPointer< vtkCleanPolyData > PointCleaner;
+  vtkSmartPointer< vtkCurveGenerator > CurveGenerator;
+  vtkSmartPointer< vtkTubeFilter > TubeFilter;
+
+  vtkPathFitter( const vtkPathFitter& ); // Not implemented
+  void operator=( const vtkPathFitter& ); // Not implemented
+};
+
+#endif
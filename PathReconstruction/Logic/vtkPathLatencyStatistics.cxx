@@ -0,0 +1,165 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkPathLatencyStatistics.h"
+
+// vtk includes
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+vtkStandardNewMacro( vtkPathLatencyStatistics );
+
+//------------------------------------------------------------------------------
+vtkPathLatencyStatistics::vtkPathLatencyStatistics()
+{
+  this->WindowSize = 10000;
+  this->Reset();
+}
+
+//------------------------------------------------------------------------------
+vtkPathLatencyStatistics::~vtkPathLatencyStatistics()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkPathLatencyStatistics::PrintSelf( ostream& os, vtkIndent indent )
+{
+  this->Superclass::PrintSelf( os, indent );
+  os << indent << "WindowSize: " << this->WindowSize << std::endl;
+  for ( int stage = 0; stage < Stage_Last; stage++ )
+  {
+    os << indent << vtkPathLatencyStatistics::GetStageName( stage ) << ": "
+       << this->GetNumberOfLatencies( stage ) << " latencies, "
+       << "p50 " << this->GetLatencyPercentile( stage, 50.0 ) << " s, "
+       << "p95 " << this->GetLatencyPercentile( stage, 95.0 ) << " s, "
+       << "p99 " << this->GetLatencyPercentile( stage, 99.0 ) << " s" << std::endl;
+  }
+}
+
+//------------------------------------------------------------------------------
+const char* vtkPathLatencyStatistics::GetStageName( int stage )
+{
+  switch ( stage )
+  {
+  case StageSampleToPoint:
+    return "SampleToPoint";
+  case StageSampleToPath:
+    return "SampleToPath";
+  case StageStopToFullResolutionPath:
+    return "StopToFullResolutionPath";
+  default:
+    return "";
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkPathLatencyStatistics::SetWindowSize( vtkIdType windowSize )
+{
+  if ( windowSize < 1 )
+  {
+    vtkErrorMacro( "Window size must be at least 1. Cannot set window size to " << windowSize << "." );
+    return;
+  }
+  this->WindowSize = windowSize;
+  this->Reset();
+}
+
+//------------------------------------------------------------------------------
+void vtkPathLatencyStatistics::Reset()
+{
+  for ( int stage = 0; stage < Stage_Last; stage++ )
+  {
+    this->Stages[ stage ].Latencies.clear();
+    this->Stages[ stage ].Latencies.reserve( this->WindowSize );
+    this->Stages[ stage ].TotalCount = 0;
+  }
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+bool vtkPathLatencyStatistics::IsValidStage( int stage )
+{
+  if ( stage < 0 || stage >= Stage_Last )
+  {
+    vtkErrorMacro( "Unknown stage " << stage << "." );
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathLatencyStatistics::AddLatency( int stage, double latencySeconds )
+{
+  if ( !this->IsValidStage( stage ) )
+  {
+    return;
+  }
+
+  // overwrite the oldest latency once the window is full
+  StageLatencies& stageLatencies = this->Stages[ stage ];
+  if ( (vtkIdType)stageLatencies.Latencies.size() < this->WindowSize )
+  {
+    stageLatencies.Latencies.push_back( latencySeconds );
+  }
+  else
+  {
+    stageLatencies.Latencies[ stageLatencies.TotalCount % this->WindowSize ] = latencySeconds;
+  }
+  stageLatencies.TotalCount++;
+}
+
+//------------------------------------------------------------------------------
+vtkIdType vtkPathLatencyStatistics::GetNumberOfLatencies( int stage )
+{
+  return this->IsValidStage( stage ) ? (vtkIdType)this->Stages[ stage ].Latencies.size() : 0;
+}
+
+//------------------------------------------------------------------------------
+vtkIdType vtkPathLatencyStatistics::GetTotalNumberOfLatencies( int stage )
+{
+  return this->IsValidStage( stage ) ? this->Stages[ stage ].TotalCount : 0;
+}
+
+//------------------------------------------------------------------------------
+double vtkPathLatencyStatistics::GetLatencyPercentile( int stage, double percentile )
+{
+  if ( !this->IsValidStage( stage ) || this->Stages[ stage ].Latencies.empty() )
+  {
+    return 0.0;
+  }
+
+  // nearest rank, on a copy so the ring order is kept
+  std::vector< double > latencies( this->Stages[ stage ].Latencies );
+  percentile = std::min( std::max( percentile, 0.0 ), 100.0 );
+  size_t rank = (size_t)std::ceil( percentile / 100.0 * latencies.size() );
+  size_t latencyIndex = ( rank > 0 ) ? rank - 1 : 0;
+  std::nth_element( latencies.begin(), latencies.begin() + latencyIndex, latencies.end() );
+  return latencies[ latencyIndex ];
+}
+
+//------------------------------------------------------------------------------
+double vtkPathLatencyStatistics::GetMaximumLatency( int stage )
+{
+  if ( !this->IsValidStage( stage ) || this->Stages[ stage ].Latencies.empty() )
+  {
+    return 0.0;
+  }
+  return *std::max_element( this->Stages[ stage ].Latencies.begin(), this->Stages[ stage ].Latencies.end() );
+}
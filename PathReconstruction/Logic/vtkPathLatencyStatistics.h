@@ -0,0 +1,88 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkPathLatencyStatistics_h
+#define __vtkPathLatencyStatistics_h
+
+// vtk includes
+#include <vtkObject.h>
+
+// STD includes
+#include <vector>
+
+#include "vtkSlicerPathReconstructionModuleLogicExport.h"
+
+/// \ingroup Slicer_QtModules_PathReconstruction
+/// Rolling window of the latencies (seconds) of each stage of the recording pipeline,
+/// measured by vtkSlicerPathReconstructionLogic. Only the most recent WindowSize
+/// latencies of each stage are kept, so percentiles reflect the current load.
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_LOGIC_EXPORT vtkPathLatencyStatistics : public vtkObject
+{
+public:
+  static vtkPathLatencyStatistics* New();
+  vtkTypeMacro( vtkPathLatencyStatistics, vtkObject );
+  void PrintSelf( ostream& os, vtkIndent indent );
+
+  enum Stages
+  {
+    // from the sampling transform update until the point is in the points model
+    StageSampleToPoint = 0,
+    // from the sampling transform update until the live path includes the point
+    StageSampleToPath,
+    // from the end of recording until the full resolution path is in the path model (one per path)
+    StageStopToFullResolutionPath,
+    Stage_Last // valid types go above this line
+  };
+  static const char* GetStageName( int stage );
+
+  // Number of latencies kept per stage. Changing it discards all latencies. Default is 10000.
+  void SetWindowSize( vtkIdType windowSize );
+  vtkGetMacro( WindowSize, vtkIdType );
+
+  void AddLatency( int stage, double latencySeconds );
+  void Reset();
+
+  // Number of latencies in the window, and in total since the last Reset
+  vtkIdType GetNumberOfLatencies( int stage );
+  vtkIdType GetTotalNumberOfLatencies( int stage );
+
+  // Percentile (0-100) of the latencies in the window, in seconds. Returns 0 if there are none.
+  double GetLatencyPercentile( int stage, double percentile );
+  double GetMaximumLatency( int stage );
+
+protected:
+  vtkPathLatencyStatistics();
+  virtual ~vtkPathLatencyStatistics();
+
+private:
+  vtkIdType WindowSize;
+
+  // ring of the most recent latencies of a stage
+  struct StageLatencies
+  {
+    std::vector< double > Latencies;
+    vtkIdType TotalCount;
+  };
+  StageLatencies Stages[ Stage_Last ];
+
+  bool IsValidStage( int stage );
+
+  vtkPathLatencyStatistics( const vtkPathLatencyStatistics& ); // Not implemented
+  void operator=( const vtkPathLatencyStatistics& ); // Not implemented
+};
+
+#endif
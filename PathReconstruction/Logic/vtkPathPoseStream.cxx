@@ -0,0 +1,247 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkPathPoseStream.h"
+
+// vtk includes
+#include <vtkByteSwap.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <cstring>
+#include <fstream>
+
+// Constants ------------------------------------------------------------------
+static const char POSE_STREAM_MAGIC[ 8 ] = { 'P', 'R', 'P', 'O', 'S', 'E', 'S', '\0' };
+static const vtkTypeUInt32 POSE_STREAM_VERSION = 1;
+// timestamp, channel and segment, 4x4 matrix
+static const vtkTypeUInt64 POSE_STREAM_RECORD_SIZE = sizeof( double ) + 2 * sizeof( vtkTypeInt32 ) + 16 * sizeof( double );
+
+vtkStandardNewMacro( vtkPathPoseStream );
+
+//------------------------------------------------------------------------------
+vtkPathPoseStream::vtkPathPoseStream()
+{
+}
+
+//------------------------------------------------------------------------------
+vtkPathPoseStream::~vtkPathPoseStream()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkPathPoseStream::PrintSelf( ostream& os, vtkIndent indent )
+{
+  this->Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfPoses: " << this->GetNumberOfPoses() << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathPoseStream::AddPose( double timestamp, int channel, int segment, vtkMatrix4x4* samplingToParentMatrix )
+{
+  if ( samplingToParentMatrix == NULL )
+  {
+    vtkErrorMacro( "Matrix is null. Cannot add pose." );
+    return;
+  }
+  if ( !this->Timestamps.empty() && timestamp < this->Timestamps.back() )
+  {
+    vtkWarningMacro( "Pose at " << timestamp << " s is older than the previous pose. Poses are replayed in the order they are added." );
+  }
+
+  this->Timestamps.push_back( timestamp );
+  this->Channels.push_back( channel );
+  this->Segments.push_back( segment );
+  for ( int row = 0; row < 4; row++ )
+  {
+    for ( int column = 0; column < 4; column++ )
+    {
+      this->Matrices.push_back( samplingToParentMatrix->GetElement( row, column ) );
+    }
+  }
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkPathPoseStream::RemoveAllPoses()
+{
+  this->Timestamps.clear();
+  this->Channels.clear();
+  this->Segments.clear();
+  this->Matrices.clear();
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+vtkIdType vtkPathPoseStream::GetNumberOfPoses()
+{
+  return (vtkIdType)this->Timestamps.size();
+}
+
+//------------------------------------------------------------------------------
+bool vtkPathPoseStream::IsValidPoseIndex( vtkIdType poseIndex )
+{
+  if ( poseIndex < 0 || poseIndex >= this->GetNumberOfPoses() )
+  {
+    vtkErrorMacro( "Pose index " << poseIndex << " is out of range." );
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+double vtkPathPoseStream::GetPoseTimestamp( vtkIdType poseIndex )
+{
+  return this->IsValidPoseIndex( poseIndex ) ? this->Timestamps[ poseIndex ] : 0.0;
+}
+
+//------------------------------------------------------------------------------
+int vtkPathPoseStream::GetPoseChannel( vtkIdType poseIndex )
+{
+  return this->IsValidPoseIndex( poseIndex ) ? this->Channels[ poseIndex ] : -1;
+}
+
+//------------------------------------------------------------------------------
+int vtkPathPoseStream::GetPoseSegment( vtkIdType poseIndex )
+{
+  return this->IsValidPoseIndex( poseIndex ) ? this->Segments[ poseIndex ] : -1;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathPoseStream::GetPoseMatrix( vtkIdType poseIndex, vtkMatrix4x4* samplingToParentMatrix )
+{
+  if ( samplingToParentMatrix == NULL || !this->IsValidPoseIndex( poseIndex ) )
+  {
+    return;
+  }
+  samplingToParentMatrix->DeepCopy( &this->Matrices[ 16 * poseIndex ] );
+}
+
+//------------------------------------------------------------------------------
+bool vtkPathPoseStream::ReadFile( const char* fileName )
+{
+  if ( fileName == NULL )
+  {
+    vtkErrorMacro( "File name is null. Cannot read poses." );
+    return false;
+  }
+
+  std::ifstream file( fileName, std::ios::in | std::ios::binary );
+  if ( !file )
+  {
+    vtkErrorMacro( "Could not open " << fileName << ". Cannot read poses." );
+    return false;
+  }
+
+  char magic[ 8 ];
+  vtkTypeUInt32 versionAndReserved[ 2 ] = { 0, 0 };
+  vtkTypeUInt64 numberOfPoses = 0;
+  file.read( magic, 8 );
+  file.read( reinterpret_cast< char* >( versionAndReserved ), sizeof( versionAndReserved ) );
+  file.read( reinterpret_cast< char* >( &numberOfPoses ), sizeof( numberOfPoses ) );
+  vtkByteSwap::SwapLERange( versionAndReserved, 2 );
+  vtkByteSwap::SwapLERange( &numberOfPoses, 1 );
+  if ( !file || memcmp( magic, POSE_STREAM_MAGIC, 8 ) != 0 )
+  {
+    vtkErrorMacro( fileName << " is not a pose stream file." );
+    return false;
+  }
+  if ( versionAndReserved[ 0 ] != POSE_STREAM_VERSION )
+  {
+    vtkErrorMacro( fileName << " has unsupported version " << versionAndReserved[ 0 ] << "." );
+    return false;
+  }
+
+  // check the pose count against the file size before allocating for it
+  std::streampos headerEnd = file.tellg();
+  file.seekg( 0, std::ios::end );
+  std::streampos fileEnd = file.tellg();
+  file.seekg( headerEnd );
+  if ( !file || fileEnd < headerEnd || numberOfPoses > (vtkTypeUInt64)( fileEnd - headerEnd ) / POSE_STREAM_RECORD_SIZE )
+  {
+    vtkErrorMacro( fileName << " is too short for " << numberOfPoses << " poses." );
+    return false;
+  }
+
+  std::vector< double > timestamps( numberOfPoses );
+  std::vector< int > channels( numberOfPoses );
+  std::vector< int > segments( numberOfPoses );
+  std::vector< double > matrices( 16 * numberOfPoses );
+  for ( vtkTypeUInt64 poseIndex = 0; poseIndex < numberOfPoses; poseIndex++ )
+  {
+    vtkTypeInt32 channelAndSegment[ 2 ] = { 0, 0 };
+    file.read( reinterpret_cast< char* >( &timestamps[ poseIndex ] ), sizeof( double ) );
+    file.read( reinterpret_cast< char* >( channelAndSegment ), sizeof( channelAndSegment ) );
+    file.read( reinterpret_cast< char* >( &matrices[ 16 * poseIndex ] ), 16 * sizeof( double ) );
+    if ( !file )
+    {
+      vtkErrorMacro( "Could not read pose " << poseIndex << " of " << numberOfPoses << " from " << fileName << "." );
+      return false;
+    }
+    vtkByteSwap::SwapLERange( &timestamps[ poseIndex ], 1 );
+    vtkByteSwap::SwapLERange( channelAndSegment, 2 );
+    vtkByteSwap::SwapLERange( &matrices[ 16 * poseIndex ], 16 );
+    channels[ poseIndex ] = channelAndSegment[ 0 ];
+    segments[ poseIndex ] = channelAndSegment[ 1 ];
+  }
+
+  this->Timestamps.swap( timestamps );
+  this->Channels.swap( channels );
+  this->Segments.swap( segments );
+  this->Matrices.swap( matrices );
+  this->Modified();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkPathPoseStream::WriteFile( const char* fileName )
+{
+  if ( fileName == NULL )
+  {
+    vtkErrorMacro( "File name is null. Cannot write poses." );
+    return false;
+  }
+
+  std::ofstream file( fileName, std::ios::out | std::ios::binary | std::ios::trunc );
+  if ( !file )
+  {
+    vtkErrorMacro( "Could not open " << fileName << " for writing. Cannot write poses." );
+    return false;
+  }
+
+  file.write( POSE_STREAM_MAGIC, 8 );
+  vtkTypeUInt32 versionAndReserved[ 2 ] = { POSE_STREAM_VERSION, 0 };
+  vtkByteSwap::SwapLERangeWrite( versionAndReserved, 2, &file );
+  vtkTypeUInt64 numberOfPoses = (vtkTypeUInt64)this->Timestamps.size();
+  vtkByteSwap::SwapLERangeWrite( &numberOfPoses, 1, &file );
+  for ( size_t poseIndex = 0; poseIndex < this->Timestamps.size(); poseIndex++ )
+  {
+    vtkTypeInt32 channelAndSegment[ 2 ] = { this->Channels[ poseIndex ], this->Segments[ poseIndex ] };
+    vtkByteSwap::SwapLERangeWrite( &this->Timestamps[ poseIndex ], 1, &file );
+    vtkByteSwap::SwapLERangeWrite( channelAndSegment, 2, &file );
+    vtkByteSwap::SwapLERangeWrite( &this->Matrices[ 16 * poseIndex ], 16, &file );
+  }
+
+  file.close();
+  if ( !file )
+  {
+    vtkErrorMacro( "Could not write " << fileName << "." );
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,77 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkPathPoseStream_h
+#define __vtkPathPoseStream_h
+
+// vtk includes
+#include <vtkObject.h>
+
+class vtkMatrix4x4;
+
+// STD includes
+#include <vector>
+
+#include "vtkSlicerPathReconstructionModuleLogicExport.h"
+
+/// \ingroup Slicer_QtModules_PathReconstruction
+/// Recorded sequence of sampling transform poses, to be replayed by
+/// vtkSlicerPathReconstructionLogic::StartReplay. Each pose has a timestamp (seconds),
+/// the recording channel it belongs to, a segment number (poses with the same segment
+/// number are recorded as one path) and the sampling-to-parent matrix of the transform.
+/// Poses must be added in order of their timestamps.
+///
+/// File layout (little endian):
+///   header: char[8] "PRPOSES", uint32 version, uint32 reserved, uint64 number of poses
+///   poses:  per pose, double timestamp, int32 channel, int32 segment, double matrix[ 16 ] (row major)
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_LOGIC_EXPORT vtkPathPoseStream : public vtkObject
+{
+public:
+  static vtkPathPoseStream* New();
+  vtkTypeMacro( vtkPathPoseStream, vtkObject );
+  void PrintSelf( ostream& os, vtkIndent indent );
+
+  void AddPose( double timestamp, int channel, int segment, vtkMatrix4x4* samplingToParentMatrix );
+  void RemoveAllPoses();
+
+  vtkIdType GetNumberOfPoses();
+  double GetPoseTimestamp( vtkIdType poseIndex );
+  int GetPoseChannel( vtkIdType poseIndex );
+  int GetPoseSegment( vtkIdType poseIndex );
+  void GetPoseMatrix( vtkIdType poseIndex, vtkMatrix4x4* samplingToParentMatrix );
+
+  // Replace the poses by the poses in the file. Returns false if the file could not be read.
+  bool ReadFile( const char* fileName );
+  bool WriteFile( const char* fileName );
+
+protected:
+  vtkPathPoseStream();
+  virtual ~vtkPathPoseStream();
+
+private:
+  std::vector< double > Timestamps;
+  std::vector< int > Channels;
+  std::vector< int > Segments;
+  std::vector< double > Matrices; // 16 values per pose
+
+  bool IsValidPoseIndex( vtkIdType poseIndex );
+
+  vtkPathPoseStream( const vtkPathPoseStream& ); // Not implemented
+  void operator=( const vtkPathPoseStream& ); // Not implemented
+};
+
+#endif
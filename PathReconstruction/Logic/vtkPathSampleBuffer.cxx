@@ -0,0 +1,152 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkPathSampleBuffer.h"
+
+// vtk includes
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <algorithm>
+
+static const int VALUES_PER_SAMPLE = 9; // timestamp, x, y, z, qw, qx, qy, qz, received time
+
+vtkStandardNewMacro( vtkPathSampleBuffer );
+
+//------------------------------------------------------------------------------
+vtkPathSampleBuffer::vtkPathSampleBuffer()
+{
+  this->Capacity = 0;
+  this->FirstSampleIndex = 0;
+  this->NumberOfSamples = 0;
+  this->SetCapacity( 1024 );
+}
+
+//------------------------------------------------------------------------------
+vtkPathSampleBuffer::~vtkPathSampleBuffer()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleBuffer::PrintSelf( ostream& os, vtkIndent indent )
+{
+  this->Superclass::PrintSelf( os, indent );
+  os << indent << "Capacity: " << this->Capacity << std::endl;
+  os << indent << "NumberOfSamples: " << this->NumberOfSamples << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleBuffer::SetCapacity( vtkIdType capacity )
+{
+  if ( capacity < 1 )
+  {
+    vtkErrorMacro( "Capacity must be at least 1. Cannot set capacity to " << capacity << "." );
+    return;
+  }
+
+  this->Capacity = capacity;
+  this->Samples.assign( VALUES_PER_SAMPLE * capacity, 0.0 );
+  this->FirstSampleIndex = 0;
+  this->NumberOfSamples = 0;
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+vtkIdType vtkPathSampleBuffer::GetCapacity()
+{
+  return this->Capacity;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleBuffer::PushSample( double timestamp, const double position[ 3 ], const double orientation[ 4 ], double receivedTime )
+{
+  if ( this->NumberOfSamples >= this->Capacity )
+  {
+    // double the capacity, with the waiting samples moved to the front in order
+    std::vector< double > samples( 2 * VALUES_PER_SAMPLE * this->Capacity, 0.0 );
+    for ( vtkIdType sampleIndex = 0; sampleIndex < this->NumberOfSamples; sampleIndex++ )
+    {
+      const double* sample = &this->Samples[ VALUES_PER_SAMPLE * ( ( this->FirstSampleIndex + sampleIndex ) % this->Capacity ) ];
+      std::copy( sample, sample + VALUES_PER_SAMPLE, &samples[ VALUES_PER_SAMPLE * sampleIndex ] );
+    }
+    this->Samples.swap( samples );
+    this->Capacity *= 2;
+    this->FirstSampleIndex = 0;
+  }
+
+  double* sample = &this->Samples[ VALUES_PER_SAMPLE * ( ( this->FirstSampleIndex + this->NumberOfSamples ) % this->Capacity ) ];
+  sample[ 0 ] = timestamp;
+  sample[ 1 ] = position[ 0 ];
+  sample[ 2 ] = position[ 1 ];
+  sample[ 3 ] = position[ 2 ];
+  sample[ 4 ] = orientation[ 0 ];
+  sample[ 5 ] = orientation[ 1 ];
+  sample[ 6 ] = orientation[ 2 ];
+  sample[ 7 ] = orientation[ 3 ];
+  sample[ 8 ] = receivedTime;
+  this->NumberOfSamples++;
+}
+
+//------------------------------------------------------------------------------
+vtkIdType vtkPathSampleBuffer::PopSamples( vtkIdType maximumNumberOfSamples, double* timestamps, double* positions, double* orientations, double* receivedTimes )
+{
+  if ( timestamps == NULL || positions == NULL || orientations == NULL )
+  {
+    vtkErrorMacro( "Output arrays are null. Cannot pop samples." );
+    return 0;
+  }
+
+  if ( maximumNumberOfSamples <= 0 )
+  {
+    return 0;
+  }
+
+  vtkIdType numberOfSamples = std::min( this->NumberOfSamples, maximumNumberOfSamples );
+  for ( vtkIdType sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++ )
+  {
+    const double* sample = &this->Samples[ VALUES_PER_SAMPLE * ( ( this->FirstSampleIndex + sampleIndex ) % this->Capacity ) ];
+    timestamps[ sampleIndex ] = sample[ 0 ];
+    positions[ 3 * sampleIndex + 0 ] = sample[ 1 ];
+    positions[ 3 * sampleIndex + 1 ] = sample[ 2 ];
+    positions[ 3 * sampleIndex + 2 ] = sample[ 3 ];
+    orientations[ 4 * sampleIndex + 0 ] = sample[ 4 ];
+    orientations[ 4 * sampleIndex + 1 ] = sample[ 5 ];
+    orientations[ 4 * sampleIndex + 2 ] = sample[ 6 ];
+    orientations[ 4 * sampleIndex + 3 ] = sample[ 7 ];
+    if ( receivedTimes != NULL )
+    {
+      receivedTimes[ sampleIndex ] = sample[ 8 ];
+    }
+  }
+
+  this->FirstSampleIndex = ( this->FirstSampleIndex + numberOfSamples ) % this->Capacity;
+  this->NumberOfSamples -= numberOfSamples;
+  return numberOfSamples;
+}
+
+//------------------------------------------------------------------------------
+vtkIdType vtkPathSampleBuffer::GetNumberOfSamples()
+{
+  return this->NumberOfSamples;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleBuffer::Clear()
+{
+  this->FirstSampleIndex = 0;
+  this->NumberOfSamples = 0;
+}
@@ -0,0 +1,76 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkPathSampleBuffer_h
+#define __vtkPathSampleBuffer_h
+
+// vtk includes
+#include <vtkObject.h>
+
+// STD includes
+#include <vector>
+
+#include "vtkSlicerPathReconstructionModuleLogicExport.h"
+
+/// \ingroup Slicer_QtModules_PathReconstruction
+/// Ring buffer of timestamped sample poses (position and orientation quaternion wxyz).
+/// Each sample also keeps the wall clock time it was received, for latency measurements.
+/// Samples are pushed by the transform observer and popped by ProcessPendingSamples, both on
+/// the main thread, so the buffer is not thread safe. It never overwrites or drops samples:
+/// when it is full, PushSample doubles the capacity, so pushing never has to wait for a drain.
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_LOGIC_EXPORT vtkPathSampleBuffer : public vtkObject
+{
+public:
+  static vtkPathSampleBuffer* New();
+  vtkTypeMacro( vtkPathSampleBuffer, vtkObject );
+  void PrintSelf( ostream& os, vtkIndent indent );
+
+  // Number of samples the buffer can hold before it grows. Changing it discards all samples.
+  void SetCapacity( vtkIdType capacity );
+  vtkIdType GetCapacity();
+
+  // Append a sample, growing the buffer if it is full
+  void PushSample( double timestamp, const double position[ 3 ], const double orientation[ 4 ], double receivedTime );
+
+  // Copy up to maximumNumberOfSamples of the oldest samples and remove them
+  // from the buffer. timestamps must hold maximumNumberOfSamples values, positions three times
+  // that and orientations four times that. receivedTimes may be NULL if they are not needed.
+  // Returns the number of samples copied.
+  vtkIdType PopSamples( vtkIdType maximumNumberOfSamples, double* timestamps, double* positions, double* orientations, double* receivedTimes );
+
+  // Number of samples waiting
+  vtkIdType GetNumberOfSamples();
+
+  // Discard all samples waiting in the buffer
+  void Clear();
+
+protected:
+  vtkPathSampleBuffer();
+  virtual ~vtkPathSampleBuffer();
+
+private:
+  // timestamp, position, orientation and received time of each slot, 9 values per slot
+  std::vector< double > Samples;
+  vtkIdType Capacity;
+  vtkIdType FirstSampleIndex; // slot of the oldest sample
+  vtkIdType NumberOfSamples;
+
+  vtkPathSampleBuffer( const vtkPathSampleBuffer& ); // Not implemented
+  void operator=( const vtkPathSampleBuffer& ); // Not implemented
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkPathSampleDecimator.h"
+
+// vtk includes
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <cmath>
+
+vtkStandardNewMacro( vtkPathSampleDecimator );
+
+//------------------------------------------------------------------------------
+vtkPathSampleDecimator::vtkPathSampleDecimator()
+{
+  this->MinimumDistance = 0.25;
+  this->MaximumDistance = 5.0;
+  this->MinimumSpeed = 0.5;
+  this->MaximumAngle = 5.0;
+  this->Reset();
+}
+
+//------------------------------------------------------------------------------
+vtkPathSampleDecimator::~vtkPathSampleDecimator()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleDecimator::PrintSelf( ostream& os, vtkIndent indent )
+{
+  this->Superclass::PrintSelf( os, indent );
+  os << indent << "MinimumDistance: " << this->MinimumDistance << std::endl;
+  os << indent << "MaximumDistance: " << this->MaximumDistance << std::endl;
+  os << indent << "MinimumSpeed: " << this->MinimumSpeed << std::endl;
+  os << indent << "MaximumAngle: " << this->MaximumAngle << std::endl;
+  os << indent << "NumberOfKeptSamples: " << this->NumberOfKeptSamples << std::endl;
+  os << indent << "NumberOfDroppedSamples: " << this->NumberOfDroppedSamples << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleDecimator::CopyParameters( vtkPathSampleDecimator* other )
+{
+  if ( other == NULL )
+  {
+    vtkErrorMacro( "Other decimator is null. Cannot copy parameters." );
+    return;
+  }
+  this->MinimumDistance = other->MinimumDistance;
+  this->MaximumDistance = other->MaximumDistance;
+  this->MinimumSpeed = other->MinimumSpeed;
+  this->MaximumAngle = other->MaximumAngle;
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleDecimator::Reset()
+{
+  this->NumberOfRecentKeptSamples = 0;
+  this->LastKeptTimestamp = 0.0;
+  for ( int component = 0; component < 3; component++ )
+  {
+    this->LastKeptPosition[ component ] = 0.0;
+    this->LastKeptDirection[ component ] = 0.0;
+  }
+  this->NumberOfKeptSamples = 0;
+  this->NumberOfDroppedSamples = 0;
+}
+
+//------------------------------------------------------------------------------
+bool vtkPathSampleDecimator::AcceptSample( double timestamp, const double position[ 3 ] )
+{
+  if ( this->NumberOfRecentKeptSamples == 0 )
+  {
+    this->KeepSample( timestamp, position );
+    return true;
+  }
+
+  double displacement[ 3 ] = { 0.0, 0.0, 0.0 };
+  vtkMath::Subtract( position, this->LastKeptPosition, displacement );
+  double distance = vtkMath::Norm( displacement );
+
+  if ( distance < this->MinimumDistance )
+  {
+    this->NumberOfDroppedSamples++;
+    return false;
+  }
+
+  if ( distance >= this->MaximumDistance || this->NumberOfRecentKeptSamples == 1 )
+  {
+    this->KeepSample( timestamp, position );
+    return true;
+  }
+
+  // Average speed since the last kept sample. Jitter while paused stays within a small
+  // distance while the time keeps growing, so the speed drops below the threshold.
+  double elapsedTime = timestamp - this->LastKeptTimestamp;
+  if ( elapsedTime > 0.0 && distance / elapsedTime < this->MinimumSpeed )
+  {
+    this->NumberOfDroppedSamples++;
+    return false;
+  }
+
+  double cosineAngle = vtkMath::Dot( displacement, this->LastKeptDirection ) / distance;
+  if ( cosineAngle < std::cos( vtkMath::RadiansFromDegrees( this->MaximumAngle ) ) )
+  {
+    this->KeepSample( timestamp, position );
+    return true;
+  }
+
+  this->NumberOfDroppedSamples++;
+  return false;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleDecimator::KeepSample( double timestamp, const double position[ 3 ] )
+{
+  if ( this->NumberOfRecentKeptSamples > 0 )
+  {
+    double direction[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkMath::Subtract( position, this->LastKeptPosition, direction );
+    if ( vtkMath::Normalize( direction ) > 0.0 )
+    {
+      this->LastKeptDirection[ 0 ] = direction[ 0 ];
+      this->LastKeptDirection[ 1 ] = direction[ 1 ];
+      this->LastKeptDirection[ 2 ] = direction[ 2 ];
+      this->NumberOfRecentKeptSamples = 2;
+    }
+  }
+  else
+  {
+    this->NumberOfRecentKeptSamples = 1;
+  }
+  this->LastKeptTimestamp = timestamp;
+  this->LastKeptPosition[ 0 ] = position[ 0 ];
+  this->LastKeptPosition[ 1 ] = position[ 1 ];
+  this->LastKeptPosition[ 2 ] = position[ 2 ];
+  this->NumberOfKeptSamples++;
+}
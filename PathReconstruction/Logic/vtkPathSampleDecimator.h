@@ -0,0 +1,94 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkPathSampleDecimator_h
+#define __vtkPathSampleDecimator_h
+
+// vtk includes
+#include <vtkObject.h>
+
+#include "vtkSlicerPathReconstructionModuleLogicExport.h"
+
+/// \ingroup Slicer_QtModules_PathReconstruction
+/// Decides, sample by sample, which recorded positions are worth keeping.
+/// Each sample is compared to the last kept sample:
+///  - closer than MinimumDistance: dropped (noise)
+///  - at least MaximumDistance away: kept (so straight segments are still sampled)
+///  - moving slower than MinimumSpeed since the last kept sample: dropped (the tool is paused or drifting)
+///  - turning by more than MaximumAngle from the last kept direction: kept (the path bends)
+///  - otherwise dropped (the path continues straight)
+/// The first two samples are always kept, to establish a direction.
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_LOGIC_EXPORT vtkPathSampleDecimator : public vtkObject
+{
+public:
+  static vtkPathSampleDecimator* New();
+  vtkTypeMacro( vtkPathSampleDecimator, vtkObject );
+  void PrintSelf( ostream& os, vtkIndent indent );
+
+  // Distances in mm. Defaults are 0.25 and 5.0.
+  vtkGetMacro( MinimumDistance, double );
+  vtkSetClampMacro( MinimumDistance, double, 0.0, VTK_DOUBLE_MAX );
+  vtkGetMacro( MaximumDistance, double );
+  vtkSetClampMacro( MaximumDistance, double, 0.0, VTK_DOUBLE_MAX );
+
+  // Speed in mm/s. Default is 0.5.
+  vtkGetMacro( MinimumSpeed, double );
+  vtkSetClampMacro( MinimumSpeed, double, 0.0, VTK_DOUBLE_MAX );
+
+  // Angle in degrees. Default is 5.
+  vtkGetMacro( MaximumAngle, double );
+  vtkSetClampMacro( MaximumAngle, double, 0.0, 180.0 );
+
+  // Copy the parameters (not the state) of another decimator
+  void CopyParameters( vtkPathSampleDecimator* other );
+
+  // Returns true if the sample should be kept. Timestamps are in seconds.
+  bool AcceptSample( double timestamp, const double position[ 3 ] );
+
+  // Number of samples kept and dropped since the last Reset
+  vtkGetMacro( NumberOfKeptSamples, vtkIdType );
+  vtkGetMacro( NumberOfDroppedSamples, vtkIdType );
+
+  // Forget the kept samples and counts, e.g. when a new path starts
+  void Reset();
+
+protected:
+  vtkPathSampleDecimator();
+  virtual ~vtkPathSampleDecimator();
+
+private:
+  double MinimumDistance;
+  double MaximumDistance;
+  double MinimumSpeed;
+  double MaximumAngle;
+
+  // state of the last two kept samples
+  int NumberOfRecentKeptSamples; // 0, 1 or 2
+  double LastKeptTimestamp;
+  double LastKeptPosition[ 3 ];
+  double LastKeptDirection[ 3 ]; // unit, from the second last to the last kept position
+
+  vtkIdType NumberOfKeptSamples;
+  vtkIdType NumberOfDroppedSamples;
+
+  void KeepSample( double timestamp, const double position[ 3 ] );
+
+  vtkPathSampleDecimator( const vtkPathSampleDecimator& ); // Not implemented
+  void operator=( const vtkPathSampleDecimator& ); // Not implemented
+};
+
+#endif
@@ -0,0 +1,239 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkPathSampleFilter.h"
+
+// vtk includes
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+// Constants ------------------------------------------------------------------
+static const int MINIMUM_OUTLIER_WINDOW_SIZE = 3;
+static const int MAXIMUM_OUTLIER_WINDOW_SIZE = 101;
+static const double INITIAL_VELOCITY_VARIANCE = 1.0e6; // (mm/s)^2, the velocity is unknown at the first sample
+
+vtkStandardNewMacro( vtkPathSampleFilter );
+
+//------------------------------------------------------------------------------
+vtkPathSampleFilter::vtkPathSampleFilter()
+{
+  this->OutlierRejection = false;
+  this->OutlierWindowSize = 7;
+  this->OutlierThreshold = 3.0;
+  this->MinimumDeviation = 0.5;
+  this->Smoothing = false;
+  this->SmoothingProcessNoise = 10000.0;
+  this->SmoothingMeasurementNoise = 0.5;
+  this->Reset();
+}
+
+//------------------------------------------------------------------------------
+vtkPathSampleFilter::~vtkPathSampleFilter()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleFilter::PrintSelf( ostream& os, vtkIndent indent )
+{
+  this->Superclass::PrintSelf( os, indent );
+  os << indent << "OutlierRejection: " << this->OutlierRejection << std::endl;
+  os << indent << "OutlierWindowSize: " << this->OutlierWindowSize << std::endl;
+  os << indent << "OutlierThreshold: " << this->OutlierThreshold << std::endl;
+  os << indent << "MinimumDeviation: " << this->MinimumDeviation << std::endl;
+  os << indent << "Smoothing: " << this->Smoothing << std::endl;
+  os << indent << "SmoothingProcessNoise: " << this->SmoothingProcessNoise << std::endl;
+  os << indent << "SmoothingMeasurementNoise: " << this->SmoothingMeasurementNoise << std::endl;
+  os << indent << "NumberOfRejectedSamples: " << this->NumberOfRejectedSamples << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleFilter::SetOutlierWindowSize( int windowSize )
+{
+  if ( windowSize < MINIMUM_OUTLIER_WINDOW_SIZE || windowSize > MAXIMUM_OUTLIER_WINDOW_SIZE )
+  {
+    vtkErrorMacro( "Outlier window size must be between " << MINIMUM_OUTLIER_WINDOW_SIZE << " and " << MAXIMUM_OUTLIER_WINDOW_SIZE
+                   << ". Cannot set window size to " << windowSize << "." );
+    return;
+  }
+  this->OutlierWindowSize = windowSize;
+  this->Reset();
+  this->Modified();
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleFilter::Reset()
+{
+  this->WindowPositions.assign( 3 * this->OutlierWindowSize, 0.0 );
+  this->WindowScratch.assign( this->OutlierWindowSize, 0.0 );
+  this->NumberOfWindowSamples = 0;
+  this->NextWindowIndex = 0;
+
+  this->SmoothingInitialized = false;
+  this->SmoothedTimestamp = 0.0;
+  for ( int component = 0; component < 3; component++ )
+  {
+    this->SmoothedPosition[ component ] = 0.0;
+    this->SmoothedVelocity[ component ] = 0.0;
+  }
+  this->Covariance[ 0 ][ 0 ] = 0.0;
+  this->Covariance[ 0 ][ 1 ] = 0.0;
+  this->Covariance[ 1 ][ 0 ] = 0.0;
+  this->Covariance[ 1 ][ 1 ] = 0.0;
+
+  this->NumberOfRejectedSamples = 0;
+}
+
+//------------------------------------------------------------------------------
+bool vtkPathSampleFilter::FilterSample( double timestamp, const double position[ 3 ], double filteredPosition[ 3 ] )
+{
+  if ( this->OutlierRejection && this->IsOutlier( position ) )
+  {
+    this->NumberOfRejectedSamples++;
+    return false;
+  }
+
+  if ( this->Smoothing )
+  {
+    this->Smooth( timestamp, position, filteredPosition );
+  }
+  else
+  {
+    filteredPosition[ 0 ] = position[ 0 ];
+    filteredPosition[ 1 ] = position[ 1 ];
+    filteredPosition[ 2 ] = position[ 2 ];
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+double vtkPathSampleFilter::ComputeWindowMedian( int valueCount )
+{
+  std::vector< double >::iterator medianIterator = this->WindowScratch.begin() + valueCount / 2;
+  std::nth_element( this->WindowScratch.begin(), medianIterator, this->WindowScratch.begin() + valueCount );
+  return *medianIterator;
+}
+
+//------------------------------------------------------------------------------
+bool vtkPathSampleFilter::IsOutlier( const double position[ 3 ] )
+{
+  // every sample enters the window, so that a real jump is accepted once it persists
+  double* windowPosition = &this->WindowPositions[ 3 * this->NextWindowIndex ];
+  windowPosition[ 0 ] = position[ 0 ];
+  windowPosition[ 1 ] = position[ 1 ];
+  windowPosition[ 2 ] = position[ 2 ];
+  this->NextWindowIndex = ( this->NextWindowIndex + 1 ) % this->OutlierWindowSize;
+  if ( this->NumberOfWindowSamples < this->OutlierWindowSize )
+  {
+    this->NumberOfWindowSamples++;
+  }
+  if ( this->NumberOfWindowSamples < this->OutlierWindowSize )
+  {
+    return false; // not enough samples to tell
+  }
+
+  double median[ 3 ] = { 0.0, 0.0, 0.0 };
+  for ( int component = 0; component < 3; component++ )
+  {
+    for ( int sampleIndex = 0; sampleIndex < this->OutlierWindowSize; sampleIndex++ )
+    {
+      this->WindowScratch[ sampleIndex ] = this->WindowPositions[ 3 * sampleIndex + component ];
+    }
+    median[ component ] = this->ComputeWindowMedian( this->OutlierWindowSize );
+  }
+
+  for ( int sampleIndex = 0; sampleIndex < this->OutlierWindowSize; sampleIndex++ )
+  {
+    this->WindowScratch[ sampleIndex ] = std::sqrt( vtkMath::Distance2BetweenPoints( &this->WindowPositions[ 3 * sampleIndex ], median ) );
+  }
+  double medianDeviation = std::max( this->ComputeWindowMedian( this->OutlierWindowSize ), this->MinimumDeviation );
+
+  double deviation = std::sqrt( vtkMath::Distance2BetweenPoints( position, median ) );
+  return ( deviation > this->OutlierThreshold * medianDeviation );
+}
+
+//------------------------------------------------------------------------------
+void vtkPathSampleFilter::Smooth( double timestamp, const double position[ 3 ], double smoothedPosition[ 3 ] )
+{
+  double measurementVariance = this->SmoothingMeasurementNoise * this->SmoothingMeasurementNoise;
+  if ( !this->SmoothingInitialized )
+  {
+    this->SmoothingInitialized = true;
+    this->SmoothedTimestamp = timestamp;
+    for ( int component = 0; component < 3; component++ )
+    {
+      this->SmoothedPosition[ component ] = position[ component ];
+      this->SmoothedVelocity[ component ] = 0.0;
+      smoothedPosition[ component ] = position[ component ];
+    }
+    this->Covariance[ 0 ][ 0 ] = measurementVariance;
+    this->Covariance[ 0 ][ 1 ] = 0.0;
+    this->Covariance[ 1 ][ 0 ] = 0.0;
+    this->Covariance[ 1 ][ 1 ] = INITIAL_VELOCITY_VARIANCE;
+    return;
+  }
+
+  // predict, unless the timestamps do not advance (e.g. two samples with the same timestamp)
+  double timeStep = timestamp - this->SmoothedTimestamp;
+  if ( timeStep > 0.0 )
+  {
+    for ( int component = 0; component < 3; component++ )
+    {
+      this->SmoothedPosition[ component ] += timeStep * this->SmoothedVelocity[ component ];
+    }
+    // P = F P F^T + Q, with F = [ 1 dt; 0 1 ] and Q the white noise acceleration model
+    double p00 = this->Covariance[ 0 ][ 0 ];
+    double p01 = this->Covariance[ 0 ][ 1 ];
+    double p11 = this->Covariance[ 1 ][ 1 ];
+    double q = this->SmoothingProcessNoise;
+    this->Covariance[ 0 ][ 0 ] = p00 + 2.0 * timeStep * p01 + timeStep * timeStep * p11 + q * timeStep * timeStep * timeStep / 3.0;
+    this->Covariance[ 0 ][ 1 ] = p01 + timeStep * p11 + q * timeStep * timeStep / 2.0;
+    this->Covariance[ 1 ][ 0 ] = this->Covariance[ 0 ][ 1 ];
+    this->Covariance[ 1 ][ 1 ] = p11 + q * timeStep;
+    this->SmoothedTimestamp = timestamp;
+  }
+
+  // update with the measured position
+  double innovationVariance = this->Covariance[ 0 ][ 0 ] + measurementVariance;
+  if ( innovationVariance <= 0.0 )
+  {
+    // no uncertainty at all, nothing to smooth
+    for ( int component = 0; component < 3; component++ )
+    {
+      smoothedPosition[ component ] = position[ component ];
+    }
+    return;
+  }
+  double positionGain = this->Covariance[ 0 ][ 0 ] / innovationVariance;
+  double velocityGain = this->Covariance[ 1 ][ 0 ] / innovationVariance;
+  for ( int component = 0; component < 3; component++ )
+  {
+    double innovation = position[ component ] - this->SmoothedPosition[ component ];
+    this->SmoothedPosition[ component ] += positionGain * innovation;
+    this->SmoothedVelocity[ component ] += velocityGain * innovation;
+    smoothedPosition[ component ] = this->SmoothedPosition[ component ];
+  }
+  double p00 = this->Covariance[ 0 ][ 0 ];
+  double p01 = this->Covariance[ 0 ][ 1 ];
+  this->Covariance[ 0 ][ 0 ] = ( 1.0 - positionGain ) * p00;
+  this->Covariance[ 0 ][ 1 ] = ( 1.0 - positionGain ) * p01;
+  this->Covariance[ 1 ][ 0 ] = this->Covariance[ 0 ][ 1 ];
+  this->Covariance[ 1 ][ 1 ] -= velocityGain * p01;
+}
@@ -0,0 +1,124 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkPathSampleFilter_h
+#define __vtkPathSampleFilter_h
+
+// vtk includes
+#include <vtkObject.h>
+
+// STD includes
+#include <vector>
+
+#include "vtkSlicerPathReconstructionModuleLogicExport.h"
+
+/// \ingroup Slicer_QtModules_PathReconstruction
+/// Filters recorded positions sample by sample, before they are decimated and added to the points model.
+///  - Outlier rejection (Hampel test): the sample is compared to the median of the last OutlierWindowSize
+///    samples (including itself). It is rejected if it is further from the median than OutlierThreshold
+///    times the median distance of the window samples to the median (at least MinimumDeviation).
+///    Rejected samples stay in the window, so a real jump is accepted once it persists.
+///  - Smoothing: a constant velocity Kalman filter per axis, using the sample timestamps.
+/// The cost per sample only depends on the window size, not on the number of recorded samples.
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_LOGIC_EXPORT vtkPathSampleFilter : public vtkObject
+{
+public:
+  static vtkPathSampleFilter* New();
+  vtkTypeMacro( vtkPathSampleFilter, vtkObject );
+  void PrintSelf( ostream& os, vtkIndent indent );
+
+  // Default is off
+  vtkGetMacro( OutlierRejection, bool );
+  vtkSetMacro( OutlierRejection, bool );
+  vtkBooleanMacro( OutlierRejection, bool );
+
+  // Number of samples in the median window. Changing it calls Reset. Default is 7.
+  vtkGetMacro( OutlierWindowSize, int );
+  void SetOutlierWindowSize( int windowSize );
+
+  // Multiple of the median distance to the median. Default is 3.
+  vtkGetMacro( OutlierThreshold, double );
+  vtkSetClampMacro( OutlierThreshold, double, 0.0, VTK_DOUBLE_MAX );
+
+  // Lower limit of the median distance in mm, so that samples are not rejected
+  // because the tool is perfectly still. Default is 0.5.
+  vtkGetMacro( MinimumDeviation, double );
+  vtkSetClampMacro( MinimumDeviation, double, 0.0, VTK_DOUBLE_MAX );
+
+  // Default is off
+  vtkGetMacro( Smoothing, bool );
+  vtkSetMacro( Smoothing, bool );
+  vtkBooleanMacro( Smoothing, bool );
+
+  // Spectral density of the acceleration in mm^2/s^3 (higher follows the samples more closely).
+  // Default is 10000.
+  vtkGetMacro( SmoothingProcessNoise, double );
+  vtkSetClampMacro( SmoothingProcessNoise, double, 0.0, VTK_DOUBLE_MAX );
+
+  // Standard deviation of the measured positions in mm. Default is 0.5.
+  vtkGetMacro( SmoothingMeasurementNoise, double );
+  vtkSetClampMacro( SmoothingMeasurementNoise, double, 0.0, VTK_DOUBLE_MAX );
+
+  // Returns false if the sample is rejected as an outlier. Otherwise filteredPosition is set
+  // to the position to record (smoothed if Smoothing is on). Timestamps are in seconds.
+  // position and filteredPosition may point to the same array.
+  bool FilterSample( double timestamp, const double position[ 3 ], double filteredPosition[ 3 ] );
+
+  // Number of samples rejected since the last Reset
+  vtkGetMacro( NumberOfRejectedSamples, vtkIdType );
+
+  // Forget the previous samples and counts, e.g. when a new path starts
+  void Reset();
+
+protected:
+  vtkPathSampleFilter();
+  virtual ~vtkPathSampleFilter();
+
+private:
+  bool OutlierRejection;
+  int OutlierWindowSize;
+  double OutlierThreshold;
+  double MinimumDeviation;
+  bool Smoothing;
+  double SmoothingProcessNoise;
+  double SmoothingMeasurementNoise;
+
+  // ring of the most recent positions, 3 values per sample
+  std::vector< double > WindowPositions;
+  int NumberOfWindowSamples;
+  int NextWindowIndex;
+  std::vector< double > WindowScratch; // reused to compute medians
+
+  // Kalman filter state. The covariance is the same for all axes, because
+  // all axes have the same noise and time steps.
+  bool SmoothingInitialized;
+  double SmoothedTimestamp;
+  double SmoothedPosition[ 3 ];
+  double SmoothedVelocity[ 3 ];
+  double Covariance[ 2 ][ 2 ]; // position and velocity
+
+  vtkIdType NumberOfRejectedSamples;
+
+  bool IsOutlier( const double position[ 3 ] );
+  void Smooth( double timestamp, const double position[ 3 ], double smoothedPosition[ 3 ] );
+  double ComputeWindowMedian( int valueCount ); // median of the first valueCount values of WindowScratch
+
+  vtkPathSampleFilter( const vtkPathSampleFilter& ); // Not implemented
+  void operator=( const vtkPathSampleFilter& ); // Not implemented
+};
+
+#endif
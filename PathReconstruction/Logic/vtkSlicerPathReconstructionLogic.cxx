@@ -16,6 +16,13 @@
 ==============================================================================*/
 
 // CollectPoints includes
+#include "vtkIncrementalPathFitter.h"
+#include "vtkPathFitter.h"
+#include "vtkPathLatencyStatistics.h"
+#include "vtkPathPoseStream.h"
+#include "vtkPathSampleBuffer.h"
+#include "vtkPathSampleDecimator.h"
+#include "vtkPathSampleFilter.h"
 #include "vtkSlicerPathReconstructionLogic.h"
 
 // MRML includes
@@ -25,32 +32,400 @@
 #include "vtkMRMLModelNode.h"
 #include "vtkMRMLModelDisplayNode.h"
 #include "vtkMRMLPathReconstructionNode.h"
+#include "vtkMRMLPathReconstructionPointsModelNode.h"
+#include "vtkMRMLPathReconstructionStorageNode.h"
 #include "vtkMRMLScene.h"
+#include "vtkMRMLTableNode.h"
 
 // STD includes
+#include <algorithm>
 #include <cassert>
+#include <deque>
+#include <iomanip>
+#include <limits>
+#include <map>
 #include <sstream>
+#include <vector>
 
 // vtk includes
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkIntArray.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
+#include <vtkTimerLog.h>
+#include <vtkWeakPointer.h>
 
 vtkStandardNewMacro(vtkSlicerPathReconstructionLogic);
 
+// number of sides of the tube shown while recording at the coarse level of detail
+static const int COARSE_TUBE_NUMBER_OF_SIDES = 4;
+
+//------------------------------------------------------------------------------
+// Project interleaved xyz coordinates onto a direction. Kept free of branches and
+// function calls so the compiler can vectorize it for both float and double points.
+template< class CoordinateType >
+static void ProjectCoordinates( const CoordinateType* coordinates, vtkIdType numberOfPoints, const double direction[ 3 ], double* projections )
+{
+  const double directionX = direction[ 0 ];
+  const double directionY = direction[ 1 ];
+  const double directionZ = direction[ 2 ];
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    const CoordinateType* coordinate = coordinates + 3 * pointIndex;
+    projections[ pointIndex ] = directionX * coordinate[ 0 ] + directionY * coordinate[ 1 ] + directionZ * coordinate[ 2 ];
+  }
+}
+
+//------------------------------------------------------------------------------
+// Copy the points whose projection is in [ minimumProjection, maximumProjection ] to the front of keptCoordinates.
+// Returns the number of points kept.
+template< class CoordinateType >
+static vtkIdType CompactCoordinates( const CoordinateType* coordinates, const double* projections, vtkIdType numberOfPoints,
+                                     double minimumProjection, double maximumProjection, CoordinateType* keptCoordinates )
+{
+  vtkIdType numberOfKeptPoints = 0;
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    if ( projections[ pointIndex ] < minimumProjection || projections[ pointIndex ] > maximumProjection )
+    {
+      continue;
+    }
+    keptCoordinates[ 3 * numberOfKeptPoints + 0 ] = coordinates[ 3 * pointIndex + 0 ];
+    keptCoordinates[ 3 * numberOfKeptPoints + 1 ] = coordinates[ 3 * pointIndex + 1 ];
+    keptCoordinates[ 3 * numberOfKeptPoints + 2 ] = coordinates[ 3 * pointIndex + 2 ];
+    numberOfKeptPoints++;
+  }
+  return numberOfKeptPoints;
+}
+
+//------------------------------------------------------------------------------
+// Projections of all points onto a direction, read directly from the point buffer
+static void ProjectPoints( vtkPoints* points, const double direction[ 3 ], std::vector< double >& projections )
+{
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  projections.resize( numberOfPoints );
+  if ( numberOfPoints == 0 )
+  {
+    return;
+  }
+  vtkDataArray* coordinates = points->GetData();
+  switch ( points->GetDataType() )
+  {
+  case VTK_FLOAT:
+    ProjectCoordinates( static_cast< float* >( coordinates->GetVoidPointer( 0 ) ), numberOfPoints, direction, &projections[ 0 ] );
+    break;
+  case VTK_DOUBLE:
+    ProjectCoordinates( static_cast< double* >( coordinates->GetVoidPointer( 0 ) ), numberOfPoints, direction, &projections[ 0 ] );
+    break;
+  default:
+    for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+    {
+      double point[ 3 ] = { 0.0, 0.0, 0.0 };
+      points->GetPoint( pointIndex, point );
+      projections[ pointIndex ] = vtkMath::Dot( point, direction );
+    }
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Per point float array of the recorded samples (e.g. timestamps), or NULL if the polydata
+// has no such array or it does not have one tuple of numberOfComponents per point
+static vtkFloatArray* GetSampleArray( vtkPolyData* polyData, const char* arrayName, int numberOfComponents )
+{
+  if ( polyData == NULL || polyData->GetPointData() == NULL )
+  {
+    return NULL;
+  }
+  vtkFloatArray* sampleArray = vtkFloatArray::SafeDownCast( polyData->GetPointData()->GetAbstractArray( arrayName ) );
+  if ( sampleArray == NULL || sampleArray->GetNumberOfComponents() != numberOfComponents
+    || sampleArray->GetNumberOfTuples() != polyData->GetNumberOfPoints() )
+  {
+    return NULL;
+  }
+  return sampleArray;
+}
+
+//------------------------------------------------------------------------------
+// Copy of the tuples whose projection is in [ minimumProjection, maximumProjection ], same rule as CompactCoordinates
+static vtkSmartPointer< vtkFloatArray > CompactSampleArray( vtkFloatArray* sampleArray, const double* projections, vtkIdType numberOfPoints,
+                                                            double minimumProjection, double maximumProjection )
+{
+  int numberOfComponents = sampleArray->GetNumberOfComponents();
+  vtkSmartPointer< vtkFloatArray > keptArray = vtkSmartPointer< vtkFloatArray >::New();
+  keptArray->SetName( sampleArray->GetName() );
+  keptArray->SetNumberOfComponents( numberOfComponents );
+  keptArray->SetNumberOfTuples( numberOfPoints );
+  const float* values = sampleArray->GetPointer( 0 );
+  float* keptValues = keptArray->GetPointer( 0 );
+  vtkIdType numberOfKeptTuples = 0;
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    if ( projections[ pointIndex ] < minimumProjection || projections[ pointIndex ] > maximumProjection )
+    {
+      continue;
+    }
+    for ( int component = 0; component < numberOfComponents; component++ )
+    {
+      keptValues[ numberOfComponents * numberOfKeptTuples + component ] = values[ numberOfComponents * pointIndex + component ];
+    }
+    numberOfKeptTuples++;
+  }
+  keptArray->SetNumberOfTuples( numberOfKeptTuples );
+  keptArray->Squeeze();
+  return keptArray;
+}
+
+//------------------------------------------------------------------------------
+// FNV-1a, so that hashes saved with the scene are the same with every compiler
+static const vtkTypeUInt64 FINGERPRINT_HASH_SEED = 14695981039346656037ULL;
+static vtkTypeUInt64 HashBytes( vtkTypeUInt64 hash, const void* data, size_t numberOfBytes )
+{
+  const unsigned char* bytes = static_cast< const unsigned char* >( data );
+  for ( size_t byteIndex = 0; byteIndex < numberOfBytes; byteIndex++ )
+  {
+    hash = ( hash ^ bytes[ byteIndex ] ) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+// Summary of the geometry of a poly data that is kept when the scene is saved and loaded,
+// unlike its modified time: the numbers of points and cells, and a hash of the coordinates
+static std::string ComputePolyDataFingerprint( vtkPolyData* polyData )
+{
+  if ( polyData == NULL || polyData->GetPoints() == NULL )
+  {
+    return "0 0 0";
+  }
+
+  vtkPoints* points = polyData->GetPoints();
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  vtkTypeUInt64 hash = FINGERPRINT_HASH_SEED;
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    // hashed as double, so that float points read back as double have the same fingerprint
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    points->GetPoint( pointIndex, point );
+    hash = HashBytes( hash, point, sizeof( point ) );
+  }
+
+  std::stringstream fingerprintStream;
+  fingerprintStream << numberOfPoints << " " << polyData->GetNumberOfCells() << " " << std::hex << hash;
+  return fingerprintStream.str();
+}
+
+//------------------------------------------------------------------------------
+// Summary of everything a path fit depends on: the points, the current path data
+// (so paths changed by something else are refit), and the fitting parameters.
+// Display properties such as the color are deliberately left out.
+static std::string ComputeFitFingerprint( vtkMRMLMarkupsToModelNode* markupsToModelNode, vtkMRMLModelNode* pointsNode, vtkMRMLModelNode* pathNode )
+{
+  std::stringstream parametersStream;
+  parametersStream << markupsToModelNode->GetModelType()
+                   << " " << markupsToModelNode->GetCurveType()
+                   << " " << markupsToModelNode->GetTubeRadius()
+                   << " " << markupsToModelNode->GetTubeNumberOfSides()
+                   << " " << markupsToModelNode->GetTubeSegmentsBetweenControlPoints()
+                   << " " << markupsToModelNode->GetTubeLoop()
+                   << " " << markupsToModelNode->GetKochanekBias()
+                   << " " << markupsToModelNode->GetKochanekContinuity()
+                   << " " << markupsToModelNode->GetKochanekTension()
+                   << " " << markupsToModelNode->GetKochanekEndsCopyNearestDerivatives()
+                   << " " << markupsToModelNode->GetPolynomialOrder()
+                   << " " << markupsToModelNode->GetPolynomialSampleWidth()
+                   << " " << markupsToModelNode->GetPointParameterType()
+                   << " " << markupsToModelNode->GetPolynomialFitType()
+                   << " " << markupsToModelNode->GetPolynomialWeightType()
+                   << " " << markupsToModelNode->GetCleanMarkups()
+                   << " " << markupsToModelNode->GetButterflySubdivision()
+                   << " " << markupsToModelNode->GetDelaunayAlpha()
+                   << " " << markupsToModelNode->GetConvexHull();
+
+  // the fingerprint is saved with the scene, so it must not depend on process-local modified times
+  std::string parameters = parametersStream.str();
+  std::stringstream fingerprintStream;
+  fingerprintStream << ComputePolyDataFingerprint( pointsNode->GetPolyData() )
+                    << " " << ComputePolyDataFingerprint( pathNode->GetPolyData() )
+                    << " " << std::hex << HashBytes( FINGERPRINT_HASH_SEED, parameters.c_str(), parameters.size() );
+  return fingerprintStream.str();
+}
+
+//------------------------------------------------------------------------------
+static bool IsPathFitUpToDate( vtkMRMLMarkupsToModelNode* markupsToModelNode, vtkMRMLModelNode* pointsNode, vtkMRMLModelNode* pathNode )
+{
+  const char* fingerprint = pathNode->GetAttribute( vtkMRMLPathReconstructionNode::GetFitFingerprintAttributeName() );
+  return ( fingerprint != NULL && ComputeFitFingerprint( markupsToModelNode, pointsNode, pathNode ) == fingerprint );
+}
+
+//------------------------------------------------------------------------------
+// Call after the path data was replaced by a new fit
+static void StorePathFitFingerprint( vtkMRMLMarkupsToModelNode* markupsToModelNode, vtkMRMLModelNode* pointsNode, vtkMRMLModelNode* pathNode )
+{
+  pathNode->SetAttribute( vtkMRMLPathReconstructionNode::GetFitFingerprintAttributeName(),
+                          ComputeFitFingerprint( markupsToModelNode, pointsNode, pathNode ).c_str() );
+}
+
+//------------------------------------------------------------------------------
+class vtkSlicerPathReconstructionLogic::vtkInternal
+{
+public:
+  // State of a path that is being recorded
+  struct ActiveRecording
+  {
+    vtkWeakPointer< vtkMRMLModelNode > PointsModelNode;
+    vtkWeakPointer< vtkMRMLModelNode > PathModelNode;
+
+    // set if the tube is extended sample by sample (curves only)
+    vtkSmartPointer< vtkIncrementalPathFitter > Fitter;
+    vtkIdType NumberOfPointsFitted;
+
+    // set if samples are buffered
+    vtkWeakPointer< vtkMRMLTransformNode > SamplingTransformNode;
+    vtkWeakPointer< vtkMRMLTransformNode > AnchorTransformNode;
+    vtkSmartPointer< vtkPathSampleBuffer > SampleBuffer;
+    double MinimumDistance;
+    double StartTime; // universal time, timestamps of the points are relative to it
+    vtkSmartPointer< vtkPathSampleDecimator > Decimator; // replaces MinimumDistance if set
+    vtkSmartPointer< vtkPathSampleFilter > Filter; // set if outlier rejection or smoothing is on
+  };
+
+  // Recordings by path reconstruction node and channel. The channels of a node are adjacent.
+  typedef std::pair< vtkMRMLPathReconstructionNode*, int > RecordingChannel;
+  typedef std::map< RecordingChannel, ActiveRecording > ActiveRecordingMap;
+  ActiveRecordingMap ActiveRecordings;
+
+  ActiveRecordingMap::iterator FirstChannel( vtkMRMLPathReconstructionNode* pathReconstructionNode )
+  {
+    return this->ActiveRecordings.lower_bound( RecordingChannel( pathReconstructionNode, 0 ) );
+  }
+
+  // parameters for the decimator of each recording
+  vtkSmartPointer< vtkPathSampleDecimator > SampleDecimator;
+
+  // State of a replay, see StartReplay
+  struct Replay
+  {
+    vtkSmartPointer< vtkPathPoseStream > Poses;
+    double SpeedFactor;
+    double WallStartTime;
+    double StreamStartTime;
+    vtkIdType NextPoseIndex;
+    int CurrentSegment;
+  };
+
+  std::map< vtkMRMLPathReconstructionNode*, Replay > Replays;
+
+  // set while a replayed pose is applied, so its samples get the recorded timestamp
+  bool ReplayingPose;
+  double ReplayPoseTimestamp;
+
+  // Path that still shows its live output, and is waiting for the full resolution fit
+  struct PendingFullResolutionPath
+  {
+    vtkWeakPointer< vtkMRMLPathReconstructionNode > PathReconstructionNode;
+    vtkWeakPointer< vtkMRMLModelNode > PointsModelNode;
+    vtkWeakPointer< vtkMRMLModelNode > PathModelNode;
+    double StopTime; // wall clock, for latency measurements
+  };
+
+  std::vector< PendingFullResolutionPath > PendingFullResolutionPaths;
+
+  std::map< vtkMRMLPathReconstructionNode*, vtkSmartPointer< vtkPathLatencyStatistics > > LatencyStatistics;
+
+  // Hidden points and path model nodes, already in the scene, for the next recordings.
+  // The scene owns them, so pairs whose nodes were removed (e.g. scene close) become null.
+  struct PooledModelNodes
+  {
+    vtkWeakPointer< vtkMRMLModelNode > PointsModelNode;
+    vtkWeakPointer< vtkMRMLModelNode > PathModelNode;
+  };
+  std::deque< PooledModelNodes > ModelNodePool;
+
+  // kept up to date by the scene node added and removed events,
+  // so that filling the pool does not need to search the scene
+  int NumberOfPathReconstructionNodes;
+
+  // One path to be refit on a worker thread
+  struct RefitJob
+  {
+    vtkWeakPointer< vtkMRMLModelNode > PointsModelNode;
+    vtkWeakPointer< vtkMRMLModelNode > PathModelNode;
+    vtkSmartPointer< vtkPoints > InputPoints;
+    vtkSmartPointer< vtkPathFitter > Fitter;
+    vtkSmartPointer< vtkPolyData > OutputPolyData;
+    bool Succeeded;
+  };
+
+  class RefitFunctor
+  {
+  public:
+    RefitFunctor( std::vector< RefitJob >& jobs ) : Jobs( jobs ) {}
+    void operator()( vtkIdType beginJobIndex, vtkIdType endJobIndex )
+    {
+      for ( vtkIdType jobIndex = beginJobIndex; jobIndex < endJobIndex; jobIndex++ )
+      {
+        RefitJob& job = this->Jobs[ jobIndex ];
+        job.Succeeded = job.Fitter->Fit( job.InputPoints, job.OutputPolyData );
+      }
+    }
+  private:
+    std::vector< RefitJob >& Jobs;
+  };
+};
+
 //------------------------------------------------------------------------------
 vtkSlicerPathReconstructionLogic::vtkSlicerPathReconstructionLogic()
 {
+  this->Internal = new vtkInternal();
+  this->ParallelRefit = true;
+  this->BufferedRecording = true;
+  this->SampleBufferCapacity = 4096;
+  this->SampleDecimation = true;
+  this->LatencyMonitoring = false;
+  this->ModelNodePoolSize = 2;
+  this->Internal->SampleDecimator = vtkSmartPointer< vtkPathSampleDecimator >::New();
+  this->Internal->ReplayingPose = false;
+  this->Internal->ReplayPoseTimestamp = 0.0;
+  this->Internal->NumberOfPathReconstructionNodes = 0;
 }
 
 //------------------------------------------------------------------------------
 vtkSlicerPathReconstructionLogic::~vtkSlicerPathReconstructionLogic()
 {
+  delete this->Internal;
 }
 
 //------------------------------------------------------------------------------
 void vtkSlicerPathReconstructionLogic::PrintSelf( ostream& os, vtkIndent indent )
 {
   this->Superclass::PrintSelf( os, indent );
+  os << indent << "ParallelRefit: " << this->ParallelRefit << std::endl;
+  os << indent << "BufferedRecording: " << this->BufferedRecording << std::endl;
+  os << indent << "SampleBufferCapacity: " << this->SampleBufferCapacity << std::endl;
+  os << indent << "SampleDecimation: " << this->SampleDecimation << std::endl;
+  os << indent << "LatencyMonitoring: " << this->LatencyMonitoring << std::endl;
+  os << indent << "ModelNodePoolSize: " << this->ModelNodePoolSize << std::endl;
+  os << indent << "SampleDecimator:" << std::endl;
+  this->Internal->SampleDecimator->PrintSelf( os, indent.GetNextIndent() );
+}
+
+//------------------------------------------------------------------------------
+vtkPathSampleDecimator* vtkSlicerPathReconstructionLogic::GetSampleDecimator()
+{
+  return this->Internal->SampleDecimator;
 }
 
 //------------------------------------------------------------------------------
@@ -59,7 +434,10 @@ void vtkSlicerPathReconstructionLogic::SetMRMLSceneInternal( vtkMRMLScene * newS
   vtkNew<vtkIntArray> events;
   events->InsertNextValue( vtkMRMLScene::NodeAddedEvent );
   events->InsertNextValue( vtkMRMLScene::NodeRemovedEvent );
+  events->InsertNextValue( vtkMRMLScene::EndImportEvent );
+  events->InsertNextValue( vtkMRMLScene::StartCloseEvent );
   this->SetAndObserveMRMLSceneEventsInternal( newScene, events.GetPointer() );
+  this->Internal->NumberOfPathReconstructionNodes = ( newScene != NULL ) ? newScene->GetNumberOfNodesByClass( "vtkMRMLPathReconstructionNode" ) : 0;
 }
 
 //------------------------------------------------------------------------------
@@ -71,6 +449,8 @@ void vtkSlicerPathReconstructionLogic::RegisterNodes()
     return;
   }
   this->GetMRMLScene()->RegisterNodeClass( vtkSmartPointer< vtkMRMLPathReconstructionNode >::New() );
+  this->GetMRMLScene()->RegisterNodeClass( vtkSmartPointer< vtkMRMLPathReconstructionStorageNode >::New() );
+  this->GetMRMLScene()->RegisterNodeClass( vtkSmartPointer< vtkMRMLPathReconstructionPointsModelNode >::New() );
 }
 
 //------------------------------------------------------------------------------
@@ -92,11 +472,13 @@ void vtkSlicerPathReconstructionLogic::OnMRMLSceneNodeAdded( vtkMRMLNode* node )
   if ( pathReconstructionNode )
   {
     vtkDebugMacro( "OnMRMLSceneNodeAdded: Module node added." );
+    this->Internal->NumberOfPathReconstructionNodes++;
     vtkUnObserveMRMLNodeMacro( pathReconstructionNode ); // Remove previous observers.
     vtkNew<vtkIntArray> events;
     events->InsertNextValue( vtkCommand::ModifiedEvent );
     events->InsertNextValue( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
     vtkObserveMRMLNodeEventsMacro( pathReconstructionNode, events.GetPointer() );
+    this->InvokeEvent( PendingWorkEvent ); // the model node pool can be filled now
   }
 }
 
@@ -114,7 +496,68 @@ void vtkSlicerPathReconstructionLogic::OnMRMLSceneNodeRemoved( vtkMRMLNode* node
   {
     vtkDebugMacro( "OnMRMLSceneNodeRemoved" );
     vtkUnObserveMRMLNodeMacro( node );
+    vtkInternal::ActiveRecordingMap::iterator activeRecordingIterator = this->Internal->FirstChannel( pathReconstructionNode );
+    while ( activeRecordingIterator != this->Internal->ActiveRecordings.end() && activeRecordingIterator->first.first == pathReconstructionNode )
+    {
+      this->Internal->ActiveRecordings.erase( activeRecordingIterator++ );
+    }
+    this->Internal->Replays.erase( pathReconstructionNode );
+    this->Internal->LatencyStatistics.erase( pathReconstructionNode );
+    if ( this->Internal->NumberOfPathReconstructionNodes > 0 )
+    {
+      this->Internal->NumberOfPathReconstructionNodes--;
+    }
+    if ( this->Internal->NumberOfPathReconstructionNodes == 0 )
+    {
+      this->RemovePooledModelNodes();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::OnMRMLSceneStartClose()
+{
+  this->RemovePooledModelNodes();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::OnMRMLSceneEndImport()
+{
+  // the points models are in the scene now, so their points can be read from the packed files
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  int numberOfPathReconstructionNodes = scene->GetNumberOfNodesByClass( "vtkMRMLPathReconstructionNode" );
+  for ( int nodeIndex = 0; nodeIndex < numberOfPathReconstructionNodes; nodeIndex++ )
+  {
+    vtkMRMLPathReconstructionNode* pathReconstructionNode = vtkMRMLPathReconstructionNode::SafeDownCast( scene->GetNthNodeByClass( nodeIndex, "vtkMRMLPathReconstructionNode" ) );
+    if ( pathReconstructionNode != NULL )
+    {
+      pathReconstructionNode->ReadPackedPoints();
+    }
+  }
+  if ( numberOfPathReconstructionNodes > 0 )
+  {
+    this->InvokeEvent( PendingWorkEvent ); // pooled nodes are not added while importing
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::ProcessMRMLNodesEvents( vtkObject* caller, unsigned long event, void* callData )
+{
+  vtkMRMLModelNode* pointsModelNode = vtkMRMLModelNode::SafeDownCast( caller );
+  if ( pointsModelNode != NULL && event == vtkMRMLModelNode::PolyDataModifiedEvent )
+  {
+    this->UpdateIncrementalPath( pointsModelNode );
+    return;
+  }
+
+  vtkMRMLTransformNode* samplingTransformNode = vtkMRMLTransformNode::SafeDownCast( caller );
+  if ( samplingTransformNode != NULL && event == vtkMRMLTransformableNode::TransformModifiedEvent )
+  {
+    this->PushSample( samplingTransformNode );
+    return;
   }
+
+  this->Superclass::ProcessMRMLNodesEvents( caller, event, callData );
 }
 
 //------------------------------------------------------------------------------
@@ -148,6 +591,251 @@ void vtkSlicerPathReconstructionLogic::DeleteLastPath( vtkMRMLPathReconstruction
   }
 }
 
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::DeletePaths( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkIntArray* suffixes )
+{
+  if ( pathReconstructionNode == NULL )
+  {
+    vtkErrorMacro( "Path reconstruction node is not set. Cannot delete paths." );
+    return;
+  }
+
+  if ( suffixes == NULL )
+  {
+    vtkErrorMacro( "Suffixes array is null. Cannot delete paths." );
+    return;
+  }
+
+  vtkIdType numberOfSuffixes = suffixes->GetNumberOfTuples();
+  if ( numberOfSuffixes <= 0 )
+  {
+    return;
+  }
+
+  // Look up all nodes first, references are removed below
+  std::vector< vtkSmartPointer< vtkMRMLNode > > nodesToRemove;
+  std::vector< int > suffixesToRemove;
+  for ( vtkIdType suffixIndex = 0; suffixIndex < numberOfSuffixes; suffixIndex++ )
+  {
+    int suffix = suffixes->GetValue( suffixIndex );
+    vtkMRMLModelNode* pathModelNode = pathReconstructionNode->GetPathModelNodeBySuffix( suffix );
+    vtkMRMLModelNode* pointsModelNode = pathReconstructionNode->GetPointsModelNodeBySuffix( suffix );
+    if ( pathModelNode != NULL )
+    {
+      nodesToRemove.push_back( pathModelNode );
+    }
+    if ( pointsModelNode != NULL )
+    {
+      nodesToRemove.push_back( pointsModelNode );
+    }
+    suffixesToRemove.push_back( suffix );
+  }
+
+  vtkMRMLScene* scene = pathReconstructionNode->GetScene();
+  if ( scene != NULL )
+  {
+    scene->StartState( vtkMRMLScene::BatchProcessState );
+  }
+  int wasModifying = pathReconstructionNode->StartModify();
+
+  for ( std::vector< int >::iterator suffixIterator = suffixesToRemove.begin(); suffixIterator != suffixesToRemove.end(); suffixIterator++ )
+  {
+    pathReconstructionNode->RemovePointsPathPairBySuffix( *suffixIterator );
+  }
+
+  if ( scene != NULL )
+  {
+    for ( std::vector< vtkSmartPointer< vtkMRMLNode > >::iterator nodeIterator = nodesToRemove.begin(); nodeIterator != nodesToRemove.end(); nodeIterator++ )
+    {
+      scene->RemoveNode( *nodeIterator );
+    }
+  }
+  else
+  {
+    vtkWarningMacro( "Scene is null. Cannot delete points and path models from the scene." );
+  }
+
+  pathReconstructionNode->EndModify( wasModifying );
+  if ( scene != NULL )
+  {
+    scene->EndState( vtkMRMLScene::BatchProcessState );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::DeleteAllPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode )
+{
+  if ( pathReconstructionNode == NULL )
+  {
+    vtkErrorMacro( "Path reconstruction node is not set. Cannot delete all paths." );
+    return;
+  }
+
+  vtkSmartPointer< vtkIntArray > suffixes = vtkSmartPointer< vtkIntArray >::New();
+  pathReconstructionNode->GetSuffixes( suffixes );
+  this->DeletePaths( pathReconstructionNode, suffixes );
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathReconstructionLogic::TrimPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode, double nearTrimDistance, double farTrimDistance )
+{
+  if ( pathReconstructionNode == NULL )
+  {
+    vtkErrorMacro( "Path reconstruction node is not set. Cannot trim paths." );
+    return false;
+  }
+
+  // only paths with points can be trimmed
+  std::vector< int > suffixes;
+  std::vector< vtkPolyData* > pathPolyDatas;
+  std::vector< vtkPoints* > pathPoints;
+  vtkSmartPointer< vtkIntArray > allSuffixes = vtkSmartPointer< vtkIntArray >::New();
+  pathReconstructionNode->GetSuffixes( allSuffixes );
+  vtkIdType numberOfSuffixes = allSuffixes->GetNumberOfTuples();
+  for ( vtkIdType suffixIndex = 0; suffixIndex < numberOfSuffixes; suffixIndex++ )
+  {
+    int suffix = allSuffixes->GetValue( suffixIndex );
+    vtkMRMLModelNode* pointsModelNode = pathReconstructionNode->GetPointsModelNodeBySuffix( suffix );
+    if ( pointsModelNode == NULL || pointsModelNode->GetPolyData() == NULL ||
+         pointsModelNode->GetPolyData()->GetPoints() == NULL || pointsModelNode->GetPolyData()->GetNumberOfPoints() == 0 )
+    {
+      vtkWarningMacro( "Path " << suffix << " has no points. It will not be trimmed." );
+      continue;
+    }
+    suffixes.push_back( suffix );
+    pathPolyDatas.push_back( pointsModelNode->GetPolyData() );
+    pathPoints.push_back( pointsModelNode->GetPolyData()->GetPoints() );
+  }
+  if ( suffixes.empty() )
+  {
+    vtkWarningMacro( "There are no paths to trim." );
+    return false;
+  }
+  int numberOfPaths = (int)suffixes.size();
+
+  // Average direction of the paths, from the cached first and last points.
+  // Directions are flipped to agree with the first path, and the sum is negated
+  // so that near and far are the same ends as in earlier versions of the module.
+  // The reference is the first path that has a non-zero direction.
+  double averageDirection[ 3 ] = { 0.0, 0.0, 0.0 };
+  double firstDirection[ 3 ] = { 0.0, 0.0, 0.0 };
+  bool firstDirectionFound = false;
+  for ( int pathIndex = 0; pathIndex < numberOfPaths; pathIndex++ )
+  {
+    double firstPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+    double lastPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+    pathReconstructionNode->GetPathFirstPoint( suffixes[ pathIndex ], firstPoint );
+    pathReconstructionNode->GetPathLastPoint( suffixes[ pathIndex ], lastPoint );
+    double direction[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkMath::Subtract( lastPoint, firstPoint, direction );
+    if ( !firstDirectionFound && vtkMath::Norm( direction ) > 0.0 )
+    {
+      firstDirection[ 0 ] = direction[ 0 ];
+      firstDirection[ 1 ] = direction[ 1 ];
+      firstDirection[ 2 ] = direction[ 2 ];
+      firstDirectionFound = true;
+    }
+    double sign = ( vtkMath::Dot( firstDirection, direction ) > 0.0 ) ? -1.0 : 1.0;
+    averageDirection[ 0 ] += sign * direction[ 0 ];
+    averageDirection[ 1 ] += sign * direction[ 1 ];
+    averageDirection[ 2 ] += sign * direction[ 2 ];
+  }
+  if ( vtkMath::Normalize( averageDirection ) == 0.0 )
+  {
+    vtkWarningMacro( "Paths have no length. Cannot trim paths." );
+    return false;
+  }
+
+  // range along the average direction that is covered by every path
+  std::vector< std::vector< double > > projections( numberOfPaths );
+  double rangeMinimum = -std::numeric_limits< double >::infinity();
+  double rangeMaximum = std::numeric_limits< double >::infinity();
+  for ( int pathIndex = 0; pathIndex < numberOfPaths; pathIndex++ )
+  {
+    ProjectPoints( pathPoints[ pathIndex ], averageDirection, projections[ pathIndex ] );
+    std::pair< std::vector< double >::const_iterator, std::vector< double >::const_iterator > pathRange =
+      std::minmax_element( projections[ pathIndex ].begin(), projections[ pathIndex ].end() );
+    rangeMinimum = std::max( rangeMinimum, *pathRange.first );
+    rangeMaximum = std::min( rangeMaximum, *pathRange.second );
+  }
+  rangeMinimum += nearTrimDistance;
+  rangeMaximum -= farTrimDistance;
+
+  // compact each path in one pass, and replace its points polydata
+  int wasModifying = pathReconstructionNode->StartModify();
+  for ( int pathIndex = 0; pathIndex < numberOfPaths; pathIndex++ )
+  {
+    vtkPoints* points = pathPoints[ pathIndex ];
+    vtkIdType numberOfPoints = points->GetNumberOfPoints();
+    const double* pathProjections = &projections[ pathIndex ][ 0 ];
+
+    vtkSmartPointer< vtkPoints > keptPoints = vtkSmartPointer< vtkPoints >::New();
+    keptPoints->SetDataType( points->GetDataType() );
+    keptPoints->SetNumberOfPoints( numberOfPoints );
+    vtkIdType numberOfKeptPoints = 0;
+    switch ( points->GetDataType() )
+    {
+    case VTK_FLOAT:
+      numberOfKeptPoints = CompactCoordinates( static_cast< float* >( points->GetData()->GetVoidPointer( 0 ) ), pathProjections, numberOfPoints,
+                                               rangeMinimum, rangeMaximum, static_cast< float* >( keptPoints->GetData()->GetVoidPointer( 0 ) ) );
+      break;
+    case VTK_DOUBLE:
+      numberOfKeptPoints = CompactCoordinates( static_cast< double* >( points->GetData()->GetVoidPointer( 0 ) ), pathProjections, numberOfPoints,
+                                               rangeMinimum, rangeMaximum, static_cast< double* >( keptPoints->GetData()->GetVoidPointer( 0 ) ) );
+      break;
+    default:
+      for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+      {
+        if ( pathProjections[ pointIndex ] >= rangeMinimum && pathProjections[ pointIndex ] <= rangeMaximum )
+        {
+          keptPoints->SetPoint( numberOfKeptPoints++, points->GetPoint( pointIndex ) );
+        }
+      }
+      break;
+    }
+    keptPoints->SetNumberOfPoints( numberOfKeptPoints );
+    keptPoints->Squeeze();
+
+    // one vertex per point, written directly as ( 1, pointId ) pairs
+    vtkSmartPointer< vtkIdTypeArray > vertConnectivity = vtkSmartPointer< vtkIdTypeArray >::New();
+    vertConnectivity->SetNumberOfValues( 2 * numberOfKeptPoints );
+    vtkIdType* vertIds = vertConnectivity->GetPointer( 0 );
+    for ( vtkIdType pointIndex = 0; pointIndex < numberOfKeptPoints; pointIndex++ )
+    {
+      vertIds[ 2 * pointIndex + 0 ] = 1;
+      vertIds[ 2 * pointIndex + 1 ] = pointIndex;
+    }
+    vtkSmartPointer< vtkCellArray > keptVerts = vtkSmartPointer< vtkCellArray >::New();
+    keptVerts->SetCells( numberOfKeptPoints, vertConnectivity );
+
+    vtkSmartPointer< vtkPolyData > keptPolyData = vtkSmartPointer< vtkPolyData >::New();
+    keptPolyData->SetPoints( keptPoints );
+    keptPolyData->SetVerts( keptVerts );
+
+    // recorded timestamps and orientations stay with their points
+    vtkFloatArray* timestamps = GetSampleArray( pathPolyDatas[ pathIndex ], vtkMRMLPathReconstructionNode::GetPointTimestampArrayName(), 1 );
+    if ( timestamps != NULL )
+    {
+      keptPolyData->GetPointData()->AddArray( CompactSampleArray( timestamps, pathProjections, numberOfPoints, rangeMinimum, rangeMaximum ) );
+    }
+    vtkFloatArray* orientations = GetSampleArray( pathPolyDatas[ pathIndex ], vtkMRMLPathReconstructionNode::GetPointOrientationArrayName(), 4 );
+    if ( orientations != NULL )
+    {
+      keptPolyData->GetPointData()->AddArray( CompactSampleArray( orientations, pathProjections, numberOfPoints, rangeMinimum, rangeMaximum ) );
+    }
+    pathReconstructionNode->GetPointsModelNodeBySuffix( suffixes[ pathIndex ] )->SetAndObservePolyData( keptPolyData );
+
+    // the curve length of the last fit no longer matches the points
+    vtkMRMLModelNode* pathModelNode = pathReconstructionNode->GetPathModelNodeBySuffix( suffixes[ pathIndex ] );
+    if ( pathModelNode != NULL )
+    {
+      pathModelNode->RemoveAttribute( vtkMRMLMarkupsToModelNode::GetOutputCurveLengthAttributeName() );
+    }
+  }
+  pathReconstructionNode->EndModify( wasModifying );
+  return true;
+}
+
 //------------------------------------------------------------------------------
 bool vtkSlicerPathReconstructionLogic::IsRecordingPossible( vtkMRMLPathReconstructionNode* pathReconstructionNode )
 {
@@ -194,25 +882,70 @@ void vtkSlicerPathReconstructionLogic::StartRecording( vtkMRMLPathReconstruction
     return;
   }
 
+  int numberOfChannels = pathReconstructionNode->GetNumberOfChannels();
+  if ( numberOfChannels > 1 && !this->BufferedRecording )
+  {
+    vtkWarningMacro( "Additional channels can only be recorded with buffered recording. Only channel 0 will be recorded." );
+    numberOfChannels = 1;
+  }
+
+  // All channels are queued by the same transform observer and drained by the same ProcessPendingSamples
+  for ( int channel = 0; channel < numberOfChannels; channel++ )
+  {
+    vtkMRMLTransformNode* samplingTransformNode = pathReconstructionNode->GetChannelSamplingTransformNode( channel );
+    if ( samplingTransformNode == NULL )
+    {
+      vtkWarningMacro( "Channel " << channel << " has no sampling transform. It will not be recorded." );
+      continue;
+    }
+    this->StartRecordingChannel( pathReconstructionNode, channel, samplingTransformNode );
+  }
+
+  pathReconstructionNode->SetRecordingStateToRecording();
+  this->InvokeEvent( PendingWorkEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::StartRecordingChannel( vtkMRMLPathReconstructionNode* pathReconstructionNode, int channel, vtkMRMLTransformNode* samplingTransformNode )
+{
   const char* anchorTransformNodeID = NULL;
   if ( pathReconstructionNode->GetAnchorTransformNode() != NULL )
   {
     anchorTransformNodeID = pathReconstructionNode->GetAnchorTransformNode()->GetID();
   }
 
-  // create node for points storage
-  vtkSmartPointer< vtkMRMLModelNode > pointsNode = vtkSmartPointer< vtkMRMLModelNode >::New();
-  this->GetMRMLScene()->AddNode( pointsNode );
-  std::stringstream pointsNameStream;
-  pointsNameStream << pathReconstructionNode->GetPointsBaseName() << pathReconstructionNode->GetNextCount();
+  // create nodes for points and path storage, or take them from the pool if it has any
+  vtkSmartPointer< vtkMRMLModelNode > pointsNode;
+  vtkSmartPointer< vtkMRMLModelNode > pathNode;
+  if ( !this->TakePooledModelNodes( pointsNode, pathNode ) )
+  {
+    pointsNode = vtkSmartPointer< vtkMRMLPathReconstructionPointsModelNode >::New();
+    this->GetMRMLScene()->AddNode( pointsNode );
+    pathNode = vtkSmartPointer< vtkMRMLModelNode >::New();
+    this->GetMRMLScene()->AddNode( pathNode );
+  }
+
+  std::stringstream pointsNameStream;
+  pointsNameStream << pathReconstructionNode->GetPointsBaseName() << pathReconstructionNode->GetNextCount();
   pointsNode->SetName( pointsNameStream.str().c_str() );
   pointsNode->SetAndObserveTransformNodeID( anchorTransformNodeID );
 
+  // CollectPoints and MarkupsToModel only serve the first channel
   vtkMRMLCollectPointsNode* collectPointsNode = pathReconstructionNode->GetCollectPointsNode();
   const char* pointsNodeID = pointsNode->GetID();
-  collectPointsNode->SetOutputNodeID( pointsNodeID );
-  collectPointsNode->CreateDefaultDisplayNodesForOutputNode();
-  collectPointsNode->SetCollectModeToAutomatic();
+  if ( channel == 0 )
+  {
+    collectPointsNode->SetOutputNodeID( pointsNodeID );
+    collectPointsNode->CreateDefaultDisplayNodesForOutputNode();
+    if ( !this->BufferedRecording )
+    {
+      collectPointsNode->SetCollectModeToAutomatic();
+    }
+  }
+  else
+  {
+    pointsNode->CreateDefaultDisplayNodes();
+  }
 
   vtkMRMLModelDisplayNode* pointsDisplayNode = pointsNode->GetModelDisplayNode();
   double pointsRed = pathReconstructionNode->GetPointsColorRed();
@@ -220,9 +953,6 @@ void vtkSlicerPathReconstructionLogic::StartRecording( vtkMRMLPathReconstruction
   double pointsBlue = pathReconstructionNode->GetPointsColorBlue();
   pointsDisplayNode->SetColor( pointsRed, pointsGreen, pointsBlue );
 
-  // create node for path storage
-  vtkSmartPointer< vtkMRMLModelNode > pathNode = vtkSmartPointer< vtkMRMLModelNode >::New();
-  this->GetMRMLScene()->AddNode( pathNode );
   std::stringstream pathNameStream;
   pathNameStream << pathReconstructionNode->GetPathBaseName() << pathReconstructionNode->GetNextCount();
   pathNode->SetName( pathNameStream.str().c_str() );
@@ -230,10 +960,91 @@ void vtkSlicerPathReconstructionLogic::StartRecording( vtkMRMLPathReconstruction
   pathNode->CreateDefaultDisplayNodes();
 
   vtkMRMLMarkupsToModelNode* markupsToModelNode = pathReconstructionNode->GetMarkupsToModelNode();
-  markupsToModelNode->SetAndObserveInputNodeID( pointsNodeID );
   const char* pathNodeID = pathNode->GetID();
-  markupsToModelNode->SetAndObserveOutputModelNodeID( pathNodeID );
-  markupsToModelNode->SetAutoUpdateOutput( true );
+  if ( channel == 0 )
+  {
+    markupsToModelNode->SetAndObserveInputNodeID( pointsNodeID );
+    markupsToModelNode->SetAndObserveOutputModelNodeID( pathNodeID );
+  }
+
+  vtkInternal::ActiveRecording& activeRecording = this->Internal->ActiveRecordings[ vtkInternal::RecordingChannel( pathReconstructionNode, channel ) ];
+  activeRecording = vtkInternal::ActiveRecording();
+  activeRecording.PointsModelNode = pointsNode;
+  activeRecording.PathModelNode = pathNode;
+  activeRecording.NumberOfPointsFitted = 0;
+  activeRecording.MinimumDistance = 0.0;
+  activeRecording.StartTime = 0.0;
+
+  if ( this->BufferedRecording )
+  {
+    // The transform observer only queues the sample, ProcessPendingSamples adds the queued samples to the points model
+    activeRecording.SamplingTransformNode = samplingTransformNode;
+    activeRecording.AnchorTransformNode = pathReconstructionNode->GetAnchorTransformNode();
+    activeRecording.MinimumDistance = collectPointsNode->GetMinimumDistance();
+    activeRecording.SampleBuffer = vtkSmartPointer< vtkPathSampleBuffer >::New();
+    activeRecording.SampleBuffer->SetCapacity( this->SampleBufferCapacity );
+    activeRecording.StartTime = this->GetSampleTime();
+    std::stringstream startTimeStream;
+    startTimeStream << std::setprecision( 17 ) << activeRecording.StartTime;
+    pointsNode->SetAttribute( vtkMRMLPathReconstructionNode::GetRecordingStartTimeAttributeName(), startTimeStream.str().c_str() );
+    if ( this->SampleDecimation )
+    {
+      activeRecording.Decimator = vtkSmartPointer< vtkPathSampleDecimator >::New();
+      activeRecording.Decimator->CopyParameters( this->Internal->SampleDecimator );
+      activeRecording.Decimator->SetMinimumDistance( std::max( activeRecording.MinimumDistance, this->Internal->SampleDecimator->GetMinimumDistance() ) );
+    }
+    if ( pathReconstructionNode->GetSampleOutlierRejection() || pathReconstructionNode->GetSampleSmoothing() )
+    {
+      activeRecording.Filter = vtkSmartPointer< vtkPathSampleFilter >::New();
+      activeRecording.Filter->SetOutlierRejection( pathReconstructionNode->GetSampleOutlierRejection() );
+      activeRecording.Filter->SetOutlierWindowSize( pathReconstructionNode->GetOutlierWindowSize() );
+      activeRecording.Filter->SetOutlierThreshold( pathReconstructionNode->GetOutlierThreshold() );
+      activeRecording.Filter->SetSmoothing( pathReconstructionNode->GetSampleSmoothing() );
+      activeRecording.Filter->SetSmoothingProcessNoise( pathReconstructionNode->GetSmoothingProcessNoise() );
+      activeRecording.Filter->SetSmoothingMeasurementNoise( pathReconstructionNode->GetSmoothingMeasurementNoise() );
+    }
+
+    vtkMRMLTransformNode* observedSamplingTransformNode = activeRecording.SamplingTransformNode;
+    vtkNew<vtkIntArray> samplingTransformEvents;
+    samplingTransformEvents->InsertNextValue( vtkMRMLTransformableNode::TransformModifiedEvent );
+    vtkObserveMRMLNodeEventsMacro( observedSamplingTransformNode, samplingTransformEvents.GetPointer() );
+  }
+
+  int liveLevelOfDetail = pathReconstructionNode->GetLiveLevelOfDetail();
+  if ( markupsToModelNode->GetModelType() == vtkMRMLMarkupsToModelNode::Curve ||
+       liveLevelOfDetail != vtkMRMLPathReconstructionNode::LevelOfDetailFullTube || channel > 0 )
+  {
+    // Extend the path locally as samples arrive. The full resolution path is generated after recording stops.
+    // The MarkupsToModel node belongs to channel 0, other channels only have their own fitter.
+    if ( channel == 0 )
+    {
+      markupsToModelNode->SetAutoUpdateOutput( false );
+    }
+
+    activeRecording.Fitter = vtkSmartPointer< vtkIncrementalPathFitter >::New();
+    activeRecording.Fitter->SetTubeRadius( markupsToModelNode->GetTubeRadius() );
+    int tubeNumberOfSides = markupsToModelNode->GetTubeNumberOfSides();
+    if ( liveLevelOfDetail == vtkMRMLPathReconstructionNode::LevelOfDetailPolyline )
+    {
+      activeRecording.Fitter->SetOutputTube( false );
+    }
+    else if ( liveLevelOfDetail == vtkMRMLPathReconstructionNode::LevelOfDetailCoarseTube )
+    {
+      tubeNumberOfSides = std::min( tubeNumberOfSides, COARSE_TUBE_NUMBER_OF_SIDES );
+    }
+    activeRecording.Fitter->SetTubeNumberOfSides( tubeNumberOfSides );
+    pathNode->SetAndObservePolyData( activeRecording.Fitter->GetOutput() );
+
+    vtkMRMLModelNode* observedPointsNode = pointsNode;
+    vtkNew<vtkIntArray> pointsEvents;
+    pointsEvents->InsertNextValue( vtkMRMLModelNode::PolyDataModifiedEvent );
+    vtkObserveMRMLNodeEventsMacro( observedPointsNode, pointsEvents.GetPointer() );
+  }
+  else
+  {
+    // Full resolution surfaces cannot be extended locally, so fall back to refitting on every sample
+    markupsToModelNode->SetAutoUpdateOutput( true );
+  }
 
   vtkMRMLModelDisplayNode* pathDisplayNode = pathNode->GetModelDisplayNode();
   double pathRed = pathReconstructionNode->GetPathColorRed();
@@ -242,7 +1053,6 @@ void vtkSlicerPathReconstructionLogic::StartRecording( vtkMRMLPathReconstruction
   pathDisplayNode->SetColor( pathRed, pathGreen, pathBlue );
 
   // housekeeping
-  pathReconstructionNode->SetRecordingStateToRecording();
   pathReconstructionNode->AddPointsPathPairModelNodeIDs( pointsNodeID, pathNodeID );
   pathReconstructionNode->SetNextCount( pathReconstructionNode->GetNextCount() + 1 );
 }
@@ -263,16 +1073,834 @@ void vtkSlicerPathReconstructionLogic::StopRecording( vtkMRMLPathReconstructionN
   }
 
   vtkMRMLMarkupsToModelNode* markupsToModelNode = pathReconstructionNode->GetMarkupsToModelNode();
+
+  // add the samples that are still queued
+  this->DrainSampleBuffer( pathReconstructionNode );
+
+  vtkInternal::ActiveRecordingMap::iterator activeRecordingIterator = this->Internal->FirstChannel( pathReconstructionNode );
+  while ( activeRecordingIterator != this->Internal->ActiveRecordings.end() && activeRecordingIterator->first.first == pathReconstructionNode )
+  {
+    vtkInternal::ActiveRecording& activeRecording = activeRecordingIterator->second;
+    bool wasIncremental = ( activeRecording.Fitter != NULL );
+
+    vtkMRMLModelNode* pointsModelNode = activeRecording.PointsModelNode;
+    if ( activeRecording.Decimator != NULL && pointsModelNode != NULL )
+    {
+      std::stringstream keptStream;
+      keptStream << activeRecording.Decimator->GetNumberOfKeptSamples();
+      pointsModelNode->SetAttribute( vtkMRMLPathReconstructionNode::GetNumberOfKeptSamplesAttributeName(), keptStream.str().c_str() );
+      std::stringstream droppedStream;
+      droppedStream << activeRecording.Decimator->GetNumberOfDroppedSamples();
+      pointsModelNode->SetAttribute( vtkMRMLPathReconstructionNode::GetNumberOfDroppedSamplesAttributeName(), droppedStream.str().c_str() );
+      vtkDebugMacro( "Kept " << activeRecording.Decimator->GetNumberOfKeptSamples() << " and dropped "
+                     << activeRecording.Decimator->GetNumberOfDroppedSamples() << " samples of " << pointsModelNode->GetName() << "." );
+    }
+    if ( activeRecording.Filter != NULL && pointsModelNode != NULL )
+    {
+      std::stringstream rejectedStream;
+      rejectedStream << activeRecording.Filter->GetNumberOfRejectedSamples();
+      pointsModelNode->SetAttribute( vtkMRMLPathReconstructionNode::GetNumberOfRejectedSamplesAttributeName(), rejectedStream.str().c_str() );
+    }
+
+    vtkMRMLModelNode* observedPointsNode = activeRecording.PointsModelNode;
+    if ( wasIncremental && observedPointsNode != NULL )
+    {
+      vtkUnObserveMRMLNodeMacro( observedPointsNode );
+    }
+
+    // the sampling transform may be shared with another recording that is still active
+    vtkMRMLTransformNode* observedSamplingTransformNode = activeRecording.SamplingTransformNode;
+    bool samplingTransformStillUsed = false;
+    vtkInternal::ActiveRecordingMap::iterator otherRecordingIterator;
+    for ( otherRecordingIterator = this->Internal->ActiveRecordings.begin(); otherRecordingIterator != this->Internal->ActiveRecordings.end(); otherRecordingIterator++ )
+    {
+      if ( otherRecordingIterator != activeRecordingIterator && otherRecordingIterator->second.SamplingTransformNode == observedSamplingTransformNode )
+      {
+        samplingTransformStillUsed = true;
+      }
+    }
+    if ( observedSamplingTransformNode != NULL && !samplingTransformStillUsed )
+    {
+      vtkUnObserveMRMLNodeMacro( observedSamplingTransformNode );
+    }
+
+    // The live output is only meant for display while recording. It is replaced by a fit
+    // of the whole path on the next ProcessPendingSamples, or when requested.
+    if ( wasIncremental && pathReconstructionNode->GetFullResolutionOnStop() )
+    {
+      vtkInternal::PendingFullResolutionPath pendingPath;
+      pendingPath.PathReconstructionNode = pathReconstructionNode;
+      pendingPath.PointsModelNode = activeRecording.PointsModelNode;
+      pendingPath.PathModelNode = activeRecording.PathModelNode;
+      pendingPath.StopTime = vtkTimerLog::GetUniversalTime();
+      this->Internal->PendingFullResolutionPaths.push_back( pendingPath );
+    }
+
+    this->Internal->ActiveRecordings.erase( activeRecordingIterator++ );
+  }
+
   if ( markupsToModelNode != NULL )
   {
     markupsToModelNode->SetAutoUpdateOutput( false );
   }
 
   pathReconstructionNode->SetRecordingStateToStopped();
+  this->InvokeEvent( PendingWorkEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::UpdateIncrementalPath( vtkMRMLModelNode* pointsModelNode )
+{
+  vtkInternal::ActiveRecordingMap::iterator activeRecordingIterator;
+  for ( activeRecordingIterator = this->Internal->ActiveRecordings.begin(); activeRecordingIterator != this->Internal->ActiveRecordings.end(); activeRecordingIterator++ )
+  {
+    vtkInternal::ActiveRecording& activeRecording = activeRecordingIterator->second;
+    if ( activeRecording.PointsModelNode != pointsModelNode || activeRecording.Fitter == NULL )
+    {
+      continue;
+    }
+
+    vtkPolyData* pointsPolyData = pointsModelNode->GetPolyData();
+    if ( pointsPolyData == NULL || pointsPolyData->GetPoints() == NULL )
+    {
+      return;
+    }
+
+    vtkPoints* points = pointsPolyData->GetPoints();
+    vtkIdType numberOfPoints = points->GetNumberOfPoints();
+    if ( numberOfPoints < activeRecording.NumberOfPointsFitted )
+    {
+      // points were removed (e.g. the points were cleared), so start over
+      activeRecording.Fitter->Reset();
+      activeRecording.NumberOfPointsFitted = 0;
+    }
+    activeRecording.Fitter->AppendPoints( points, activeRecording.NumberOfPointsFitted );
+    activeRecording.NumberOfPointsFitted = numberOfPoints;
+    return;
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::PushSample( vtkMRMLTransformNode* samplingTransformNode )
+{
+  double timestamp = this->GetSampleTime();
+  double receivedTime = vtkTimerLog::GetUniversalTime();
+
+  vtkInternal::ActiveRecordingMap::iterator activeRecordingIterator;
+  for ( activeRecordingIterator = this->Internal->ActiveRecordings.begin(); activeRecordingIterator != this->Internal->ActiveRecordings.end(); activeRecordingIterator++ )
+  {
+    vtkInternal::ActiveRecording& activeRecording = activeRecordingIterator->second;
+    if ( activeRecording.SampleBuffer == NULL || activeRecording.SamplingTransformNode != samplingTransformNode )
+    {
+      continue;
+    }
+
+    // pose of the sampling origin in anchor coordinates (the points model is under the anchor transform)
+    vtkSmartPointer< vtkMatrix4x4 > samplingToAnchorMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+    vtkMRMLTransformNode::GetMatrixTransformBetweenNodes( samplingTransformNode, activeRecording.AnchorTransformNode, samplingToAnchorMatrix );
+    double position[ 3 ];
+    double rotation[ 3 ][ 3 ];
+    for ( int row = 0; row < 3; row++ )
+    {
+      position[ row ] = samplingToAnchorMatrix->GetElement( row, 3 );
+      for ( int column = 0; column < 3; column++ )
+      {
+        rotation[ row ][ column ] = samplingToAnchorMatrix->GetElement( row, column );
+      }
+    }
+    // remove any scaling or shear before converting to a quaternion
+    vtkMath::Orthogonalize3x3( rotation, rotation );
+    double orientation[ 4 ];
+    vtkMath::Matrix3x3ToQuaternion( rotation, orientation );
+
+    // only queue the sample, points are added and fitted by the next ProcessPendingSamples
+    activeRecording.SampleBuffer->PushSample( timestamp, position, orientation, receivedTime );
+  }
+}
+
+//------------------------------------------------------------------------------
+double vtkSlicerPathReconstructionLogic::GetSampleTime()
+{
+  if ( this->Internal->ReplayingPose )
+  {
+    return this->Internal->ReplayPoseTimestamp;
+  }
+  return vtkTimerLog::GetUniversalTime();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::AddLatency( vtkMRMLPathReconstructionNode* pathReconstructionNode, int stage, double latencySeconds )
+{
+  if ( !this->LatencyMonitoring || pathReconstructionNode == NULL )
+  {
+    return;
+  }
+  vtkSmartPointer< vtkPathLatencyStatistics >& latencyStatistics = this->Internal->LatencyStatistics[ pathReconstructionNode ];
+  if ( latencyStatistics == NULL )
+  {
+    latencyStatistics = vtkSmartPointer< vtkPathLatencyStatistics >::New();
+  }
+  latencyStatistics->AddLatency( stage, latencySeconds );
+}
+
+//------------------------------------------------------------------------------
+vtkPathLatencyStatistics* vtkSlicerPathReconstructionLogic::GetLatencyStatistics( vtkMRMLPathReconstructionNode* pathReconstructionNode )
+{
+  std::map< vtkMRMLPathReconstructionNode*, vtkSmartPointer< vtkPathLatencyStatistics > >::iterator latencyStatisticsIterator =
+    this->Internal->LatencyStatistics.find( pathReconstructionNode );
+  if ( latencyStatisticsIterator == this->Internal->LatencyStatistics.end() )
+  {
+    return NULL;
+  }
+  return latencyStatisticsIterator->second;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathReconstructionLogic::WriteLatencyStatisticsToTableNode( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkMRMLTableNode* tableNode )
+{
+  if ( pathReconstructionNode == NULL || tableNode == NULL )
+  {
+    vtkErrorMacro( "Path reconstruction node or table node is null. Cannot write latency statistics." );
+    return false;
+  }
+  vtkPathLatencyStatistics* latencyStatistics = this->GetLatencyStatistics( pathReconstructionNode );
+  if ( latencyStatistics == NULL )
+  {
+    vtkWarningMacro( "No latencies were measured for " << pathReconstructionNode->GetName() << ". Enable latency monitoring before recording." );
+    return false;
+  }
+
+  const int numberOfStages = vtkPathLatencyStatistics::Stage_Last;
+  vtkSmartPointer< vtkStringArray > stageArray = vtkSmartPointer< vtkStringArray >::New();
+  stageArray->SetName( "Stage" );
+  stageArray->SetNumberOfValues( numberOfStages );
+  vtkSmartPointer< vtkDoubleArray > countArray = vtkSmartPointer< vtkDoubleArray >::New();
+  countArray->SetName( "Count" );
+  countArray->SetNumberOfValues( numberOfStages );
+  vtkSmartPointer< vtkDoubleArray > p50Array = vtkSmartPointer< vtkDoubleArray >::New();
+  p50Array->SetName( "P50 (ms)" );
+  p50Array->SetNumberOfValues( numberOfStages );
+  vtkSmartPointer< vtkDoubleArray > p95Array = vtkSmartPointer< vtkDoubleArray >::New();
+  p95Array->SetName( "P95 (ms)" );
+  p95Array->SetNumberOfValues( numberOfStages );
+  vtkSmartPointer< vtkDoubleArray > p99Array = vtkSmartPointer< vtkDoubleArray >::New();
+  p99Array->SetName( "P99 (ms)" );
+  p99Array->SetNumberOfValues( numberOfStages );
+  vtkSmartPointer< vtkDoubleArray > maximumArray = vtkSmartPointer< vtkDoubleArray >::New();
+  maximumArray->SetName( "Max (ms)" );
+  maximumArray->SetNumberOfValues( numberOfStages );
+
+  for ( int stage = 0; stage < numberOfStages; stage++ )
+  {
+    stageArray->SetValue( stage, vtkPathLatencyStatistics::GetStageName( stage ) );
+    countArray->SetValue( stage, latencyStatistics->GetNumberOfLatencies( stage ) );
+    p50Array->SetValue( stage, 1000.0 * latencyStatistics->GetLatencyPercentile( stage, 50.0 ) );
+    p95Array->SetValue( stage, 1000.0 * latencyStatistics->GetLatencyPercentile( stage, 95.0 ) );
+    p99Array->SetValue( stage, 1000.0 * latencyStatistics->GetLatencyPercentile( stage, 99.0 ) );
+    maximumArray->SetValue( stage, 1000.0 * latencyStatistics->GetMaximumLatency( stage ) );
+  }
+
+  int wasModifying = tableNode->StartModify();
+  tableNode->RemoveAllColumns();
+  tableNode->AddColumn( stageArray );
+  tableNode->AddColumn( countArray );
+  tableNode->AddColumn( p50Array );
+  tableNode->AddColumn( p95Array );
+  tableNode->AddColumn( p99Array );
+  tableNode->AddColumn( maximumArray );
+  tableNode->EndModify( wasModifying );
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathReconstructionLogic::StartReplay( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkPathPoseStream* poses, double speedFactor )
+{
+  if ( pathReconstructionNode == NULL || poses == NULL )
+  {
+    vtkErrorMacro( "Path reconstruction node or poses are not set. Cannot start replay." );
+    return false;
+  }
+  if ( poses->GetNumberOfPoses() == 0 )
+  {
+    vtkWarningMacro( "There are no poses to replay." );
+    return false;
+  }
+  if ( speedFactor < 0.0 )
+  {
+    vtkErrorMacro( "Speed factor " << speedFactor << " is negative. Cannot start replay." );
+    return false;
+  }
+  if ( !this->BufferedRecording )
+  {
+    vtkErrorMacro( "Replay requires buffered recording. Cannot start replay." );
+    return false;
+  }
+  if ( !this->IsRecordingPossible( pathReconstructionNode ) )
+  {
+    vtkErrorMacro( "Parameters have not yet been set. Cannot start replay." );
+    return false;
+  }
+  if ( this->IsReplaying( pathReconstructionNode ) )
+  {
+    this->StopReplay( pathReconstructionNode );
+  }
+  if ( pathReconstructionNode->GetRecordingState() == vtkMRMLPathReconstructionNode::Recording )
+  {
+    vtkErrorMacro( "Path reconstruction node is recording. Stop recording before starting a replay." );
+    return false;
+  }
+
+  vtkInternal::Replay& replay = this->Internal->Replays[ pathReconstructionNode ];
+  replay.Poses = poses;
+  replay.SpeedFactor = speedFactor;
+  replay.WallStartTime = vtkTimerLog::GetUniversalTime();
+  replay.StreamStartTime = poses->GetPoseTimestamp( 0 );
+  replay.NextPoseIndex = 0;
+  replay.CurrentSegment = poses->GetPoseSegment( 0 );
+
+  if ( speedFactor == 0.0 )
+  {
+    this->AdvanceReplay( pathReconstructionNode, VTK_DOUBLE_MAX );
+    this->GenerateFullResolutionPaths( pathReconstructionNode );
+  }
+  this->InvokeEvent( PendingWorkEvent );
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::StopReplay( vtkMRMLPathReconstructionNode* pathReconstructionNode )
+{
+  if ( this->Internal->Replays.erase( pathReconstructionNode ) == 0 )
+  {
+    return;
+  }
+  if ( pathReconstructionNode->GetRecordingState() == vtkMRMLPathReconstructionNode::Recording )
+  {
+    this->StopRecording( pathReconstructionNode );
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathReconstructionLogic::IsReplaying( vtkMRMLPathReconstructionNode* pathReconstructionNode )
+{
+  return ( this->Internal->Replays.find( pathReconstructionNode ) != this->Internal->Replays.end() );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::AdvanceReplay( vtkMRMLPathReconstructionNode* pathReconstructionNode, double streamTimeLimit )
+{
+  std::map< vtkMRMLPathReconstructionNode*, vtkInternal::Replay >::iterator replayIterator = this->Internal->Replays.find( pathReconstructionNode );
+  if ( replayIterator == this->Internal->Replays.end() )
+  {
+    return;
+  }
+
+  // Each pose is applied to its sampling transform, so it goes through the same observer,
+  // sample buffer, decimation and fitting as a live sample
+  vtkInternal::Replay& replay = replayIterator->second;
+  vtkPathPoseStream* poses = replay.Poses;
+  vtkIdType numberOfPoses = poses->GetNumberOfPoses();
+  vtkSmartPointer< vtkMatrix4x4 > samplingToParentMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  vtkIdType numberOfPosesSkipped = 0;
+  while ( replay.NextPoseIndex < numberOfPoses && poses->GetPoseTimestamp( replay.NextPoseIndex ) <= streamTimeLimit )
+  {
+    vtkIdType poseIndex = replay.NextPoseIndex++;
+    int segment = poses->GetPoseSegment( poseIndex );
+    int channel = poses->GetPoseChannel( poseIndex );
+    this->Internal->ReplayingPose = true;
+    this->Internal->ReplayPoseTimestamp = poses->GetPoseTimestamp( poseIndex );
+
+    // a new segment is a new path
+    if ( pathReconstructionNode->GetRecordingState() != vtkMRMLPathReconstructionNode::Recording || segment != replay.CurrentSegment )
+    {
+      if ( pathReconstructionNode->GetRecordingState() == vtkMRMLPathReconstructionNode::Recording )
+      {
+        this->StopRecording( pathReconstructionNode );
+      }
+      this->StartRecording( pathReconstructionNode );
+      replay.CurrentSegment = segment;
+    }
+
+    vtkMRMLLinearTransformNode* samplingTransformNode = NULL;
+    if ( channel >= 0 && channel < pathReconstructionNode->GetNumberOfChannels() )
+    {
+      samplingTransformNode = vtkMRMLLinearTransformNode::SafeDownCast( pathReconstructionNode->GetChannelSamplingTransformNode( channel ) );
+    }
+    if ( samplingTransformNode == NULL )
+    {
+      numberOfPosesSkipped++;
+      continue;
+    }
+    poses->GetPoseMatrix( poseIndex, samplingToParentMatrix );
+    samplingTransformNode->SetMatrixTransformToParent( samplingToParentMatrix );
+  }
+  this->Internal->ReplayingPose = false;
+
+  if ( numberOfPosesSkipped > 0 )
+  {
+    vtkWarningMacro( numberOfPosesSkipped << " poses were not replayed, because their channel has no linear sampling transform." );
+  }
+
+  if ( replay.NextPoseIndex >= numberOfPoses )
+  {
+    this->Internal->Replays.erase( replayIterator );
+    if ( pathReconstructionNode->GetRecordingState() == vtkMRMLPathReconstructionNode::Recording )
+    {
+      this->StopRecording( pathReconstructionNode );
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::ProcessPendingSamples()
+{
+  // timed replays push the poses that are due
+  if ( !this->Internal->Replays.empty() )
+  {
+    double wallTime = vtkTimerLog::GetUniversalTime();
+    std::vector< std::pair< vtkMRMLPathReconstructionNode*, double > > dueReplays;
+    std::map< vtkMRMLPathReconstructionNode*, vtkInternal::Replay >::iterator replayIterator;
+    for ( replayIterator = this->Internal->Replays.begin(); replayIterator != this->Internal->Replays.end(); replayIterator++ )
+    {
+      const vtkInternal::Replay& replay = replayIterator->second;
+      double streamTimeLimit = replay.StreamStartTime + ( wallTime - replay.WallStartTime ) * replay.SpeedFactor;
+      dueReplays.push_back( std::make_pair( replayIterator->first, streamTimeLimit ) );
+    }
+    for ( size_t replayIndex = 0; replayIndex < dueReplays.size(); replayIndex++ )
+    {
+      this->AdvanceReplay( dueReplays[ replayIndex ].first, dueReplays[ replayIndex ].second );
+    }
+  }
+
+  vtkInternal::ActiveRecordingMap::iterator activeRecordingIterator;
+  for ( activeRecordingIterator = this->Internal->ActiveRecordings.begin(); activeRecordingIterator != this->Internal->ActiveRecordings.end(); activeRecordingIterator++ )
+  {
+    this->DrainChannelSampleBuffer( activeRecordingIterator->first.first, activeRecordingIterator->first.second );
+  }
+
+  if ( this->Internal->PendingFullResolutionPaths.empty() )
+  {
+    if ( this->Internal->ActiveRecordings.empty() && this->Internal->Replays.empty() )
+    {
+      // idle, one pair per call so that no call takes long
+      this->AddPooledModelNodesIfNeeded();
+    }
+    return;
+  }
+
+  std::vector< vtkInternal::PendingFullResolutionPath > pendingPaths;
+  pendingPaths.swap( this->Internal->PendingFullResolutionPaths );
+  for ( std::vector< vtkInternal::PendingFullResolutionPath >::iterator pendingPathIterator = pendingPaths.begin(); pendingPathIterator != pendingPaths.end(); pendingPathIterator++ )
+  {
+    this->GenerateFullResolutionPath( pendingPathIterator->PathReconstructionNode, pendingPathIterator->PointsModelNode, pendingPathIterator->PathModelNode );
+    this->AddLatency( pendingPathIterator->PathReconstructionNode, vtkPathLatencyStatistics::StageStopToFullResolutionPath,
+                      vtkTimerLog::GetUniversalTime() - pendingPathIterator->StopTime );
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathReconstructionLogic::HasPendingWork()
+{
+  if ( !this->Internal->Replays.empty() || !this->Internal->PendingFullResolutionPaths.empty() )
+  {
+    return true;
+  }
+  vtkInternal::ActiveRecordingMap::iterator activeRecordingIterator;
+  for ( activeRecordingIterator = this->Internal->ActiveRecordings.begin(); activeRecordingIterator != this->Internal->ActiveRecordings.end(); activeRecordingIterator++ )
+  {
+    if ( activeRecordingIterator->second.SampleBuffer != NULL )
+    {
+      return true;
+    }
+  }
+  // pooled pairs are only added when nothing is recorded
+  return ( this->Internal->ActiveRecordings.empty()
+    && this->Internal->NumberOfPathReconstructionNodes > 0
+    && (int)this->Internal->ModelNodePool.size() < this->ModelNodePoolSize );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::RefillModelNodePool()
+{
+  while ( this->AddPooledModelNodesIfNeeded() )
+  {
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathReconstructionLogic::AddPooledModelNodesIfNeeded()
+{
+  vtkMRMLScene* scene = this->GetMRMLScene();
+
+  // forget pairs whose nodes were removed from the scene
+  std::deque< vtkInternal::PooledModelNodes >::iterator pooledIterator = this->Internal->ModelNodePool.begin();
+  while ( pooledIterator != this->Internal->ModelNodePool.end() )
+  {
+    if ( pooledIterator->PointsModelNode == NULL || pooledIterator->PathModelNode == NULL
+      || pooledIterator->PointsModelNode->GetScene() != scene || pooledIterator->PathModelNode->GetScene() != scene )
+    {
+      pooledIterator = this->Internal->ModelNodePool.erase( pooledIterator );
+    }
+    else
+    {
+      pooledIterator++;
+    }
+  }
+  if ( (int)this->Internal->ModelNodePool.size() >= this->ModelNodePoolSize )
+  {
+    return false;
+  }
+
+  if ( scene == NULL || scene->IsBatchProcessing() || scene->IsClosing() || scene->IsImporting() || scene->IsRestoring() )
+  {
+    return false;
+  }
+  if ( this->Internal->NumberOfPathReconstructionNodes == 0 )
+  {
+    return false; // nothing will be recorded, keep the scene free of pooled nodes
+  }
+
+  vtkInternal::PooledModelNodes pooledModelNodes;
+  for ( int nodeIndex = 0; nodeIndex < 2; nodeIndex++ )
+  {
+    // the points are stored by the path reconstruction storage node, not by their own
+    vtkSmartPointer< vtkMRMLModelNode > modelNode;
+    if ( nodeIndex == 0 )
+    {
+      modelNode = vtkSmartPointer< vtkMRMLPathReconstructionPointsModelNode >::New();
+    }
+    else
+    {
+      modelNode = vtkSmartPointer< vtkMRMLModelNode >::New();
+    }
+    modelNode->SetHideFromEditors( true );
+    modelNode->SetSaveWithScene( false );
+    scene->AddNode( modelNode );
+    modelNode->CreateDefaultDisplayNodes();
+    vtkMRMLModelDisplayNode* displayNode = modelNode->GetModelDisplayNode();
+    if ( displayNode != NULL )
+    {
+      displayNode->SetVisibility( false );
+      displayNode->SetSaveWithScene( false );
+    }
+    if ( nodeIndex == 0 )
+    {
+      pooledModelNodes.PointsModelNode = modelNode;
+    }
+    else
+    {
+      pooledModelNodes.PathModelNode = modelNode;
+    }
+  }
+  this->Internal->ModelNodePool.push_back( pooledModelNodes );
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::RemovePooledModelNodes()
+{
+  std::deque< vtkInternal::PooledModelNodes > pooledModelNodes;
+  pooledModelNodes.swap( this->Internal->ModelNodePool );
+
+  // when the scene is closing it removes the nodes itself
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  if ( scene == NULL || scene->IsClosing() )
+  {
+    return;
+  }
+  for ( std::deque< vtkInternal::PooledModelNodes >::iterator pooledIterator = pooledModelNodes.begin(); pooledIterator != pooledModelNodes.end(); pooledIterator++ )
+  {
+    vtkMRMLModelNode* modelNodes[ 2 ] = { pooledIterator->PointsModelNode, pooledIterator->PathModelNode };
+    for ( int nodeIndex = 0; nodeIndex < 2; nodeIndex++ )
+    {
+      if ( modelNodes[ nodeIndex ] == NULL || modelNodes[ nodeIndex ]->GetScene() != scene )
+      {
+        continue;
+      }
+      vtkMRMLModelDisplayNode* displayNode = modelNodes[ nodeIndex ]->GetModelDisplayNode();
+      if ( displayNode != NULL )
+      {
+        scene->RemoveNode( displayNode );
+      }
+      scene->RemoveNode( modelNodes[ nodeIndex ] );
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathReconstructionLogic::TakePooledModelNodes( vtkSmartPointer< vtkMRMLModelNode >& pointsNode, vtkSmartPointer< vtkMRMLModelNode >& pathNode )
+{
+  while ( !this->Internal->ModelNodePool.empty() )
+  {
+    vtkInternal::PooledModelNodes pooledModelNodes = this->Internal->ModelNodePool.front();
+    this->Internal->ModelNodePool.pop_front();
+    if ( pooledModelNodes.PointsModelNode == NULL || pooledModelNodes.PathModelNode == NULL
+      || pooledModelNodes.PointsModelNode->GetScene() != this->GetMRMLScene() || pooledModelNodes.PathModelNode->GetScene() != this->GetMRMLScene() )
+    {
+      continue; // removed from the scene since it was pooled
+    }
+
+    pointsNode = pooledModelNodes.PointsModelNode.GetPointer();
+    pathNode = pooledModelNodes.PathModelNode.GetPointer();
+    vtkMRMLModelNode* modelNodes[ 2 ] = { pointsNode, pathNode };
+    for ( int nodeIndex = 0; nodeIndex < 2; nodeIndex++ )
+    {
+      modelNodes[ nodeIndex ]->SetHideFromEditors( false );
+      modelNodes[ nodeIndex ]->SetSaveWithScene( true );
+      vtkMRMLModelDisplayNode* displayNode = modelNodes[ nodeIndex ]->GetModelDisplayNode();
+      if ( displayNode != NULL )
+      {
+        displayNode->SetSaveWithScene( true );
+        displayNode->SetVisibility( true );
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::GenerateFullResolutionPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode )
+{
+  if ( pathReconstructionNode == NULL )
+  {
+    vtkErrorMacro( "Path reconstruction node is not set. Cannot generate full resolution paths." );
+    return;
+  }
+
+  std::vector< vtkInternal::PendingFullResolutionPath > pendingPaths;
+  pendingPaths.swap( this->Internal->PendingFullResolutionPaths );
+  for ( std::vector< vtkInternal::PendingFullResolutionPath >::iterator pendingPathIterator = pendingPaths.begin(); pendingPathIterator != pendingPaths.end(); pendingPathIterator++ )
+  {
+    if ( pendingPathIterator->PathReconstructionNode != pathReconstructionNode )
+    {
+      this->Internal->PendingFullResolutionPaths.push_back( *pendingPathIterator );
+      continue;
+    }
+    this->GenerateFullResolutionPath( pathReconstructionNode, pendingPathIterator->PointsModelNode, pendingPathIterator->PathModelNode );
+    this->AddLatency( pathReconstructionNode, vtkPathLatencyStatistics::StageStopToFullResolutionPath,
+                      vtkTimerLog::GetUniversalTime() - pendingPathIterator->StopTime );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::GenerateFullResolutionPath( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkMRMLModelNode* pointsNode, vtkMRMLModelNode* pathNode )
+{
+  if ( pathReconstructionNode == NULL || pointsNode == NULL || pathNode == NULL )
+  {
+    return; // nodes were deleted in the meantime
+  }
+
+  vtkMRMLMarkupsToModelNode* markupsToModelNode = pathReconstructionNode->GetMarkupsToModelNode();
+  if ( markupsToModelNode == NULL )
+  {
+    vtkWarningMacro( "Markups to model node is null. Cannot generate full resolution path." );
+    return;
+  }
+
+  if ( markupsToModelNode->GetModelType() == vtkMRMLMarkupsToModelNode::Curve )
+  {
+    // fit without touching the MarkupsToModel node, which may already be used by a new recording
+    vtkPolyData* pointsPolyData = pointsNode->GetPolyData();
+    vtkSmartPointer< vtkPathFitter > pathFitter = vtkSmartPointer< vtkPathFitter >::New();
+    pathFitter->SetParametersFromMarkupsToModelNode( markupsToModelNode );
+    vtkSmartPointer< vtkPolyData > pathPolyData = vtkSmartPointer< vtkPolyData >::New();
+    if ( pointsPolyData != NULL && pathFitter->Fit( pointsPolyData->GetPoints(), pathPolyData ) )
+    {
+      pathNode->SetAndObservePolyData( pathPolyData );
+      std::stringstream curveLengthStream;
+      curveLengthStream << pathFitter->GetOutputCurveLength();
+      pathNode->SetAttribute( vtkMRMLMarkupsToModelNode::GetOutputCurveLengthAttributeName(), curveLengthStream.str().c_str() );
+      StorePathFitFingerprint( markupsToModelNode, pointsNode, pathNode );
+    }
+    return;
+  }
+
+  // other model types can only be generated by MarkupsToModel, so point it at this path temporarily
+  std::string previousInputNodeID;
+  if ( markupsToModelNode->GetInputNode() != NULL && markupsToModelNode->GetInputNode()->GetID() != NULL )
+  {
+    previousInputNodeID = markupsToModelNode->GetInputNode()->GetID();
+  }
+  std::string previousOutputNodeID;
+  if ( markupsToModelNode->GetOutputModelNode() != NULL && markupsToModelNode->GetOutputModelNode()->GetID() != NULL )
+  {
+    previousOutputNodeID = markupsToModelNode->GetOutputModelNode()->GetID();
+  }
+  bool wasAutoUpdate = markupsToModelNode->GetAutoUpdateOutput();
+
+  markupsToModelNode->SetAutoUpdateOutput( false );
+  markupsToModelNode->SetAndObserveInputNodeID( pointsNode->GetID() );
+  markupsToModelNode->SetAndObserveOutputModelNodeID( pathNode->GetID() );
+  markupsToModelNode->SetAutoUpdateOutput( true );
+  markupsToModelNode->SetAutoUpdateOutput( false );
+  StorePathFitFingerprint( markupsToModelNode, pointsNode, pathNode );
+
+  markupsToModelNode->SetAndObserveInputNodeID( previousInputNodeID.empty() ? NULL : previousInputNodeID.c_str() );
+  markupsToModelNode->SetAndObserveOutputModelNodeID( previousOutputNodeID.empty() ? NULL : previousOutputNodeID.c_str() );
+  markupsToModelNode->SetAutoUpdateOutput( wasAutoUpdate );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::DrainSampleBuffer( vtkMRMLPathReconstructionNode* pathReconstructionNode )
+{
+  vtkInternal::ActiveRecordingMap::iterator activeRecordingIterator = this->Internal->FirstChannel( pathReconstructionNode );
+  for ( ; activeRecordingIterator != this->Internal->ActiveRecordings.end() && activeRecordingIterator->first.first == pathReconstructionNode; activeRecordingIterator++ )
+  {
+    this->DrainChannelSampleBuffer( pathReconstructionNode, activeRecordingIterator->first.second );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::DrainChannelSampleBuffer( vtkMRMLPathReconstructionNode* pathReconstructionNode, int channel )
+{
+  vtkInternal::ActiveRecordingMap::iterator activeRecordingIterator =
+    this->Internal->ActiveRecordings.find( vtkInternal::RecordingChannel( pathReconstructionNode, channel ) );
+  if ( activeRecordingIterator == this->Internal->ActiveRecordings.end() || activeRecordingIterator->second.SampleBuffer == NULL )
+  {
+    return;
+  }
+
+  vtkInternal::ActiveRecording& activeRecording = activeRecordingIterator->second;
+  vtkIdType numberOfSamples = activeRecording.SampleBuffer->GetNumberOfSamples();
+  if ( numberOfSamples <= 0 )
+  {
+    return;
+  }
+
+  vtkMRMLModelNode* pointsModelNode = activeRecording.PointsModelNode;
+  if ( pointsModelNode == NULL )
+  {
+    vtkWarningMacro( "Points model node no longer exists. Discarding " << numberOfSamples << " samples." );
+    activeRecording.SampleBuffer->Clear();
+    return;
+  }
+
+  std::vector< double > timestamps( numberOfSamples );
+  std::vector< double > positions( 3 * numberOfSamples );
+  std::vector< double > orientations( 4 * numberOfSamples );
+  std::vector< double > receivedTimes( numberOfSamples );
+  numberOfSamples = activeRecording.SampleBuffer->PopSamples( numberOfSamples, &timestamps[ 0 ], &positions[ 0 ], &orientations[ 0 ], &receivedTimes[ 0 ] );
+
+  vtkPolyData* pointsPolyData = pointsModelNode->GetPolyData();
+  if ( pointsPolyData == NULL )
+  {
+    vtkSmartPointer< vtkPolyData > newPointsPolyData = vtkSmartPointer< vtkPolyData >::New();
+    pointsModelNode->SetAndObservePolyData( newPointsPolyData );
+    pointsPolyData = newPointsPolyData;
+  }
+  if ( pointsPolyData->GetPoints() == NULL )
+  {
+    vtkSmartPointer< vtkPoints > newPoints = vtkSmartPointer< vtkPoints >::New();
+    pointsPolyData->SetPoints( newPoints );
+  }
+  if ( pointsPolyData->GetVerts() == NULL )
+  {
+    vtkSmartPointer< vtkCellArray > newVerts = vtkSmartPointer< vtkCellArray >::New();
+    pointsPolyData->SetVerts( newVerts );
+  }
+  vtkPoints* points = pointsPolyData->GetPoints();
+  vtkCellArray* verts = pointsPolyData->GetVerts();
+
+  // Timestamps and orientations are stored next to the points, as float arrays with one tuple per point.
+  // If the points were changed by something else in the meantime, the arrays are restarted.
+  vtkFloatArray* pointTimestamps = GetSampleArray( pointsPolyData, vtkMRMLPathReconstructionNode::GetPointTimestampArrayName(), 1 );
+  vtkFloatArray* pointOrientations = GetSampleArray( pointsPolyData, vtkMRMLPathReconstructionNode::GetPointOrientationArrayName(), 4 );
+  if ( pointTimestamps == NULL || pointOrientations == NULL )
+  {
+    vtkSmartPointer< vtkFloatArray > newTimestamps = vtkSmartPointer< vtkFloatArray >::New();
+    newTimestamps->SetName( vtkMRMLPathReconstructionNode::GetPointTimestampArrayName() );
+    newTimestamps->SetNumberOfComponents( 1 );
+    newTimestamps->SetNumberOfTuples( points->GetNumberOfPoints() );
+    newTimestamps->FillComponent( 0, 0.0 );
+    pointsPolyData->GetPointData()->AddArray( newTimestamps );
+    pointTimestamps = newTimestamps;
+
+    vtkSmartPointer< vtkFloatArray > newOrientations = vtkSmartPointer< vtkFloatArray >::New();
+    newOrientations->SetName( vtkMRMLPathReconstructionNode::GetPointOrientationArrayName() );
+    newOrientations->SetNumberOfComponents( 4 );
+    newOrientations->SetNumberOfTuples( points->GetNumberOfPoints() );
+    newOrientations->FillComponent( 0, 1.0 );
+    newOrientations->FillComponent( 1, 0.0 );
+    newOrientations->FillComponent( 2, 0.0 );
+    newOrientations->FillComponent( 3, 0.0 );
+    pointsPolyData->GetPointData()->AddArray( newOrientations );
+    pointOrientations = newOrientations;
+  }
+
+  // same rule as CollectPoints: skip samples that are too close to the previous point
+  double minimumDistance2 = activeRecording.MinimumDistance * activeRecording.MinimumDistance;
+  double previousPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+  bool hasPreviousPoint = ( points->GetNumberOfPoints() > 0 );
+  if ( hasPreviousPoint )
+  {
+    points->GetPoint( points->GetNumberOfPoints() - 1, previousPoint );
+  }
+
+  vtkIdType numberOfPointsAdded = 0;
+  std::vector< double > addedReceivedTimes;
+  for ( vtkIdType sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++ )
+  {
+    double* position = &positions[ 3 * sampleIndex ];
+    if ( activeRecording.Filter != NULL )
+    {
+      // filter in place, the decimator sees the filtered positions
+      if ( !activeRecording.Filter->FilterSample( timestamps[ sampleIndex ], position, position ) )
+      {
+        continue;
+      }
+    }
+    if ( activeRecording.Decimator != NULL )
+    {
+      if ( !activeRecording.Decimator->AcceptSample( timestamps[ sampleIndex ], position ) )
+      {
+        continue;
+      }
+    }
+    else if ( hasPreviousPoint && vtkMath::Distance2BetweenPoints( previousPoint, position ) < minimumDistance2 )
+    {
+      continue;
+    }
+    vtkIdType pointId = points->InsertNextPoint( position );
+    verts->InsertNextCell( 1, &pointId );
+    pointTimestamps->InsertNextValue( (float)( timestamps[ sampleIndex ] - activeRecording.StartTime ) );
+    const double* orientation = &orientations[ 4 * sampleIndex ];
+    pointOrientations->InsertNextTuple4( orientation[ 0 ], orientation[ 1 ], orientation[ 2 ], orientation[ 3 ] );
+    previousPoint[ 0 ] = position[ 0 ];
+    previousPoint[ 1 ] = position[ 1 ];
+    previousPoint[ 2 ] = position[ 2 ];
+    hasPreviousPoint = true;
+    numberOfPointsAdded++;
+    if ( this->LatencyMonitoring )
+    {
+      addedReceivedTimes.push_back( receivedTimes[ sampleIndex ] );
+    }
+  }
+
+  if ( numberOfPointsAdded > 0 )
+  {
+    // one modified event for the whole batch
+    points->Modified();
+    verts->Modified();
+    pointTimestamps->Modified();
+    pointOrientations->Modified();
+    double pointTime = vtkTimerLog::GetUniversalTime();
+    // the live path is refit by the observers of the modified event before it returns
+    pointsPolyData->Modified();
+    if ( this->LatencyMonitoring )
+    {
+      double pathTime = vtkTimerLog::GetUniversalTime();
+      for ( size_t addedIndex = 0; addedIndex < addedReceivedTimes.size(); addedIndex++ )
+      {
+        this->AddLatency( pathReconstructionNode, vtkPathLatencyStatistics::StageSampleToPoint, pointTime - addedReceivedTimes[ addedIndex ] );
+        this->AddLatency( pathReconstructionNode, vtkPathLatencyStatistics::StageSampleToPath, pathTime - addedReceivedTimes[ addedIndex ] );
+      }
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
-void vtkSlicerPathReconstructionLogic::RefitAllPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode )
+void vtkSlicerPathReconstructionLogic::RefitAllPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode, bool force )
 {
   if ( pathReconstructionNode == NULL )
   {
@@ -287,6 +1915,23 @@ void vtkSlicerPathReconstructionLogic::RefitAllPaths( vtkMRMLPathReconstructionN
     return;
   }
 
+  // every path is refit at full resolution below, so nothing needs to be generated later
+  std::vector< vtkInternal::PendingFullResolutionPath > pendingPaths;
+  pendingPaths.swap( this->Internal->PendingFullResolutionPaths );
+  for ( std::vector< vtkInternal::PendingFullResolutionPath >::iterator pendingPathIterator = pendingPaths.begin(); pendingPathIterator != pendingPaths.end(); pendingPathIterator++ )
+  {
+    if ( pendingPathIterator->PathReconstructionNode != pathReconstructionNode )
+    {
+      this->Internal->PendingFullResolutionPaths.push_back( *pendingPathIterator );
+    }
+  }
+
+  if ( this->ParallelRefit && markupsToModelNode->GetModelType() == vtkMRMLMarkupsToModelNode::Curve )
+  {
+    this->RefitAllPathsParallel( pathReconstructionNode, force );
+    return;
+  }
+
   bool wasAutoUpdate = markupsToModelNode->GetAutoUpdateOutput();
   markupsToModelNode->SetAutoUpdateOutput( false );
 
@@ -312,29 +1957,117 @@ void vtkSlicerPathReconstructionLogic::RefitAllPaths( vtkMRMLPathReconstructionN
       continue;
     }
 
-    vtkMRMLModelDisplayNode* pathDisplayNode = pathNode->GetModelDisplayNode();
-    if ( pathDisplayNode == NULL )
+    this->UpdatePathDisplayColor( pathReconstructionNode, pathNode );
+    if ( !force && IsPathFitUpToDate( markupsToModelNode, pointsNode, pathNode ) )
     {
-      pathNode->CreateDefaultDisplayNodes();
-      pathDisplayNode = pathNode->GetModelDisplayNode();
-    }
-    if ( pathDisplayNode != NULL )
-    {
-      double pathColorRed = pathReconstructionNode->GetPathColorRed();
-      double pathColorGreen = pathReconstructionNode->GetPathColorGreen();
-      double pathColorBlue = pathReconstructionNode->GetPathColorBlue();
-      pathDisplayNode->SetColor( pathColorRed, pathColorGreen, pathColorBlue );
-    }
-    else
-    {
-      vtkWarningMacro( "Unable to find or create display node for path node." );
+      continue;
     }
 
     markupsToModelNode->SetAndObserveInputNodeID( pointsNode->GetID() );
     markupsToModelNode->SetAndObserveOutputModelNodeID( pathNode->GetID() );
     markupsToModelNode->SetAutoUpdateOutput( true ); // TODO: This is a bit ugly, find another way to do this
     markupsToModelNode->SetAutoUpdateOutput( false );
+    StorePathFitFingerprint( markupsToModelNode, pointsNode, pathNode );
   }
 
   markupsToModelNode->SetAutoUpdateOutput( wasAutoUpdate );
 }
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::RefitAllPathsParallel( vtkMRMLPathReconstructionNode* pathReconstructionNode, bool force )
+{
+  vtkMRMLMarkupsToModelNode* markupsToModelNode = pathReconstructionNode->GetMarkupsToModelNode();
+
+  // Gather the inputs on the main thread. Workers only see points and their own fitter.
+  std::vector< vtkInternal::RefitJob > refitJobs;
+  vtkSmartPointer< vtkIntArray > suffixArray = vtkSmartPointer< vtkIntArray >::New();
+  pathReconstructionNode->GetSuffixes( suffixArray );
+  int numberOfSuffixes = suffixArray->GetNumberOfTuples();
+  for ( int suffixIndex = 0; suffixIndex < numberOfSuffixes; suffixIndex++ )
+  {
+    int suffix = suffixArray->GetComponent( suffixIndex, 0 );
+
+    vtkMRMLModelNode* pointsNode = pathReconstructionNode->GetPointsModelNodeBySuffix( suffix );
+    if ( pointsNode == NULL || pointsNode->GetPolyData() == NULL || pointsNode->GetPolyData()->GetPoints() == NULL )
+    {
+      continue;
+    }
+
+    vtkMRMLModelNode* pathNode = pathReconstructionNode->GetPathModelNodeBySuffix( suffix );
+    if ( pathNode == NULL )
+    {
+      continue;
+    }
+
+    this->UpdatePathDisplayColor( pathReconstructionNode, pathNode );
+    if ( !force && IsPathFitUpToDate( markupsToModelNode, pointsNode, pathNode ) )
+    {
+      continue;
+    }
+
+    vtkInternal::RefitJob refitJob;
+    refitJob.PointsModelNode = pointsNode;
+    refitJob.PathModelNode = pathNode;
+    refitJob.InputPoints = pointsNode->GetPolyData()->GetPoints();
+    refitJob.Fitter = vtkSmartPointer< vtkPathFitter >::New();
+    refitJob.Fitter->SetParametersFromMarkupsToModelNode( markupsToModelNode );
+    refitJob.OutputPolyData = vtkSmartPointer< vtkPolyData >::New();
+    refitJob.Succeeded = false;
+    refitJobs.push_back( refitJob );
+  }
+
+  if ( refitJobs.empty() )
+  {
+    return;
+  }
+
+  vtkInternal::RefitFunctor refitFunctor( refitJobs );
+  vtkSMPTools::For( 0, refitJobs.size(), 1, refitFunctor );
+
+  // Swap the results in on the main thread, so observers are notified once
+  vtkMRMLScene* scene = pathReconstructionNode->GetScene();
+  if ( scene != NULL )
+  {
+    scene->StartState( vtkMRMLScene::BatchProcessState );
+  }
+  for ( std::vector< vtkInternal::RefitJob >::iterator refitJobIterator = refitJobs.begin(); refitJobIterator != refitJobs.end(); refitJobIterator++ )
+  {
+    vtkMRMLModelNode* pointsNode = refitJobIterator->PointsModelNode;
+    vtkMRMLModelNode* pathNode = refitJobIterator->PathModelNode;
+    if ( pointsNode == NULL || pathNode == NULL || !refitJobIterator->Succeeded )
+    {
+      continue;
+    }
+    pathNode->SetAndObservePolyData( refitJobIterator->OutputPolyData );
+    std::stringstream curveLengthStream;
+    curveLengthStream << refitJobIterator->Fitter->GetOutputCurveLength();
+    pathNode->SetAttribute( vtkMRMLMarkupsToModelNode::GetOutputCurveLengthAttributeName(), curveLengthStream.str().c_str() );
+    StorePathFitFingerprint( markupsToModelNode, pointsNode, pathNode );
+  }
+  if ( scene != NULL )
+  {
+    scene->EndState( vtkMRMLScene::BatchProcessState );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathReconstructionLogic::UpdatePathDisplayColor( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkMRMLModelNode* pathNode )
+{
+  vtkMRMLModelDisplayNode* pathDisplayNode = pathNode->GetModelDisplayNode();
+  if ( pathDisplayNode == NULL )
+  {
+    pathNode->CreateDefaultDisplayNodes();
+    pathDisplayNode = pathNode->GetModelDisplayNode();
+  }
+  if ( pathDisplayNode != NULL )
+  {
+    double pathColorRed = pathReconstructionNode->GetPathColorRed();
+    double pathColorGreen = pathReconstructionNode->GetPathColorGreen();
+    double pathColorBlue = pathReconstructionNode->GetPathColorBlue();
+    pathDisplayNode->SetColor( pathColorRed, pathColorGreen, pathColorBlue );
+  }
+  else
+  {
+    vtkWarningMacro( "Unable to find or create display node for path node." );
+  }
+}
@@ -31,6 +31,12 @@ class vtkMRMLLinearTransformNode;
 class vtkMRMLMarkupsToModelNode;
 class vtkMRMLModelNode;
 class vtkMRMLPathReconstructionNode;
+class vtkMRMLTransformNode;
+class vtkIntArray;
+class vtkMRMLTableNode;
+class vtkPathLatencyStatistics;
+class vtkPathPoseStream;
+class vtkPathSampleDecimator;
 
 // STD includes
 #include <string>
@@ -49,10 +55,112 @@ public:
   vtkTypeMacro(vtkSlicerPathReconstructionLogic,vtkSlicerModuleLogic);
   void PrintSelf(ostream& os, vtkIndent indent);
 
+  enum Events
+  {
+    // PendingWorkEvent is invoked when ProcessPendingSamples may have work to do:
+    // recording or a replay started, recording stopped, or model nodes can be pooled
+    PendingWorkEvent = vtkCommand::UserEvent + 598
+  };
+
   bool IsRecordingPossible( vtkMRMLPathReconstructionNode* pathReconstructionNode );
   void ToggleRecording( vtkMRMLPathReconstructionNode* pathReconstructionNode );
   void DeleteLastPath( vtkMRMLPathReconstructionNode* pathReconstructionNode );
-  void RefitAllPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode );
+  // Delete the points and path models for each suffix in the array.
+  // All removals happen in one scene batch and one node modification, so observers are notified once.
+  void DeletePaths( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkIntArray* suffixes );
+  void DeleteAllPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode );
+  // Refit the path models from their points with the current MarkupsToModel parameters.
+  // Each path model remembers a fingerprint of its last fit (numbers of points and cells and a hash
+  // of the coordinates of the points and path data, and a hash of the fitting parameters),
+  // and paths that are up to date are skipped unless force is true, also after the scene is reloaded.
+  void RefitAllPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode, bool force = false );
+
+  // Remove the points near the ends of all paths. Points are projected onto the average direction
+  // of the paths, and only the range covered by every path, shortened by nearTrimDistance and
+  // farTrimDistance, is kept. Paths are not refit. Returns false if nothing could be trimmed.
+  bool TrimPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode, double nearTrimDistance, double farTrimDistance );
+
+  // When enabled, RefitAllPaths fits curves on worker threads (each path with its own fitter)
+  // and swaps the results into the path models in a single batch. Enabled by default.
+  vtkGetMacro( ParallelRefit, bool );
+  vtkSetMacro( ParallelRefit, bool );
+  vtkBooleanMacro( ParallelRefit, bool );
+
+  // When enabled, sampling transform poses are queued in a ring buffer while recording,
+  // and added to the points model in batches by ProcessPendingSamples. Each point then also
+  // gets its timestamp and orientation (see vtkMRMLPathReconstructionNode::GetPointTimestampArrayName).
+  // Otherwise CollectPoints adds each sample position as soon as the transform changes. Enabled by default.
+  vtkGetMacro( BufferedRecording, bool );
+  vtkSetMacro( BufferedRecording, bool );
+  vtkBooleanMacro( BufferedRecording, bool );
+
+  // Number of samples each buffered recording can hold initially. A full buffer grows
+  // rather than being drained in the transform observer, so samples are never dropped
+  // and a burst of transform updates never waits for points to be added or fitted. Default is 4096.
+  vtkGetMacro( SampleBufferCapacity, int );
+  vtkSetClampMacro( SampleBufferCapacity, int, 1, VTK_INT_MAX );
+
+  // When enabled, buffered recordings drop redundant samples (paused, or on straight segments)
+  // before they are added to the points model, see vtkPathSampleDecimator. Enabled by default.
+  // The numbers of kept and dropped samples are written to the points model attributes
+  // when recording stops (see vtkMRMLPathReconstructionNode::GetNumberOfKeptSamplesAttributeName).
+  vtkGetMacro( SampleDecimation, bool );
+  vtkSetMacro( SampleDecimation, bool );
+  vtkBooleanMacro( SampleDecimation, bool );
+
+  // Parameters of the sample decimation, copied to each recording when it starts.
+  // The CollectPoints minimum distance is used instead of MinimumDistance if it is larger.
+  vtkPathSampleDecimator* GetSampleDecimator();
+
+  // Add the samples queued by buffered recordings to their points models, and generate
+  // the full resolution paths that were queued when recording stopped.
+  // When nothing is recorded, it also adds one pair to the model node pool if it is not full.
+  // Must be called periodically from the main thread while HasPendingWork returns true
+  // (the module runs a timer from PendingWorkEvent until there is no more work).
+  void ProcessPendingSamples();
+
+  // True while there are buffered recordings or timed replays, queued full resolution paths,
+  // or model nodes missing from the pool
+  bool HasPendingWork();
+
+  // Number of hidden points/path model node pairs (with display nodes) kept in the scene,
+  // ready to be handed out when recording starts. Pooled nodes are not saved with the scene.
+  // The pool is only filled while the scene has a path reconstruction node, and emptied
+  // when the scene is closed or its last path reconstruction node is removed.
+  // 0 disables the pool. Default is 2.
+  vtkGetMacro( ModelNodePoolSize, int );
+  vtkSetClampMacro( ModelNodePoolSize, int, 0, VTK_INT_MAX );
+
+  // Add model node pairs until the pool is full, e.g. right after a scene is loaded
+  void RefillModelNodePool();
+
+  // When enabled, the latency of each stage of the recording pipeline is measured for every
+  // sample, per path reconstruction node (see vtkPathLatencyStatistics for the stages).
+  // Display updates happen in the views, after the last measured stage. Disabled by default.
+  vtkGetMacro( LatencyMonitoring, bool );
+  vtkSetMacro( LatencyMonitoring, bool );
+  vtkBooleanMacro( LatencyMonitoring, bool );
+
+  // Latencies measured for the node, NULL if none were measured yet
+  vtkPathLatencyStatistics* GetLatencyStatistics( vtkMRMLPathReconstructionNode* pathReconstructionNode );
+
+  // Write one row per stage (number of latencies, p50, p95, p99 and maximum in ms) to the table node.
+  // Returns false if no latencies were measured for the node.
+  bool WriteLatencyStatisticsToTableNode( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkMRMLTableNode* tableNode );
+
+  // Replay recorded sampling transform poses through the recording pipeline, as if they came from
+  // the tracker. Each segment of the stream is recorded as one path per channel, with the recorded
+  // timestamps. A speedFactor of 1 replays in real time, 2 twice as fast etc., advanced by
+  // ProcessPendingSamples. A speedFactor of 0 replays as fast as possible: the paths, including
+  // their full resolution fits, are complete when StartReplay returns. Requires buffered recording
+  // and linear sampling transforms. Returns false if the replay could not be started.
+  bool StartReplay( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkPathPoseStream* poses, double speedFactor );
+  void StopReplay( vtkMRMLPathReconstructionNode* pathReconstructionNode );
+  bool IsReplaying( vtkMRMLPathReconstructionNode* pathReconstructionNode );
+
+  // Replace the live (polyline or coarse tube) output of recently recorded paths
+  // by the full resolution path now, rather than waiting for ProcessPendingSamples.
+  void GenerateFullResolutionPaths( vtkMRMLPathReconstructionNode* pathReconstructionNode );
 
 protected:
   vtkSlicerPathReconstructionLogic();
@@ -64,10 +172,38 @@ protected:
   virtual void UpdateFromMRMLScene();
   virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* node);
   virtual void OnMRMLSceneNodeRemoved(vtkMRMLNode* node);
+  virtual void OnMRMLSceneEndImport();
+  virtual void OnMRMLSceneStartClose();
+  virtual void ProcessMRMLNodesEvents( vtkObject* caller, unsigned long event, void* callData );
 
 private:
   void StartRecording( vtkMRMLPathReconstructionNode* pathReconstructionNode );
+  void StartRecordingChannel( vtkMRMLPathReconstructionNode* pathReconstructionNode, int channel, vtkMRMLTransformNode* samplingTransformNode );
   void StopRecording( vtkMRMLPathReconstructionNode* pathReconstructionNode );
+  void UpdateIncrementalPath( vtkMRMLModelNode* pointsModelNode );
+  void PushSample( vtkMRMLTransformNode* samplingTransformNode );
+  double GetSampleTime(); // current time, or the timestamp of the pose being replayed
+  void AddLatency( vtkMRMLPathReconstructionNode* pathReconstructionNode, int stage, double latencySeconds );
+  void AdvanceReplay( vtkMRMLPathReconstructionNode* pathReconstructionNode, double streamTimeLimit );
+  void DrainSampleBuffer( vtkMRMLPathReconstructionNode* pathReconstructionNode ); // all channels
+  void DrainChannelSampleBuffer( vtkMRMLPathReconstructionNode* pathReconstructionNode, int channel );
+  void GenerateFullResolutionPath( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkMRMLModelNode* pointsNode, vtkMRMLModelNode* pathNode );
+  void RefitAllPathsParallel( vtkMRMLPathReconstructionNode* pathReconstructionNode, bool force );
+  void UpdatePathDisplayColor( vtkMRMLPathReconstructionNode* pathReconstructionNode, vtkMRMLModelNode* pathNode );
+  bool AddPooledModelNodesIfNeeded(); // adds at most one pair, returns false if the pool is full
+  void RemovePooledModelNodes();
+  bool TakePooledModelNodes( vtkSmartPointer< vtkMRMLModelNode >& pointsNode, vtkSmartPointer< vtkMRMLModelNode >& pathNode );
+
+  bool ParallelRefit;
+  bool BufferedRecording;
+  int SampleBufferCapacity;
+  bool SampleDecimation;
+  bool LatencyMonitoring;
+  int ModelNodePoolSize;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
   vtkSlicerPathReconstructionLogic( const vtkSlicerPathReconstructionLogic& ); // Not implemented
   void operator= ( const vtkSlicerPathReconstructionLogic& );             // Not implemented
 };
@@ -0,0 +1,1206 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkSlicerPathVerificationLogic.h"
+
+// MRML includes
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLPathReconstructionNode.h"
+#include "vtkMRMLPathReconstructionPointsModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSegmentationDisplayNode.h"
+#include "vtkMRMLSegmentationNode.h"
+#include "vtkMRMLTableNode.h"
+
+// SegmentationCore includes
+#include <vtkOrientedImageData.h>
+#include <vtkSegment.h>
+#include <vtkSegmentation.h>
+#include <vtkSegmentationConverter.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// vtk includes
+#include <vtkAbstractPointLocator.h>
+#include <vtkCellArray.h>
+#include <vtkCellLocator.h>
+#include <vtkCenterOfMass.h>
+#include <vtkDoubleArray.h>
+#include <vtkGenericCell.h>
+#include <vtkIntArray.h>
+#include <vtkKdTreePointLocator.h>
+#include <vtkLandmarkTransform.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+#include <vtkWeakPointer.h>
+
+vtkStandardNewMacro( vtkSlicerPathVerificationLogic );
+
+// percentiles reported in the summary table, in the same order as the columns
+static const int NUMBER_OF_PERCENTILES = 7;
+static const double PERCENTILES[ NUMBER_OF_PERCENTILES ] = { 0.0, 5.0, 25.0, 50.0, 75.0, 95.0, 100.0 };
+static const char* PERCENTILE_COLUMN_NAMES[ NUMBER_OF_PERCENTILES ] =
+  { "0th Percentile", "5th Percentile", "25th Percentile", "50th Percentile", "75th Percentile", "95th Percentile", "100th Percentile" };
+
+//------------------------------------------------------------------------------
+class vtkSlicerPathVerificationLogic::vtkInternal
+{
+public:
+  // Reference path, shared read-only by all worker threads
+  struct ReferencePath
+  {
+    int Suffix;
+    vtkSmartPointer< vtkPolyData > PolyData;
+    double CenterOfMass[ 3 ];
+    double Direction[ 3 ];
+  };
+
+  // One compare path. Inputs are set on the main thread, outputs by a worker thread.
+  struct ComparePath
+  {
+    int Suffix;
+    double Length;
+    int NumberOfInputPoints;
+    vtkSmartPointer< vtkPolyData > PolyData; // registered to the reference
+    double CenterOfMass[ 3 ]; // registered to the reference
+    double Direction[ 3 ]; // registered to the reference
+    int ReferencePathIndex; // into ReferenceIndex::Paths, -1 if there is no corresponding reference path
+
+    bool Succeeded;
+    std::vector< double > Distances;
+    double MeanDistance;
+    double StandardDeviationDistance;
+    double PercentileDistances[ NUMBER_OF_PERCENTILES ];
+    double AngleDifferenceDegrees;
+  };
+
+  // Reference paths of one node, with a k-d tree of their centers of mass for correspondence
+  // queries. It is kept between runs, and rebuilt when the signature of the node changes.
+  struct ReferenceIndex
+  {
+    vtkWeakPointer< vtkMRMLPathReconstructionNode > PathsNode;
+    std::vector< unsigned long long > Signature;
+    std::vector< ReferencePath > Paths;
+    vtkSmartPointer< vtkKdTreePointLocator > CenterOfMassLocator;
+
+    // surface points of all paths, built on the first FindClosestReferencePath
+    vtkSmartPointer< vtkKdTreePointLocator > SurfaceLocator;
+    std::vector< int > SurfacePointPathIndices;
+  };
+
+  ReferenceIndex Index;
+
+  // Make sure Index is up to date for the node. Returns false if the node has no usable paths.
+  bool UpdateReferenceIndex( vtkMRMLPathReconstructionNode* referencePathsNode );
+  void UpdateSurfaceLocator();
+
+  // Set ReferencePathIndex of each compare path
+  void AssignCorrespondences( std::vector< ComparePath >& comparePaths, int correspondenceMethod );
+
+  // Changes whenever a path is added or removed, or the data of a path changes
+  static void ComputeSignature( vtkMRMLPathReconstructionNode* pathsNode, std::vector< unsigned long long >& signature );
+
+  // Compare paths with a surface. Surfaces are only copied if copySurfaces is true.
+  static void GatherComparePaths( vtkMRMLPathReconstructionNode* comparePathsNode, vtkTransform* compareToReferenceTransform,
+                                  bool copySurfaces, std::vector< ComparePath >& comparePaths );
+
+  // Minimum cost assignment of rows to columns (Hungarian algorithm). costs is row major.
+  // Each row is assigned a different column, or -1 if there are more rows than columns.
+  static void SolveAssignment( const std::vector< double >& costs, int numberOfRows, int numberOfColumns, std::vector< int >& columnForRow );
+
+  // Copy the path surface so it can be read from several threads
+  static vtkSmartPointer< vtkPolyData > CopyForThreadedAccess( vtkPolyData* polyData );
+
+  // Center of mass, and direction from the first to the last point of the path.
+  // The cached descriptors of the node are used if the path has points, otherwise they are computed from the path surface.
+  static void GetCenterOfMassAndDirection( vtkMRMLPathReconstructionNode* pathsNode, int suffix, vtkPolyData* pathPolyData,
+                                           double centerOfMass[ 3 ], double direction[ 3 ] );
+
+  // Append the distance from each point of sourcePolyData to the surface of targetPolyData.
+  // The locator and cell belong to the calling thread.
+  static void AppendDistancesToSurface( vtkPolyData* sourcePolyData, vtkPolyData* targetPolyData, vtkCellLocator* targetLocator, vtkGenericCell* cell,
+                                        std::vector< double >& distances );
+
+  class ComparePathFunctor
+  {
+  public:
+    ComparePathFunctor( const std::vector< ReferencePath >& referencePaths, std::vector< ComparePath >& comparePaths )
+    : ReferencePaths( referencePaths )
+    , ComparePaths( comparePaths )
+    {
+    }
+    void operator()( vtkIdType beginPathIndex, vtkIdType endPathIndex )
+    {
+      // queries on a shared vtkCellLocator are not thread safe, so each thread has its own
+      vtkCellLocator* locator = this->Locators.Local();
+      vtkGenericCell* cell = this->Cells.Local();
+      for ( vtkIdType pathIndex = beginPathIndex; pathIndex < endPathIndex; pathIndex++ )
+      {
+        vtkInternal::ComputeComparePath( this->ReferencePaths, this->ComparePaths[ pathIndex ], locator, cell );
+      }
+    }
+  private:
+    const std::vector< ReferencePath >& ReferencePaths;
+    std::vector< ComparePath >& ComparePaths;
+    vtkSMPThreadLocalObject< vtkCellLocator > Locators;
+    vtkSMPThreadLocalObject< vtkGenericCell > Cells;
+  };
+
+  static void ComputeComparePath( const std::vector< ReferencePath >& referencePaths, ComparePath& comparePath,
+                                  vtkCellLocator* locator, vtkGenericCell* cell );
+
+  // One segment to be reduced to centerline points on a worker thread
+  struct SegmentCenterline
+  {
+    std::string SegmentName;
+    vtkSmartPointer< vtkOrientedImageData > Labelmap;
+    vtkSmartPointer< vtkPolyData > PointsPolyData;
+    bool Succeeded;
+  };
+
+  class SegmentCenterlineFunctor
+  {
+  public:
+    SegmentCenterlineFunctor( std::vector< SegmentCenterline >& segmentCenterlines, double sampleSpacing )
+    : SegmentCenterlines( segmentCenterlines )
+    , SampleSpacing( sampleSpacing )
+    {
+    }
+    void operator()( vtkIdType beginSegmentIndex, vtkIdType endSegmentIndex )
+    {
+      for ( vtkIdType segmentIndex = beginSegmentIndex; segmentIndex < endSegmentIndex; segmentIndex++ )
+      {
+        vtkInternal::ComputeSegmentCenterline( this->SegmentCenterlines[ segmentIndex ], this->SampleSpacing );
+      }
+    }
+  private:
+    std::vector< SegmentCenterline >& SegmentCenterlines;
+    double SampleSpacing;
+  };
+
+  static void ComputeSegmentCenterline( SegmentCenterline& segmentCenterline, double sampleSpacing );
+
+  // Closest target point of each source point (interleaved xyz), for ICP.
+  // The locator must support concurrent FindClosestPoint queries (e.g. vtkStaticPointLocator).
+  class ClosestPointFunctor
+  {
+  public:
+    ClosestPointFunctor( vtkAbstractPointLocator* targetLocator, vtkPolyData* targetPolyData, const std::vector< double >& sourcePoints,
+                         std::vector< double >& closestPoints, std::vector< double >& distances )
+    : TargetLocator( targetLocator )
+    , TargetPolyData( targetPolyData )
+    , SourcePoints( sourcePoints )
+    , ClosestPoints( closestPoints )
+    , Distances( distances )
+    {
+    }
+    void operator()( vtkIdType beginPointIndex, vtkIdType endPointIndex )
+    {
+      for ( vtkIdType pointIndex = beginPointIndex; pointIndex < endPointIndex; pointIndex++ )
+      {
+        const double* sourcePoint = &this->SourcePoints[ 3 * pointIndex ];
+        double* closestPoint = &this->ClosestPoints[ 3 * pointIndex ];
+        vtkIdType closestPointId = this->TargetLocator->FindClosestPoint( sourcePoint );
+        this->TargetPolyData->GetPoint( closestPointId, closestPoint );
+        this->Distances[ pointIndex ] = std::sqrt( vtkMath::Distance2BetweenPoints( sourcePoint, closestPoint ) );
+      }
+    }
+  private:
+    vtkAbstractPointLocator* TargetLocator;
+    vtkPolyData* TargetPolyData;
+    const std::vector< double >& SourcePoints;
+    std::vector< double >& ClosestPoints;
+    std::vector< double >& Distances;
+  };
+};
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::vtkInternal::ComputeSignature( vtkMRMLPathReconstructionNode* pathsNode, std::vector< unsigned long long >& signature )
+{
+  signature.clear();
+  vtkSmartPointer< vtkIntArray > suffixes = vtkSmartPointer< vtkIntArray >::New();
+  pathsNode->GetSuffixes( suffixes );
+  int numberOfSuffixes = suffixes->GetNumberOfTuples();
+  for ( int suffixIndex = 0; suffixIndex < numberOfSuffixes; suffixIndex++ )
+  {
+    int suffix = suffixes->GetValue( suffixIndex );
+    signature.push_back( (unsigned long long)suffix );
+
+    vtkMRMLModelNode* pathModelNode = pathsNode->GetPathModelNodeBySuffix( suffix );
+    vtkPolyData* pathPolyData = ( pathModelNode != NULL ) ? pathModelNode->GetPolyData() : NULL;
+    signature.push_back( (unsigned long long)reinterpret_cast< uintptr_t >( pathPolyData ) );
+    signature.push_back( ( pathPolyData != NULL ) ? (unsigned long long)pathPolyData->GetMTime() : 0 );
+
+    // the centers of mass and directions come from the points
+    vtkMRMLModelNode* pointsModelNode = pathsNode->GetPointsModelNodeBySuffix( suffix );
+    vtkPolyData* pointsPolyData = ( pointsModelNode != NULL ) ? pointsModelNode->GetPolyData() : NULL;
+    signature.push_back( (unsigned long long)reinterpret_cast< uintptr_t >( pointsPolyData ) );
+    signature.push_back( ( pointsPolyData != NULL ) ? (unsigned long long)pointsPolyData->GetMTime() : 0 );
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathVerificationLogic::vtkInternal::UpdateReferenceIndex( vtkMRMLPathReconstructionNode* referencePathsNode )
+{
+  std::vector< unsigned long long > signature;
+  vtkInternal::ComputeSignature( referencePathsNode, signature );
+  if ( this->Index.PathsNode == referencePathsNode && this->Index.Signature == signature )
+  {
+    return !this->Index.Paths.empty();
+  }
+
+  this->Index = ReferenceIndex();
+  this->Index.PathsNode = referencePathsNode;
+  this->Index.Signature = signature;
+
+  vtkSmartPointer< vtkIntArray > referenceSuffixes = vtkSmartPointer< vtkIntArray >::New();
+  referencePathsNode->GetSuffixes( referenceSuffixes );
+  int numberOfReferenceSuffixes = referenceSuffixes->GetNumberOfTuples();
+  vtkSmartPointer< vtkPoints > centersOfMass = vtkSmartPointer< vtkPoints >::New();
+  for ( int referenceSuffixIndex = 0; referenceSuffixIndex < numberOfReferenceSuffixes; referenceSuffixIndex++ )
+  {
+    int referenceSuffix = referenceSuffixes->GetValue( referenceSuffixIndex );
+    vtkMRMLModelNode* referencePathModelNode = referencePathsNode->GetPathModelNodeBySuffix( referenceSuffix );
+    if ( referencePathModelNode == NULL || referencePathModelNode->GetPolyData() == NULL ||
+         referencePathModelNode->GetPolyData()->GetNumberOfCells() == 0 )
+    {
+      vtkGenericWarningMacro( "Reference path " << referenceSuffix << " has no surface. It will not be used." );
+      continue;
+    }
+    ReferencePath referencePath;
+    referencePath.Suffix = referenceSuffix;
+    referencePath.PolyData = vtkInternal::CopyForThreadedAccess( referencePathModelNode->GetPolyData() );
+    vtkInternal::GetCenterOfMassAndDirection( referencePathsNode, referenceSuffix, referencePath.PolyData, referencePath.CenterOfMass, referencePath.Direction );
+    this->Index.Paths.push_back( referencePath );
+    centersOfMass->InsertNextPoint( referencePath.CenterOfMass );
+  }
+  if ( this->Index.Paths.empty() )
+  {
+    return false;
+  }
+
+  vtkSmartPointer< vtkPolyData > centersOfMassPolyData = vtkSmartPointer< vtkPolyData >::New();
+  centersOfMassPolyData->SetPoints( centersOfMass );
+  this->Index.CenterOfMassLocator = vtkSmartPointer< vtkKdTreePointLocator >::New();
+  this->Index.CenterOfMassLocator->SetDataSet( centersOfMassPolyData );
+  this->Index.CenterOfMassLocator->BuildLocator();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::vtkInternal::UpdateSurfaceLocator()
+{
+  if ( this->Index.SurfaceLocator != NULL )
+  {
+    return;
+  }
+
+  vtkSmartPointer< vtkPoints > surfacePoints = vtkSmartPointer< vtkPoints >::New();
+  this->Index.SurfacePointPathIndices.clear();
+  for ( int pathIndex = 0; pathIndex < (int)this->Index.Paths.size(); pathIndex++ )
+  {
+    vtkPoints* pathPoints = this->Index.Paths[ pathIndex ].PolyData->GetPoints();
+    vtkIdType numberOfPathPoints = pathPoints->GetNumberOfPoints();
+    for ( vtkIdType pointIndex = 0; pointIndex < numberOfPathPoints; pointIndex++ )
+    {
+      surfacePoints->InsertNextPoint( pathPoints->GetPoint( pointIndex ) );
+      this->Index.SurfacePointPathIndices.push_back( pathIndex );
+    }
+  }
+
+  vtkSmartPointer< vtkPolyData > surfacePolyData = vtkSmartPointer< vtkPolyData >::New();
+  surfacePolyData->SetPoints( surfacePoints );
+  this->Index.SurfaceLocator = vtkSmartPointer< vtkKdTreePointLocator >::New();
+  this->Index.SurfaceLocator->SetDataSet( surfacePolyData );
+  this->Index.SurfaceLocator->BuildLocator();
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::vtkInternal::AssignCorrespondences( std::vector< ComparePath >& comparePaths, int correspondenceMethod )
+{
+  int numberOfComparePaths = (int)comparePaths.size();
+  int numberOfReferencePaths = (int)this->Index.Paths.size();
+
+  if ( correspondenceMethod == CorrespondenceOneToOne )
+  {
+    std::vector< double > costs( numberOfComparePaths * numberOfReferencePaths, 0.0 );
+    for ( int compareIndex = 0; compareIndex < numberOfComparePaths; compareIndex++ )
+    {
+      for ( int referenceIndex = 0; referenceIndex < numberOfReferencePaths; referenceIndex++ )
+      {
+        costs[ compareIndex * numberOfReferencePaths + referenceIndex ] =
+          std::sqrt( vtkMath::Distance2BetweenPoints( comparePaths[ compareIndex ].CenterOfMass, this->Index.Paths[ referenceIndex ].CenterOfMass ) );
+      }
+    }
+    std::vector< int > referenceForCompare;
+    vtkInternal::SolveAssignment( costs, numberOfComparePaths, numberOfReferencePaths, referenceForCompare );
+    for ( int compareIndex = 0; compareIndex < numberOfComparePaths; compareIndex++ )
+    {
+      comparePaths[ compareIndex ].ReferencePathIndex = referenceForCompare[ compareIndex ];
+    }
+    return;
+  }
+
+  for ( std::vector< ComparePath >::iterator compareIterator = comparePaths.begin(); compareIterator != comparePaths.end(); compareIterator++ )
+  {
+    compareIterator->ReferencePathIndex = (int)this->Index.CenterOfMassLocator->FindClosestPoint( compareIterator->CenterOfMass );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::vtkInternal::SolveAssignment( const std::vector< double >& costs, int numberOfRows, int numberOfColumns, std::vector< int >& columnForRow )
+{
+  columnForRow.assign( numberOfRows, -1 );
+  if ( numberOfRows == 0 || numberOfColumns == 0 )
+  {
+    return;
+  }
+
+  // the algorithm below needs at least as many columns as rows
+  if ( numberOfRows > numberOfColumns )
+  {
+    std::vector< double > transposedCosts( costs.size(), 0.0 );
+    for ( int row = 0; row < numberOfRows; row++ )
+    {
+      for ( int column = 0; column < numberOfColumns; column++ )
+      {
+        transposedCosts[ column * numberOfRows + row ] = costs[ row * numberOfColumns + column ];
+      }
+    }
+    std::vector< int > rowForColumn;
+    vtkInternal::SolveAssignment( transposedCosts, numberOfColumns, numberOfRows, rowForColumn );
+    for ( int column = 0; column < numberOfColumns; column++ )
+    {
+      if ( rowForColumn[ column ] >= 0 )
+      {
+        columnForRow[ rowForColumn[ column ] ] = column;
+      }
+    }
+    return;
+  }
+
+  // Shortest augmenting path with row and column potentials, O( rows^2 * columns ).
+  // Rows and columns are numbered from 1, column 0 is a sentinel.
+  const double infinity = std::numeric_limits< double >::infinity();
+  std::vector< double > rowPotentials( numberOfRows + 1, 0.0 );
+  std::vector< double > columnPotentials( numberOfColumns + 1, 0.0 );
+  std::vector< int > rowOfColumn( numberOfColumns + 1, 0 );
+  std::vector< int > previousColumn( numberOfColumns + 1, 0 );
+  for ( int row = 1; row <= numberOfRows; row++ )
+  {
+    rowOfColumn[ 0 ] = row;
+    int column = 0;
+    std::vector< double > minimumSlack( numberOfColumns + 1, infinity );
+    std::vector< bool > columnUsed( numberOfColumns + 1, false );
+    do
+    {
+      columnUsed[ column ] = true;
+      int currentRow = rowOfColumn[ column ];
+      double delta = infinity;
+      int nextColumn = 0;
+      for ( int candidateColumn = 1; candidateColumn <= numberOfColumns; candidateColumn++ )
+      {
+        if ( columnUsed[ candidateColumn ] )
+        {
+          continue;
+        }
+        double slack = costs[ ( currentRow - 1 ) * numberOfColumns + ( candidateColumn - 1 ) ] - rowPotentials[ currentRow ] - columnPotentials[ candidateColumn ];
+        if ( slack < minimumSlack[ candidateColumn ] )
+        {
+          minimumSlack[ candidateColumn ] = slack;
+          previousColumn[ candidateColumn ] = column;
+        }
+        if ( minimumSlack[ candidateColumn ] < delta )
+        {
+          delta = minimumSlack[ candidateColumn ];
+          nextColumn = candidateColumn;
+        }
+      }
+      for ( int updateColumn = 0; updateColumn <= numberOfColumns; updateColumn++ )
+      {
+        if ( columnUsed[ updateColumn ] )
+        {
+          rowPotentials[ rowOfColumn[ updateColumn ] ] += delta;
+          columnPotentials[ updateColumn ] -= delta;
+        }
+        else
+        {
+          minimumSlack[ updateColumn ] -= delta;
+        }
+      }
+      column = nextColumn;
+    }
+    while ( rowOfColumn[ column ] != 0 );
+
+    // augment along the path
+    do
+    {
+      int nextColumn = previousColumn[ column ];
+      rowOfColumn[ column ] = rowOfColumn[ nextColumn ];
+      column = nextColumn;
+    }
+    while ( column != 0 );
+  }
+
+  for ( int column = 1; column <= numberOfColumns; column++ )
+  {
+    if ( rowOfColumn[ column ] != 0 )
+    {
+      columnForRow[ rowOfColumn[ column ] - 1 ] = column - 1;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::vtkInternal::GatherComparePaths( vtkMRMLPathReconstructionNode* comparePathsNode, vtkTransform* compareToReferenceTransform,
+                                                                      bool copySurfaces, std::vector< ComparePath >& comparePaths )
+{
+  comparePaths.clear();
+  vtkSmartPointer< vtkIntArray > compareSuffixes = vtkSmartPointer< vtkIntArray >::New();
+  comparePathsNode->GetSuffixes( compareSuffixes );
+  int numberOfCompareSuffixes = compareSuffixes->GetNumberOfTuples();
+  for ( int compareSuffixIndex = 0; compareSuffixIndex < numberOfCompareSuffixes; compareSuffixIndex++ )
+  {
+    int compareSuffix = compareSuffixes->GetValue( compareSuffixIndex );
+    vtkMRMLModelNode* comparePathModelNode = comparePathsNode->GetPathModelNodeBySuffix( compareSuffix );
+    if ( comparePathModelNode == NULL || comparePathModelNode->GetPolyData() == NULL ||
+         comparePathModelNode->GetPolyData()->GetNumberOfCells() == 0 )
+    {
+      vtkGenericWarningMacro( "Compare path " << compareSuffix << " has no surface. It will not be compared." );
+      continue;
+    }
+
+    ComparePath comparePath;
+    comparePath.Suffix = compareSuffix;
+    comparePath.ReferencePathIndex = -1;
+    comparePath.Succeeded = false;
+
+    if ( copySurfaces )
+    {
+      vtkSmartPointer< vtkTransformPolyDataFilter > compareToReferenceFilter = vtkSmartPointer< vtkTransformPolyDataFilter >::New();
+      compareToReferenceFilter->SetTransform( compareToReferenceTransform );
+      compareToReferenceFilter->SetInputData( comparePathModelNode->GetPolyData() );
+      compareToReferenceFilter->Update();
+      comparePath.PolyData = vtkInternal::CopyForThreadedAccess( compareToReferenceFilter->GetOutput() );
+    }
+
+    double unregisteredCenterOfMass[ 3 ] = { 0.0, 0.0, 0.0 };
+    double unregisteredDirection[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkInternal::GetCenterOfMassAndDirection( comparePathsNode, compareSuffix, comparePathModelNode->GetPolyData(), unregisteredCenterOfMass, unregisteredDirection );
+    compareToReferenceTransform->TransformPoint( unregisteredCenterOfMass, comparePath.CenterOfMass );
+    compareToReferenceTransform->TransformVector( unregisteredDirection, comparePath.Direction );
+
+    double arcLength = comparePathsNode->GetPathArcLength( compareSuffix );
+    comparePath.Length = ( arcLength >= 0.0 ) ? arcLength : vtkMath::Nan();
+    comparePath.NumberOfInputPoints = comparePathsNode->GetPathNumberOfPoints( compareSuffix );
+    comparePaths.push_back( comparePath );
+  }
+}
+
+//------------------------------------------------------------------------------
+vtkSmartPointer< vtkPolyData > vtkSlicerPathVerificationLogic::vtkInternal::CopyForThreadedAccess( vtkPolyData* polyData )
+{
+  vtkSmartPointer< vtkPolyData > polyDataCopy = vtkSmartPointer< vtkPolyData >::New();
+  polyDataCopy->DeepCopy( polyData );
+  // cells and bounds are otherwise built lazily on first access, which is not thread safe
+  polyDataCopy->BuildCells();
+  polyDataCopy->ComputeBounds();
+  return polyDataCopy;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::vtkInternal::GetCenterOfMassAndDirection( vtkMRMLPathReconstructionNode* pathsNode, int suffix, vtkPolyData* pathPolyData,
+                                                                                double centerOfMass[ 3 ], double direction[ 3 ] )
+{
+  double firstPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+  double lastPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+  if ( !pathsNode->GetPathCentroid( suffix, centerOfMass ) ||
+       !pathsNode->GetPathFirstPoint( suffix, firstPoint ) ||
+       !pathsNode->GetPathLastPoint( suffix, lastPoint ) )
+  {
+    vtkPoints* points = pathPolyData->GetPoints();
+    vtkCenterOfMass::ComputeCenterOfMass( points, NULL, centerOfMass );
+    points->GetPoint( 0, firstPoint );
+    points->GetPoint( points->GetNumberOfPoints() - 1, lastPoint );
+  }
+  vtkMath::Subtract( lastPoint, firstPoint, direction );
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::vtkInternal::AppendDistancesToSurface( vtkPolyData* sourcePolyData, vtkPolyData* targetPolyData, vtkCellLocator* targetLocator, vtkGenericCell* cell,
+                                                                             std::vector< double >& distances )
+{
+  targetLocator->SetDataSet( targetPolyData );
+  targetLocator->BuildLocator();
+
+  vtkIdType numberOfPoints = sourcePolyData->GetNumberOfPoints();
+  distances.reserve( distances.size() + numberOfPoints );
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    sourcePolyData->GetPoint( pointIndex, point );
+    double closestPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkIdType cellId = -1;
+    int subId = -1;
+    double distance2 = 0.0;
+    targetLocator->FindClosestPoint( point, closestPoint, cell, cellId, subId, distance2 );
+    distances.push_back( std::sqrt( distance2 ) );
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::vtkInternal::ComputeComparePath( const std::vector< ReferencePath >& referencePaths, ComparePath& comparePath,
+                                                                       vtkCellLocator* locator, vtkGenericCell* cell )
+{
+  comparePath.Succeeded = false;
+  if ( comparePath.ReferencePathIndex < 0 || comparePath.ReferencePathIndex >= (int)referencePaths.size() )
+  {
+    return;
+  }
+  const ReferencePath* correspondingReferencePath = &referencePaths[ comparePath.ReferencePathIndex ];
+
+  // distances both ways between the surfaces
+  comparePath.Distances.clear();
+  vtkInternal::AppendDistancesToSurface( comparePath.PolyData, correspondingReferencePath->PolyData, locator, cell, comparePath.Distances );
+  vtkInternal::AppendDistancesToSurface( correspondingReferencePath->PolyData, comparePath.PolyData, locator, cell, comparePath.Distances );
+  if ( comparePath.Distances.empty() )
+  {
+    return;
+  }
+
+  double numberOfDistances = (double)comparePath.Distances.size();
+  double sumOfDistances = 0.0;
+  double sumOfSquaredDistances = 0.0;
+  for ( std::vector< double >::const_iterator distanceIterator = comparePath.Distances.begin(); distanceIterator != comparePath.Distances.end(); distanceIterator++ )
+  {
+    sumOfDistances += *distanceIterator;
+    sumOfSquaredDistances += ( *distanceIterator ) * ( *distanceIterator );
+  }
+  comparePath.MeanDistance = sumOfDistances / numberOfDistances;
+  double variance = sumOfSquaredDistances / numberOfDistances - comparePath.MeanDistance * comparePath.MeanDistance;
+  comparePath.StandardDeviationDistance = std::sqrt( std::max( variance, 0.0 ) );
+
+  std::vector< double > sortedDistances = comparePath.Distances;
+  std::sort( sortedDistances.begin(), sortedDistances.end() );
+  for ( int percentileIndex = 0; percentileIndex < NUMBER_OF_PERCENTILES; percentileIndex++ )
+  {
+    // nearest rank
+    size_t rank = (size_t)vtkMath::Round( PERCENTILES[ percentileIndex ] / 100.0 * ( sortedDistances.size() - 1 ) );
+    comparePath.PercentileDistances[ percentileIndex ] = sortedDistances[ rank ];
+  }
+
+  comparePath.AngleDifferenceDegrees = vtkMath::DegreesFromRadians( vtkMath::AngleBetweenVectors( comparePath.Direction, correspondingReferencePath->Direction ) );
+
+  comparePath.Succeeded = true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::vtkInternal::ComputeSegmentCenterline( SegmentCenterline& segmentCenterline, double sampleSpacing )
+{
+  segmentCenterline.Succeeded = false;
+  vtkOrientedImageData* labelmap = segmentCenterline.Labelmap;
+  vtkDataArray* scalars = labelmap->GetPointData()->GetScalars();
+  if ( scalars == NULL )
+  {
+    return;
+  }
+
+  // world coordinates of the voxels inside the segment
+  vtkSmartPointer< vtkMatrix4x4 > imageToWorldMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  labelmap->GetImageToWorldMatrix( imageToWorldMatrix );
+  int extent[ 6 ] = { 0, -1, 0, -1, 0, -1 };
+  labelmap->GetExtent( extent );
+  std::vector< double > voxelPositions;
+  vtkIdType scalarIndex = 0;
+  for ( int k = extent[ 4 ]; k <= extent[ 5 ]; k++ )
+  {
+    for ( int j = extent[ 2 ]; j <= extent[ 3 ]; j++ )
+    {
+      for ( int i = extent[ 0 ]; i <= extent[ 1 ]; i++, scalarIndex++ )
+      {
+        if ( scalars->GetComponent( scalarIndex, 0 ) == 0.0 )
+        {
+          continue;
+        }
+        double voxelIJK[ 4 ] = { (double)i, (double)j, (double)k, 1.0 };
+        double voxelWorld[ 4 ] = { 0.0, 0.0, 0.0, 1.0 };
+        imageToWorldMatrix->MultiplyPoint( voxelIJK, voxelWorld );
+        voxelPositions.push_back( voxelWorld[ 0 ] );
+        voxelPositions.push_back( voxelWorld[ 1 ] );
+        voxelPositions.push_back( voxelWorld[ 2 ] );
+      }
+    }
+  }
+  vtkIdType numberOfVoxels = (vtkIdType)( voxelPositions.size() / 3 );
+  if ( numberOfVoxels == 0 )
+  {
+    return;
+  }
+
+  // principal axis of the voxels
+  double centroid[ 3 ] = { 0.0, 0.0, 0.0 };
+  for ( vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; voxelIndex++ )
+  {
+    vtkMath::Add( centroid, &voxelPositions[ 3 * voxelIndex ], centroid );
+  }
+  vtkMath::MultiplyScalar( centroid, 1.0 / numberOfVoxels );
+  double covariance[ 3 ][ 3 ] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  for ( vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; voxelIndex++ )
+  {
+    double offset[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkMath::Subtract( &voxelPositions[ 3 * voxelIndex ], centroid, offset );
+    for ( int row = 0; row < 3; row++ )
+    {
+      for ( int column = 0; column < 3; column++ )
+      {
+        covariance[ row ][ column ] += offset[ row ] * offset[ column ];
+      }
+    }
+  }
+  double eigenvalues[ 3 ] = { 0.0, 0.0, 0.0 };
+  double eigenvectors[ 3 ][ 3 ] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  double* covarianceRows[ 3 ] = { covariance[ 0 ], covariance[ 1 ], covariance[ 2 ] };
+  double* eigenvectorRows[ 3 ] = { eigenvectors[ 0 ], eigenvectors[ 1 ], eigenvectors[ 2 ] };
+  vtkMath::Jacobi( covarianceRows, eigenvalues, eigenvectorRows );
+  double axis[ 3 ] = { eigenvectors[ 0 ][ 0 ], eigenvectors[ 1 ][ 0 ], eigenvectors[ 2 ][ 0 ] }; // first column, largest eigenvalue
+
+  // bin the voxels along the axis, the mean position of each bin is a centerline point
+  std::vector< double > projections( numberOfVoxels );
+  double minimumProjection = std::numeric_limits< double >::infinity();
+  double maximumProjection = -std::numeric_limits< double >::infinity();
+  for ( vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; voxelIndex++ )
+  {
+    projections[ voxelIndex ] = vtkMath::Dot( &voxelPositions[ 3 * voxelIndex ], axis );
+    minimumProjection = std::min( minimumProjection, projections[ voxelIndex ] );
+    maximumProjection = std::max( maximumProjection, projections[ voxelIndex ] );
+  }
+  int numberOfBins = (int)std::floor( ( maximumProjection - minimumProjection ) / sampleSpacing ) + 1;
+  std::vector< double > binSums( 3 * numberOfBins, 0.0 );
+  std::vector< int > binCounts( numberOfBins, 0 );
+  for ( vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; voxelIndex++ )
+  {
+    int binIndex = std::min( (int)( ( projections[ voxelIndex ] - minimumProjection ) / sampleSpacing ), numberOfBins - 1 );
+    vtkMath::Add( &binSums[ 3 * binIndex ], &voxelPositions[ 3 * voxelIndex ], &binSums[ 3 * binIndex ] );
+    binCounts[ binIndex ]++;
+  }
+
+  vtkSmartPointer< vtkPoints > centerlinePoints = vtkSmartPointer< vtkPoints >::New();
+  vtkSmartPointer< vtkCellArray > centerlineVerts = vtkSmartPointer< vtkCellArray >::New();
+  for ( int binIndex = 0; binIndex < numberOfBins; binIndex++ )
+  {
+    if ( binCounts[ binIndex ] == 0 )
+    {
+      continue;
+    }
+    double binCenter[ 3 ] = { binSums[ 3 * binIndex + 0 ], binSums[ 3 * binIndex + 1 ], binSums[ 3 * binIndex + 2 ] };
+    vtkMath::MultiplyScalar( binCenter, 1.0 / binCounts[ binIndex ] );
+    vtkIdType pointId = centerlinePoints->InsertNextPoint( binCenter );
+    centerlineVerts->InsertNextCell( 1, &pointId );
+  }
+
+  segmentCenterline.PointsPolyData = vtkSmartPointer< vtkPolyData >::New();
+  segmentCenterline.PointsPolyData->SetPoints( centerlinePoints );
+  segmentCenterline.PointsPolyData->SetVerts( centerlineVerts );
+  segmentCenterline.Succeeded = true;
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerPathVerificationLogic::vtkSlicerPathVerificationLogic()
+{
+  this->CorrespondenceMethod = CorrespondenceNearestCentroid;
+  this->CenterlineSampleSpacing = 1.0;
+  this->MaximumNumberOfIterations = 50;
+  this->MaximumNumberOfLandmarks = 200;
+  this->ConvergenceTolerance = 0.001;
+  this->LastRegistrationNumberOfIterations = 0;
+  this->LastRegistrationMeanDistance = 0.0;
+  this->Internal = new vtkInternal();
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerPathVerificationLogic::~vtkSlicerPathVerificationLogic()
+{
+  delete this->Internal;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::PrintSelf( ostream& os, vtkIndent indent )
+{
+  this->Superclass::PrintSelf( os, indent );
+  os << indent << "CorrespondenceMethod: " << this->CorrespondenceMethod << std::endl;
+  os << indent << "NumberOfIndexedReferencePaths: " << this->Internal->Index.Paths.size() << std::endl;
+  os << indent << "CenterlineSampleSpacing: " << this->CenterlineSampleSpacing << std::endl;
+  os << indent << "MaximumNumberOfIterations: " << this->MaximumNumberOfIterations << std::endl;
+  os << indent << "MaximumNumberOfLandmarks: " << this->MaximumNumberOfLandmarks << std::endl;
+  os << indent << "ConvergenceTolerance: " << this->ConvergenceTolerance << std::endl;
+  os << indent << "LastRegistrationNumberOfIterations: " << this->LastRegistrationNumberOfIterations << std::endl;
+  os << indent << "LastRegistrationMeanDistance: " << this->LastRegistrationMeanDistance << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerPathVerificationLogic::ClearReferenceIndex()
+{
+  this->Internal->Index = vtkInternal::ReferenceIndex();
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathVerificationLogic::ComputeCorrespondences( vtkMRMLPathReconstructionNode* referencePathsNode, vtkMRMLPathReconstructionNode* comparePathsNode,
+                                                             vtkMRMLLinearTransformNode* compareToReferenceTransformNode, vtkIntArray* correspondingReferenceSuffixes )
+{
+  if ( referencePathsNode == NULL || comparePathsNode == NULL || correspondingReferenceSuffixes == NULL )
+  {
+    vtkErrorMacro( "A node or the output array is null. Cannot compute correspondences." );
+    return false;
+  }
+
+  if ( !this->Internal->UpdateReferenceIndex( referencePathsNode ) )
+  {
+    vtkErrorMacro( "There are no reference paths. Cannot compute correspondences." );
+    return false;
+  }
+
+  vtkSmartPointer< vtkTransform > compareToReferenceTransform = vtkSmartPointer< vtkTransform >::New();
+  if ( compareToReferenceTransformNode != NULL )
+  {
+    vtkSmartPointer< vtkMatrix4x4 > compareToReferenceMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+    compareToReferenceTransformNode->GetMatrixTransformToParent( compareToReferenceMatrix );
+    compareToReferenceTransform->SetMatrix( compareToReferenceMatrix );
+  }
+
+  std::vector< vtkInternal::ComparePath > comparePaths;
+  vtkInternal::GatherComparePaths( comparePathsNode, compareToReferenceTransform, false, comparePaths );
+  this->Internal->AssignCorrespondences( comparePaths, this->CorrespondenceMethod );
+
+  // one value per compare suffix, including paths that were skipped or not matched
+  vtkSmartPointer< vtkIntArray > compareSuffixes = vtkSmartPointer< vtkIntArray >::New();
+  comparePathsNode->GetSuffixes( compareSuffixes );
+  int numberOfCompareSuffixes = compareSuffixes->GetNumberOfTuples();
+  correspondingReferenceSuffixes->SetNumberOfComponents( 1 );
+  correspondingReferenceSuffixes->SetNumberOfTuples( numberOfCompareSuffixes );
+  std::vector< vtkInternal::ComparePath >::const_iterator compareIterator = comparePaths.begin();
+  for ( int compareSuffixIndex = 0; compareSuffixIndex < numberOfCompareSuffixes; compareSuffixIndex++ )
+  {
+    int referenceSuffix = -1;
+    if ( compareIterator != comparePaths.end() && compareIterator->Suffix == compareSuffixes->GetValue( compareSuffixIndex ) )
+    {
+      if ( compareIterator->ReferencePathIndex >= 0 )
+      {
+        referenceSuffix = this->Internal->Index.Paths[ compareIterator->ReferencePathIndex ].Suffix;
+      }
+      compareIterator++;
+    }
+    correspondingReferenceSuffixes->SetValue( compareSuffixIndex, referenceSuffix );
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerPathVerificationLogic::FindClosestReferencePath( vtkMRMLPathReconstructionNode* referencePathsNode, const double point[ 3 ] )
+{
+  if ( referencePathsNode == NULL )
+  {
+    vtkErrorMacro( "Reference paths node is null. Cannot find closest reference path." );
+    return -1;
+  }
+
+  if ( !this->Internal->UpdateReferenceIndex( referencePathsNode ) )
+  {
+    return -1;
+  }
+  this->Internal->UpdateSurfaceLocator();
+
+  vtkIdType closestPointIndex = this->Internal->Index.SurfaceLocator->FindClosestPoint( point );
+  if ( closestPointIndex < 0 || closestPointIndex >= (vtkIdType)this->Internal->Index.SurfacePointPathIndices.size() )
+  {
+    return -1;
+  }
+  int pathIndex = this->Internal->Index.SurfacePointPathIndices[ closestPointIndex ];
+  return this->Internal->Index.Paths[ pathIndex ].Suffix;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathVerificationLogic::ExtractPathsFromSegmentation( vtkMRMLSegmentationNode* segmentationNode, vtkMRMLPathReconstructionNode* pathsNode )
+{
+  if ( segmentationNode == NULL || segmentationNode->GetSegmentation() == NULL || pathsNode == NULL )
+  {
+    vtkErrorMacro( "A node is null. Cannot extract paths from segmentation." );
+    return false;
+  }
+
+  vtkMRMLScene* scene = pathsNode->GetScene();
+  if ( scene == NULL )
+  {
+    vtkErrorMacro( "Paths node is not in a scene. Cannot extract paths from segmentation." );
+    return false;
+  }
+
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  if ( !segmentation->CreateRepresentation( vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName() ) )
+  {
+    vtkErrorMacro( "Could not create the binary labelmap representation. Cannot extract paths from segmentation." );
+    return false;
+  }
+
+  // labelmaps are copied on the main thread, since the segmentation is not thread safe
+  vtkMRMLSegmentationDisplayNode* segmentationDisplayNode = vtkMRMLSegmentationDisplayNode::SafeDownCast( segmentationNode->GetDisplayNode() );
+  std::vector< std::string > segmentIDs;
+  segmentation->GetSegmentIDs( segmentIDs );
+  std::vector< vtkInternal::SegmentCenterline > segmentCenterlines;
+  for ( std::vector< std::string >::iterator segmentIDIterator = segmentIDs.begin(); segmentIDIterator != segmentIDs.end(); segmentIDIterator++ )
+  {
+    if ( segmentationDisplayNode != NULL && !segmentationDisplayNode->GetSegmentVisibility( *segmentIDIterator ) )
+    {
+      continue;
+    }
+    vtkInternal::SegmentCenterline segmentCenterline;
+    segmentCenterline.SegmentName = segmentation->GetSegment( *segmentIDIterator )->GetName();
+    segmentCenterline.Labelmap = vtkSmartPointer< vtkOrientedImageData >::New();
+    segmentCenterline.Succeeded = false;
+    if ( !segmentationNode->GetBinaryLabelmapRepresentation( *segmentIDIterator, segmentCenterline.Labelmap ) )
+    {
+      vtkWarningMacro( "Segment " << segmentCenterline.SegmentName << " has no binary labelmap. It will not be extracted." );
+      continue;
+    }
+    segmentCenterlines.push_back( segmentCenterline );
+  }
+
+  vtkInternal::SegmentCenterlineFunctor segmentCenterlineFunctor( segmentCenterlines, this->CenterlineSampleSpacing );
+  vtkSMPTools::For( 0, (vtkIdType)segmentCenterlines.size(), segmentCenterlineFunctor );
+
+  // add the points and path pairs in one batch
+  scene->StartState( vtkMRMLScene::BatchProcessState );
+  int wasModifying = pathsNode->StartModify();
+  int catheterIndex = 0;
+  for ( std::vector< vtkInternal::SegmentCenterline >::iterator segmentIterator = segmentCenterlines.begin(); segmentIterator != segmentCenterlines.end(); segmentIterator++ )
+  {
+    if ( !segmentIterator->Succeeded )
+    {
+      vtkWarningMacro( "Segment " << segmentIterator->SegmentName << " is empty. It will not be extracted." );
+      continue;
+    }
+
+    // the points are stored by the path reconstruction storage node, like recorded points
+    vtkSmartPointer< vtkMRMLPathReconstructionPointsModelNode > pointsNode = vtkSmartPointer< vtkMRMLPathReconstructionPointsModelNode >::New();
+    scene->AddNode( pointsNode );
+    std::stringstream pointsNameStream;
+    pointsNameStream << ( pathsNode->GetName() != NULL ? pathsNode->GetName() : "" ) << "_CatheterPoints" << catheterIndex;
+    pointsNode->SetName( pointsNameStream.str().c_str() );
+    pointsNode->SetAndObservePolyData( segmentIterator->PointsPolyData );
+    pointsNode->CreateDefaultDisplayNodes();
+
+    vtkSmartPointer< vtkMRMLModelNode > pathNode = vtkSmartPointer< vtkMRMLModelNode >::New();
+    scene->AddNode( pathNode );
+    std::stringstream pathNameStream;
+    pathNameStream << ( pathsNode->GetName() != NULL ? pathsNode->GetName() : "" ) << "_CatheterPath" << catheterIndex;
+    pathNode->SetName( pathNameStream.str().c_str() );
+    pathNode->CreateDefaultDisplayNodes();
+
+    pathsNode->AddPointsPathPairModelNodeIDs( pointsNode->GetID(), pathNode->GetID() );
+    catheterIndex++;
+  }
+  pathsNode->EndModify( wasModifying );
+  scene->EndState( vtkMRMLScene::BatchProcessState );
+
+  return ( catheterIndex > 0 );
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathVerificationLogic::ComputeRegistrationICP( vtkMRMLPathReconstructionNode* referencePathsNode, vtkMRMLPathReconstructionNode* comparePathsNode,
+                                                             vtkMRMLLinearTransformNode* compareToInitialTransformNode, vtkMRMLLinearTransformNode* initialToReferenceTransformNode )
+{
+  if ( referencePathsNode == NULL || comparePathsNode == NULL || initialToReferenceTransformNode == NULL )
+  {
+    vtkErrorMacro( "A node is null. Cannot compute registration." );
+    return false;
+  }
+
+  // cached on the reference node
+  vtkPolyData* referencePolyData = referencePathsNode->GetCombinedPathPolyData();
+  vtkAbstractPointLocator* referenceLocator = referencePathsNode->GetCombinedPathPointLocator();
+  if ( referencePolyData == NULL || referenceLocator == NULL )
+  {
+    vtkErrorMacro( "Reference paths have no points. Cannot compute registration." );
+    return false;
+  }
+
+  vtkPolyData* comparePolyData = comparePathsNode->GetCombinedPathPolyData();
+  if ( comparePolyData == NULL || comparePolyData->GetNumberOfPoints() < 3 )
+  {
+    vtkErrorMacro( "Compare paths have fewer than 3 points. Cannot compute registration." );
+    return false;
+  }
+
+  // landmarks are evenly spaced compare points, initially aligned
+  vtkSmartPointer< vtkMatrix4x4 > compareToInitialMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  if ( compareToInitialTransformNode != NULL )
+  {
+    compareToInitialTransformNode->GetMatrixTransformToParent( compareToInitialMatrix );
+  }
+  vtkSmartPointer< vtkTransform > compareToInitialTransform = vtkSmartPointer< vtkTransform >::New();
+  compareToInitialTransform->SetMatrix( compareToInitialMatrix );
+
+  vtkIdType numberOfComparePoints = comparePolyData->GetNumberOfPoints();
+  vtkIdType landmarkStep = 1;
+  if ( numberOfComparePoints > this->MaximumNumberOfLandmarks )
+  {
+    landmarkStep = numberOfComparePoints / this->MaximumNumberOfLandmarks;
+  }
+  vtkIdType numberOfLandmarks = numberOfComparePoints / landmarkStep;
+  std::vector< double > initialLandmarks( 3 * numberOfLandmarks );
+  for ( vtkIdType landmarkIndex = 0; landmarkIndex < numberOfLandmarks; landmarkIndex++ )
+  {
+    double comparePoint[ 3 ] = { 0.0, 0.0, 0.0 };
+    comparePolyData->GetPoint( landmarkIndex * landmarkStep, comparePoint );
+    compareToInitialTransform->TransformPoint( comparePoint, &initialLandmarks[ 3 * landmarkIndex ] );
+  }
+
+  std::vector< double > currentLandmarks = initialLandmarks;
+  std::vector< double > closestPoints( 3 * numberOfLandmarks );
+  std::vector< double > distances( numberOfLandmarks );
+  vtkSmartPointer< vtkPoints > sourceLandmarkPoints = vtkSmartPointer< vtkPoints >::New();
+  sourceLandmarkPoints->SetDataTypeToDouble();
+  sourceLandmarkPoints->SetNumberOfPoints( numberOfLandmarks );
+  vtkSmartPointer< vtkPoints > targetLandmarkPoints = vtkSmartPointer< vtkPoints >::New();
+  targetLandmarkPoints->SetDataTypeToDouble();
+  targetLandmarkPoints->SetNumberOfPoints( numberOfLandmarks );
+  vtkSmartPointer< vtkLandmarkTransform > landmarkTransform = vtkSmartPointer< vtkLandmarkTransform >::New();
+  landmarkTransform->SetModeToRigidBody();
+  landmarkTransform->SetSourceLandmarks( sourceLandmarkPoints );
+  landmarkTransform->SetTargetLandmarks( targetLandmarkPoints );
+
+  vtkSmartPointer< vtkTransform > initialToReferenceTransform = vtkSmartPointer< vtkTransform >::New();
+  initialToReferenceTransform->PostMultiply();
+
+  vtkInternal::ClosestPointFunctor closestPointFunctor( referenceLocator, referencePolyData, currentLandmarks, closestPoints, distances );
+  double previousMeanDistance = std::numeric_limits< double >::infinity();
+  double meanDistance = 0.0;
+  int iteration = 0;
+  for ( iteration = 0; iteration < this->MaximumNumberOfIterations; iteration++ )
+  {
+    vtkSMPTools::For( 0, numberOfLandmarks, closestPointFunctor );
+
+    double sumOfDistances = 0.0;
+    for ( vtkIdType landmarkIndex = 0; landmarkIndex < numberOfLandmarks; landmarkIndex++ )
+    {
+      sumOfDistances += distances[ landmarkIndex ];
+    }
+    meanDistance = sumOfDistances / numberOfLandmarks;
+    if ( previousMeanDistance - meanDistance < this->ConvergenceTolerance )
+    {
+      break;
+    }
+    previousMeanDistance = meanDistance;
+
+    std::copy( currentLandmarks.begin(), currentLandmarks.end(), static_cast< double* >( sourceLandmarkPoints->GetVoidPointer( 0 ) ) );
+    std::copy( closestPoints.begin(), closestPoints.end(), static_cast< double* >( targetLandmarkPoints->GetVoidPointer( 0 ) ) );
+    sourceLandmarkPoints->Modified();
+    targetLandmarkPoints->Modified();
+    landmarkTransform->Update();
+    initialToReferenceTransform->Concatenate( landmarkTransform->GetMatrix() );
+
+    // move the landmarks from their initial position, so errors do not accumulate
+    for ( vtkIdType landmarkIndex = 0; landmarkIndex < numberOfLandmarks; landmarkIndex++ )
+    {
+      initialToReferenceTransform->TransformPoint( &initialLandmarks[ 3 * landmarkIndex ], &currentLandmarks[ 3 * landmarkIndex ] );
+    }
+  }
+  this->LastRegistrationNumberOfIterations = iteration;
+  this->LastRegistrationMeanDistance = meanDistance;
+
+  vtkSmartPointer< vtkMatrix4x4 > initialToReferenceMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  initialToReferenceTransform->GetMatrix( initialToReferenceMatrix );
+  initialToReferenceTransformNode->SetMatrixTransformToParent( initialToReferenceMatrix );
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerPathVerificationLogic::ComputeStatistics( vtkMRMLPathReconstructionNode* referencePathsNode, vtkMRMLPathReconstructionNode* comparePathsNode,
+                                                        vtkMRMLLinearTransformNode* compareToReferenceTransformNode,
+                                                        vtkMRMLTableNode* outputDistancesTableNode, vtkMRMLTableNode* outputSummaryTableNode )
+{
+  if ( referencePathsNode == NULL || comparePathsNode == NULL || outputDistancesTableNode == NULL || outputSummaryTableNode == NULL )
+  {
+    vtkErrorMacro( "A node is null. Cannot compute statistics." );
+    return false;
+  }
+
+  // reference paths are only gathered again if they changed since the last run
+  if ( !this->Internal->UpdateReferenceIndex( referencePathsNode ) )
+  {
+    vtkErrorMacro( "There are no reference paths. Cannot compute statistics." );
+    return false;
+  }
+  const std::vector< vtkInternal::ReferencePath >& referencePaths = this->Internal->Index.Paths;
+
+  // gather compare paths, registered to the reference
+  vtkSmartPointer< vtkTransform > compareToReferenceTransform = vtkSmartPointer< vtkTransform >::New();
+  if ( compareToReferenceTransformNode != NULL )
+  {
+    vtkSmartPointer< vtkMatrix4x4 > compareToReferenceMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+    compareToReferenceTransformNode->GetMatrixTransformToParent( compareToReferenceMatrix );
+    compareToReferenceTransform->SetMatrix( compareToReferenceMatrix );
+  }
+
+  std::vector< vtkInternal::ComparePath > comparePaths;
+  vtkInternal::GatherComparePaths( comparePathsNode, compareToReferenceTransform, true, comparePaths );
+  this->Internal->AssignCorrespondences( comparePaths, this->CorrespondenceMethod );
+
+  // the expensive part: distances for each compare path
+  vtkInternal::ComparePathFunctor comparePathFunctor( referencePaths, comparePaths );
+  vtkSMPTools::For( 0, (vtkIdType)comparePaths.size(), comparePathFunctor );
+
+  // size the output arrays
+  vtkIdType numberOfSummaryRows = 0;
+  vtkIdType numberOfDistanceRows = 0;
+  for ( std::vector< vtkInternal::ComparePath >::const_iterator compareIterator = comparePaths.begin(); compareIterator != comparePaths.end(); compareIterator++ )
+  {
+    if ( !compareIterator->Succeeded )
+    {
+      vtkWarningMacro( "Could not compute statistics for compare path " << compareIterator->Suffix << "." );
+      continue;
+    }
+    numberOfSummaryRows++;
+    numberOfDistanceRows += (vtkIdType)compareIterator->Distances.size();
+  }
+
+  // raw distances
+  const char* comparePathsName = ( comparePathsNode->GetName() != NULL ) ? comparePathsNode->GetName() : "";
+  vtkSmartPointer< vtkStringArray > distancesLabelArray = vtkSmartPointer< vtkStringArray >::New();
+  distancesLabelArray->SetName( "Label" );
+  distancesLabelArray->SetNumberOfValues( numberOfDistanceRows );
+  vtkSmartPointer< vtkIntArray > distancesSuffixArray = vtkSmartPointer< vtkIntArray >::New();
+  distancesSuffixArray->SetName( "Suffix" );
+  distancesSuffixArray->SetNumberOfValues( numberOfDistanceRows );
+  vtkSmartPointer< vtkDoubleArray > distancesValueArray = vtkSmartPointer< vtkDoubleArray >::New();
+  distancesValueArray->SetName( "Distance" );
+  distancesValueArray->SetNumberOfValues( numberOfDistanceRows );
+
+  // summary statistics
+  vtkSmartPointer< vtkStringArray > summaryLabelArray = vtkSmartPointer< vtkStringArray >::New();
+  summaryLabelArray->SetName( "Label" );
+  summaryLabelArray->SetNumberOfValues( numberOfSummaryRows );
+  vtkSmartPointer< vtkIntArray > summarySuffixArray = vtkSmartPointer< vtkIntArray >::New();
+  summarySuffixArray->SetName( "Suffix" );
+  summarySuffixArray->SetNumberOfValues( numberOfSummaryRows );
+  vtkSmartPointer< vtkDoubleArray > summaryLengthArray = vtkSmartPointer< vtkDoubleArray >::New();
+  summaryLengthArray->SetName( "Length" );
+  summaryLengthArray->SetNumberOfValues( numberOfSummaryRows );
+  vtkSmartPointer< vtkIntArray > summaryInputPointCountArray = vtkSmartPointer< vtkIntArray >::New();
+  summaryInputPointCountArray->SetName( "Point Count" );
+  summaryInputPointCountArray->SetNumberOfValues( numberOfSummaryRows );
+  vtkSmartPointer< vtkIntArray > summaryDistanceCountArray = vtkSmartPointer< vtkIntArray >::New();
+  summaryDistanceCountArray->SetName( "Distance Count" );
+  summaryDistanceCountArray->SetNumberOfValues( numberOfSummaryRows );
+  vtkSmartPointer< vtkDoubleArray > summaryMeanArray = vtkSmartPointer< vtkDoubleArray >::New();
+  summaryMeanArray->SetName( "Mean" );
+  summaryMeanArray->SetNumberOfValues( numberOfSummaryRows );
+  vtkSmartPointer< vtkDoubleArray > summaryStdevArray = vtkSmartPointer< vtkDoubleArray >::New();
+  summaryStdevArray->SetName( "Stdev" );
+  summaryStdevArray->SetNumberOfValues( numberOfSummaryRows );
+  vtkSmartPointer< vtkDoubleArray > summaryPercentileArrays[ NUMBER_OF_PERCENTILES ];
+  for ( int percentileIndex = 0; percentileIndex < NUMBER_OF_PERCENTILES; percentileIndex++ )
+  {
+    summaryPercentileArrays[ percentileIndex ] = vtkSmartPointer< vtkDoubleArray >::New();
+    summaryPercentileArrays[ percentileIndex ]->SetName( PERCENTILE_COLUMN_NAMES[ percentileIndex ] );
+    summaryPercentileArrays[ percentileIndex ]->SetNumberOfValues( numberOfSummaryRows );
+  }
+  vtkSmartPointer< vtkDoubleArray > summaryAngleDifferenceArray = vtkSmartPointer< vtkDoubleArray >::New();
+  summaryAngleDifferenceArray->SetName( "Angle Difference (Degrees)" );
+  summaryAngleDifferenceArray->SetNumberOfValues( numberOfSummaryRows );
+  vtkSmartPointer< vtkIntArray > summaryReferenceSuffixArray = vtkSmartPointer< vtkIntArray >::New();
+  summaryReferenceSuffixArray->SetName( "Reference Suffix" );
+  summaryReferenceSuffixArray->SetNumberOfValues( numberOfSummaryRows );
+
+  vtkIdType summaryRow = 0;
+  vtkIdType distanceRow = 0;
+  for ( std::vector< vtkInternal::ComparePath >::const_iterator compareIterator = comparePaths.begin(); compareIterator != comparePaths.end(); compareIterator++ )
+  {
+    if ( !compareIterator->Succeeded )
+    {
+      continue;
+    }
+
+    vtkIdType numberOfDistances = (vtkIdType)compareIterator->Distances.size();
+    std::copy( compareIterator->Distances.begin(), compareIterator->Distances.end(), distancesValueArray->GetPointer( distanceRow ) );
+    std::fill( distancesSuffixArray->GetPointer( distanceRow ), distancesSuffixArray->GetPointer( distanceRow ) + numberOfDistances, compareIterator->Suffix );
+    for ( vtkIdType distanceIndex = 0; distanceIndex < numberOfDistances; distanceIndex++ )
+    {
+      distancesLabelArray->SetValue( distanceRow + distanceIndex, comparePathsName );
+    }
+    distanceRow += numberOfDistances;
+
+    summaryLabelArray->SetValue( summaryRow, comparePathsName );
+    summarySuffixArray->SetValue( summaryRow, compareIterator->Suffix );
+    summaryLengthArray->SetValue( summaryRow, compareIterator->Length );
+    summaryInputPointCountArray->SetValue( summaryRow, compareIterator->NumberOfInputPoints );
+    summaryDistanceCountArray->SetValue( summaryRow, numberOfDistances );
+    summaryMeanArray->SetValue( summaryRow, compareIterator->MeanDistance );
+    summaryStdevArray->SetValue( summaryRow, compareIterator->StandardDeviationDistance );
+    for ( int percentileIndex = 0; percentileIndex < NUMBER_OF_PERCENTILES; percentileIndex++ )
+    {
+      summaryPercentileArrays[ percentileIndex ]->SetValue( summaryRow, compareIterator->PercentileDistances[ percentileIndex ] );
+    }
+    summaryAngleDifferenceArray->SetValue( summaryRow, compareIterator->AngleDifferenceDegrees );
+    summaryReferenceSuffixArray->SetValue( summaryRow, referencePaths[ compareIterator->ReferencePathIndex ].Suffix );
+    summaryRow++;
+  }
+
+  // assign the arrays to the table nodes
+  int wasModifyingDistances = outputDistancesTableNode->StartModify();
+  outputDistancesTableNode->RemoveAllColumns();
+  outputDistancesTableNode->AddColumn( distancesLabelArray );
+  outputDistancesTableNode->AddColumn( distancesSuffixArray );
+  outputDistancesTableNode->AddColumn( distancesValueArray );
+  outputDistancesTableNode->EndModify( wasModifyingDistances );
+
+  int wasModifyingSummary = outputSummaryTableNode->StartModify();
+  outputSummaryTableNode->RemoveAllColumns();
+  outputSummaryTableNode->AddColumn( summaryLabelArray );
+  outputSummaryTableNode->AddColumn( summarySuffixArray );
+  outputSummaryTableNode->AddColumn( summaryLengthArray );
+  outputSummaryTableNode->AddColumn( summaryInputPointCountArray );
+  outputSummaryTableNode->AddColumn( summaryDistanceCountArray );
+  outputSummaryTableNode->AddColumn( summaryMeanArray );
+  outputSummaryTableNode->AddColumn( summaryStdevArray );
+  for ( int percentileIndex = 0; percentileIndex < NUMBER_OF_PERCENTILES; percentileIndex++ )
+  {
+    outputSummaryTableNode->AddColumn( summaryPercentileArrays[ percentileIndex ] );
+  }
+  outputSummaryTableNode->AddColumn( summaryAngleDifferenceArray );
+  outputSummaryTableNode->AddColumn( summaryReferenceSuffixArray );
+  outputSummaryTableNode->EndModify( wasModifyingSummary );
+
+  return true;
+}
@@ -0,0 +1,136 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSlicerPathVerificationLogic_h
+#define __vtkSlicerPathVerificationLogic_h
+
+// Slicer includes
+#include "vtkSlicerModuleLogic.h"
+
+class vtkIntArray;
+class vtkMRMLLinearTransformNode;
+class vtkMRMLPathReconstructionNode;
+class vtkMRMLSegmentationNode;
+class vtkMRMLTableNode;
+
+// includes related to PathReconstruction
+#include "vtkSlicerPathReconstructionModuleLogicExport.h"
+
+/// \ingroup Slicer_QtModules_PathReconstruction
+/// Computations of the PathVerification module that are too slow to do in Python.
+/// Paths are processed in parallel using vtkSMPTools.
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_LOGIC_EXPORT vtkSlicerPathVerificationLogic :
+  public vtkSlicerModuleLogic
+{
+public:
+  static vtkSlicerPathVerificationLogic *New();
+  vtkTypeMacro( vtkSlicerPathVerificationLogic, vtkSlicerModuleLogic );
+  void PrintSelf( ostream& os, vtkIndent indent );
+
+  enum CorrespondenceMethods
+  {
+    // each compare path corresponds to the reference path with the closest center of mass
+    CorrespondenceNearestCentroid = 0,
+    // each reference path corresponds to at most one compare path, and the sum of the
+    // center of mass distances is minimized (Hungarian algorithm)
+    CorrespondenceOneToOne,
+    CorrespondenceMethod_Last // valid types go above this line
+  };
+
+  // How compare paths are matched to reference paths. Default is CorrespondenceNearestCentroid.
+  vtkGetMacro( CorrespondenceMethod, int );
+  vtkSetClampMacro( CorrespondenceMethod, int, CorrespondenceNearestCentroid, CorrespondenceMethod_Last - 1 );
+  void SetCorrespondenceMethodToNearestCentroid() { this->SetCorrespondenceMethod( CorrespondenceNearestCentroid ); }
+  void SetCorrespondenceMethodToOneToOne() { this->SetCorrespondenceMethod( CorrespondenceOneToOne ); }
+
+  // Find the reference path corresponding to each path of comparePathsNode (registered by
+  // compareToReferenceTransformNode, which may be NULL). One suffix is written per compare path,
+  // in the order of vtkMRMLPathReconstructionNode::GetSuffixes, -1 if there is no corresponding path.
+  bool ComputeCorrespondences( vtkMRMLPathReconstructionNode* referencePathsNode, vtkMRMLPathReconstructionNode* comparePathsNode,
+                               vtkMRMLLinearTransformNode* compareToReferenceTransformNode, vtkIntArray* correspondingReferenceSuffixes );
+
+  // Suffix of the reference path with the surface closest to the point, -1 if there is none
+  int FindClosestReferencePath( vtkMRMLPathReconstructionNode* referencePathsNode, const double point[ 3 ] );
+
+  // Reference paths are indexed on first use, and the index is reused as long as the
+  // reference paths do not change. Clearing releases the memory used by the index.
+  void ClearReferenceIndex();
+
+  // Distance (mm) between consecutive centerline points extracted from segments. Default is 1.0.
+  vtkGetMacro( CenterlineSampleSpacing, double );
+  vtkSetClampMacro( CenterlineSampleSpacing, double, 0.001, VTK_DOUBLE_MAX );
+
+  // Add a points and path pair to pathsNode for each visible segment of segmentationNode.
+  // The points are samples of the segment centerline, computed from the binary labelmap:
+  // voxels are binned along their principal axis, and the center of each bin is one point.
+  // Segments are processed in parallel. Path models are left empty, to be fit afterwards.
+  // Returns false if no path could be extracted.
+  bool ExtractPathsFromSegmentation( vtkMRMLSegmentationNode* segmentationNode, vtkMRMLPathReconstructionNode* pathsNode );
+
+  // Parameters of ComputeRegistrationICP. At most MaximumNumberOfLandmarks compare points are
+  // matched per iteration. Iterations stop early once the mean distance between matched points
+  // improves by less than ConvergenceTolerance (mm). Defaults are 50, 200 and 0.001.
+  vtkGetMacro( MaximumNumberOfIterations, int );
+  vtkSetClampMacro( MaximumNumberOfIterations, int, 1, VTK_INT_MAX );
+  vtkGetMacro( MaximumNumberOfLandmarks, int );
+  vtkSetClampMacro( MaximumNumberOfLandmarks, int, 3, VTK_INT_MAX );
+  vtkGetMacro( ConvergenceTolerance, double );
+  vtkSetClampMacro( ConvergenceTolerance, double, 0.0, VTK_DOUBLE_MAX );
+
+  // Outcome of the last ComputeRegistrationICP
+  vtkGetMacro( LastRegistrationNumberOfIterations, int );
+  vtkGetMacro( LastRegistrationMeanDistance, double );
+
+  // Rigidly register the paths of comparePathsNode, after compareToInitialTransformNode (which may be NULL),
+  // to the paths of referencePathsNode using iterative closest points. The result is written to
+  // initialToReferenceTransformNode. The combined reference points and their locator are cached on
+  // referencePathsNode, so registering several compare sets to the same reference only builds them once.
+  // Closest points are found in parallel. Returns false if the registration could not be computed.
+  bool ComputeRegistrationICP( vtkMRMLPathReconstructionNode* referencePathsNode, vtkMRMLPathReconstructionNode* comparePathsNode,
+                               vtkMRMLLinearTransformNode* compareToInitialTransformNode, vtkMRMLLinearTransformNode* initialToReferenceTransformNode );
+
+  // Compare each path of comparePathsNode (registered by compareToReferenceTransformNode, which may be NULL)
+  // to its corresponding reference path (see CorrespondenceMethod). Distances are measured both ways between
+  // the path surfaces. The raw distances are written to the distances table (Label, Suffix, Distance),
+  // and one row per compare path is written to the summary table (length, point count, distance
+  // count, mean, standard deviation, percentiles, angle difference and reference suffix).
+  // Returns false if the statistics could not be computed.
+  bool ComputeStatistics( vtkMRMLPathReconstructionNode* referencePathsNode, vtkMRMLPathReconstructionNode* comparePathsNode,
+                          vtkMRMLLinearTransformNode* compareToReferenceTransformNode,
+                          vtkMRMLTableNode* outputDistancesTableNode, vtkMRMLTableNode* outputSummaryTableNode );
+
+protected:
+  vtkSlicerPathVerificationLogic();
+  virtual ~vtkSlicerPathVerificationLogic();
+
+private:
+  int CorrespondenceMethod;
+  double CenterlineSampleSpacing;
+  int MaximumNumberOfIterations;
+  int MaximumNumberOfLandmarks;
+  double ConvergenceTolerance;
+  int LastRegistrationNumberOfIterations;
+  double LastRegistrationMeanDistance;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+  vtkSlicerPathVerificationLogic( const vtkSlicerPathVerificationLogic& ); // Not implemented
+  void operator= ( const vtkSlicerPathVerificationLogic& );             // Not implemented
+};
+
+#endif
@@ -23,16 +23,31 @@
 #include "vtkMRMLLinearTransformNode.h"
 #include "vtkMRMLMarkupsToModelNode.h"
 #include "vtkMRMLModelNode.h"
+#include "vtkMRMLPathReconstructionStorageNode.h"
+
+// vtk includes
+#include <vtkMath.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkStaticPointLocator.h>
 
 // std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 
 // Constants ------------------------------------------------------------------
 static const char* COLLECT_POINTS_ROLE = "CollectPointsRole";
 static const char* MARKUPS_TO_MODEL_ROLE = "MarkupsToModelRole";
+static const char* CHANNEL_SAMPLING_TRANSFORM_ROLE = "ChannelSamplingTransformRole";
 static const char* POINTS_MODEL_ROLE_PREFIX = "PointsModelRole";
 static const char* PATH_MODEL_ROLE_PREFIX   = "PathModelRole";
 
+// suffixes are normally consecutive from 0, larger ones are indexed in a hash map
+static const int MAXIMUM_DIRECTLY_INDEXED_SUFFIX = 65535;
+
 vtkMRMLNodeNewMacro( vtkMRMLPathReconstructionNode );
 
 //------------------------------------------------------------------------------
@@ -46,11 +61,21 @@ vtkMRMLPathReconstructionNode::vtkMRMLPathReconstructionNode()
   this->AddNodeReferenceRole( COLLECT_POINTS_ROLE, NULL, observedCollectPointsEvents );
 
   this->AddNodeReferenceRole( MARKUPS_TO_MODEL_ROLE );
+  this->AddNodeReferenceRole( CHANNEL_SAMPLING_TRANSFORM_ROLE );
   this->ReferenceRoleSuffixes = std::set< int >();
   this->PointsBaseName = "Points";
   this->PathBaseName = "Path";
   this->NextCount = 1;
+  this->PointsPathRolesMigrated = true;
   this->RecordingState = Stopped;
+  this->LiveLevelOfDetail = LevelOfDetailCoarseTube;
+  this->FullResolutionOnStop = true;
+  this->SampleOutlierRejection = false;
+  this->OutlierWindowSize = 7;
+  this->OutlierThreshold = 3.0;
+  this->SampleSmoothing = false;
+  this->SmoothingProcessNoise = 10000.0;
+  this->SmoothingMeasurementNoise = 0.5;
   this->PointsColorRed = 1.0f;
   this->PointsColorGreen = 0.5f;
   this->PointsColorBlue = 0.5f;
@@ -68,10 +93,7 @@ vtkMRMLPathReconstructionNode::~vtkMRMLPathReconstructionNode()
 void vtkMRMLPathReconstructionNode::WriteXML( ostream& of, int nIndent )
 {
   // update reference roles if needed
-  if ( this->ArePointsPathRolesUsingBaseNameOnly() )
-  {
-    this->FixPointsPathRolesUsingBaseNameOnly();
-  }
+  this->MigratePointsPathRolesIfNeeded();
 
   Superclass::WriteXML( of, nIndent ); // This will take care of referenced nodes
 
@@ -79,6 +101,14 @@ void vtkMRMLPathReconstructionNode::WriteXML( ostream& of, int nIndent )
   of << indent << " PointsBaseName=\"" << this->PointsBaseName << "\"";
   of << indent << " PathBaseName=\"" << this->PathBaseName << "\"";
   of << indent << " NextCount=\"" << this->NextCount << "\"";
+  of << indent << " LiveLevelOfDetail=\"" << vtkMRMLPathReconstructionNode::LevelOfDetailAsString( this->LiveLevelOfDetail ) << "\"";
+  of << indent << " FullResolutionOnStop=\"" << ( this->FullResolutionOnStop ? "true" : "false" ) << "\"";
+  of << indent << " SampleOutlierRejection=\"" << ( this->SampleOutlierRejection ? "true" : "false" ) << "\"";
+  of << indent << " OutlierWindowSize=\"" << this->OutlierWindowSize << "\"";
+  of << indent << " OutlierThreshold=\"" << this->OutlierThreshold << "\"";
+  of << indent << " SampleSmoothing=\"" << ( this->SampleSmoothing ? "true" : "false" ) << "\"";
+  of << indent << " SmoothingProcessNoise=\"" << this->SmoothingProcessNoise << "\"";
+  of << indent << " SmoothingMeasurementNoise=\"" << this->SmoothingMeasurementNoise << "\"";
   of << indent << " ReferenceRoleSuffixes=\"";
   for ( std::set< int >::iterator suffixIterator = this->ReferenceRoleSuffixes.begin(); suffixIterator != this->ReferenceRoleSuffixes.end(); suffixIterator++ )
   { 
@@ -96,16 +126,18 @@ void vtkMRMLPathReconstructionNode::WriteXML( ostream& of, int nIndent )
 // ----------------------------------------------------------------------------
 void vtkMRMLPathReconstructionNode::PrintSelf( ostream& os, vtkIndent indent )
 {
-  // update reference roles if needed
-  if ( this->ArePointsPathRolesUsingBaseNameOnly() )
-  {
-    this->FixPointsPathRolesUsingBaseNameOnly();
-  }
-
   Superclass::PrintSelf( os, indent );
   os << indent << " PointsBaseName=\"" << this->PointsBaseName << "\"";
   os << indent << " PathBaseName=\"" << this->PathBaseName << "\"";
   os << indent << " NextCount=\"" << this->NextCount << "\"";
+  os << indent << " LiveLevelOfDetail=\"" << vtkMRMLPathReconstructionNode::LevelOfDetailAsString( this->LiveLevelOfDetail ) << "\"";
+  os << indent << " FullResolutionOnStop=\"" << ( this->FullResolutionOnStop ? "true" : "false" ) << "\"";
+  os << indent << " SampleOutlierRejection=\"" << ( this->SampleOutlierRejection ? "true" : "false" ) << "\"";
+  os << indent << " OutlierWindowSize=\"" << this->OutlierWindowSize << "\"";
+  os << indent << " OutlierThreshold=\"" << this->OutlierThreshold << "\"";
+  os << indent << " SampleSmoothing=\"" << ( this->SampleSmoothing ? "true" : "false" ) << "\"";
+  os << indent << " SmoothingProcessNoise=\"" << this->SmoothingProcessNoise << "\"";
+  os << indent << " SmoothingMeasurementNoise=\"" << this->SmoothingMeasurementNoise << "\"";
   os << indent << " ReferenceRoleSuffixes=\"";
   for ( std::set< int >::iterator suffixIterator = this->ReferenceRoleSuffixes.begin(); suffixIterator != this->ReferenceRoleSuffixes.end(); suffixIterator++ )
   { 
@@ -149,6 +181,58 @@ void vtkMRMLPathReconstructionNode::ReadXMLAttributes( const char** atts )
       ss >> this->NextCount;
       continue;
     }
+    else if ( ! strcmp( attName, "LiveLevelOfDetail" ) )
+    {
+      int levelOfDetail = vtkMRMLPathReconstructionNode::LevelOfDetailFromString( attValue );
+      if ( levelOfDetail >= 0 )
+      {
+        this->LiveLevelOfDetail = levelOfDetail;
+      }
+      continue;
+    }
+    else if ( ! strcmp( attName, "FullResolutionOnStop" ) )
+    {
+      this->FullResolutionOnStop = ( strcmp( attValue, "true" ) == 0 );
+      continue;
+    }
+    else if ( ! strcmp( attName, "SampleOutlierRejection" ) )
+    {
+      this->SampleOutlierRejection = ( strcmp( attValue, "true" ) == 0 );
+      continue;
+    }
+    else if ( ! strcmp( attName, "OutlierWindowSize" ) )
+    {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->OutlierWindowSize;
+      continue;
+    }
+    else if ( ! strcmp( attName, "OutlierThreshold" ) )
+    {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->OutlierThreshold;
+      continue;
+    }
+    else if ( ! strcmp( attName, "SampleSmoothing" ) )
+    {
+      this->SampleSmoothing = ( strcmp( attValue, "true" ) == 0 );
+      continue;
+    }
+    else if ( ! strcmp( attName, "SmoothingProcessNoise" ) )
+    {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->SmoothingProcessNoise;
+      continue;
+    }
+    else if ( ! strcmp( attName, "SmoothingMeasurementNoise" ) )
+    {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->SmoothingMeasurementNoise;
+      continue;
+    }
     else if ( ! strcmp( attName, "ReferenceRoleSuffixes" ) )
     {
       this->ReferenceRoleSuffixes.clear();
@@ -164,6 +248,9 @@ void vtkMRMLPathReconstructionNode::ReadXMLAttributes( const char** atts )
     // until it is manually started by user.
   }
 
+  // Files from older versions may use the legacy reference roles
+  this->PointsPathRolesMigrated = false;
+  this->RebuildPointsPathPairIndex();
   this->Modified();
 }
 
@@ -171,9 +258,53 @@ void vtkMRMLPathReconstructionNode::ReadXMLAttributes( const char** atts )
 void vtkMRMLPathReconstructionNode::Copy( vtkMRMLNode *anode )
 {  
   Superclass::Copy( anode ); // This will take care of referenced nodes
+  this->RebuildPointsPathPairIndex();
   this->Modified();
 }
 
+//------------------------------------------------------------------------------
+vtkMRMLStorageNode* vtkMRMLPathReconstructionNode::CreateDefaultStorageNode()
+{
+  return vtkMRMLPathReconstructionStorageNode::New();
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::UpdateReferences()
+{
+  Superclass::UpdateReferences();
+  // The scene has finished reading the nodes, so references can be resolved now
+  this->MigratePointsPathRoles();
+  this->RebuildPointsPathPairIndex();
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::UpdateReferenceID( const char* oldID, const char* newID )
+{
+  Superclass::UpdateReferenceID( oldID, newID );
+  this->RebuildPointsPathPairIndex();
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::OnNodeReferenceAdded( vtkMRMLNodeReference* reference )
+{
+  Superclass::OnNodeReferenceAdded( reference );
+  this->UpdateIndexFromReference( reference, false );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::OnNodeReferenceRemoved( vtkMRMLNodeReference* reference )
+{
+  Superclass::OnNodeReferenceRemoved( reference );
+  this->UpdateIndexFromReference( reference, true );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::OnNodeReferenceModified( vtkMRMLNodeReference* reference )
+{
+  Superclass::OnNodeReferenceModified( reference );
+  this->UpdateIndexFromReference( reference, false );
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLPathReconstructionNode::ProcessMRMLEvents( vtkObject* caller, unsigned long event, void* callData )
 {
@@ -218,6 +349,46 @@ vtkMRMLTransformNode* vtkMRMLPathReconstructionNode::GetAnchorTransformNode()
   return collectPointsNode->GetAnchorTransformNode();
 }
 
+//------------------------------------------------------------------------------
+int vtkMRMLPathReconstructionNode::GetNumberOfChannels()
+{
+  return 1 + this->GetNumberOfNodeReferences( CHANNEL_SAMPLING_TRANSFORM_ROLE );
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLTransformNode* vtkMRMLPathReconstructionNode::GetChannelSamplingTransformNode( int channel )
+{
+  if ( channel < 0 || channel >= this->GetNumberOfChannels() )
+  {
+    vtkErrorMacro( "Channel " << channel << " does not exist. Returning NULL." );
+    return NULL;
+  }
+  if ( channel == 0 )
+  {
+    return this->GetSamplingTransformNode();
+  }
+  return vtkMRMLTransformNode::SafeDownCast( this->GetNthNodeReference( CHANNEL_SAMPLING_TRANSFORM_ROLE, channel - 1 ) );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::AddChannelSamplingTransformNodeID( const char* nodeID )
+{
+  if ( nodeID == NULL )
+  {
+    vtkErrorMacro( "Node ID is null. Cannot add channel." );
+    return;
+  }
+  this->AddNodeReferenceID( CHANNEL_SAMPLING_TRANSFORM_ROLE, nodeID );
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::RemoveAllChannelSamplingTransformNodes()
+{
+  this->RemoveNodeReferenceIDs( CHANNEL_SAMPLING_TRANSFORM_ROLE );
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLPathReconstructionNode::SetRecordingState( int newState )
 {
@@ -225,6 +396,87 @@ void vtkMRMLPathReconstructionNode::SetRecordingState( int newState )
   this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
 }
 
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::SetLiveLevelOfDetail( int newLevelOfDetail )
+{
+  if ( newLevelOfDetail < 0 || newLevelOfDetail >= LevelOfDetail_Last )
+  {
+    vtkErrorMacro( "Unknown level of detail " << newLevelOfDetail << ". Level of detail not changed." );
+    return;
+  }
+  this->LiveLevelOfDetail = newLevelOfDetail;
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::SetFullResolutionOnStop( bool newFullResolutionOnStop )
+{
+  this->FullResolutionOnStop = newFullResolutionOnStop;
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::SetSampleOutlierRejection( bool newSampleOutlierRejection )
+{
+  this->SampleOutlierRejection = newSampleOutlierRejection;
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::SetOutlierWindowSize( int newOutlierWindowSize )
+{
+  if ( newOutlierWindowSize < 3 || newOutlierWindowSize > 101 )
+  {
+    vtkErrorMacro( "Outlier window size must be between 3 and 101. Outlier window size not changed." );
+    return;
+  }
+  this->OutlierWindowSize = newOutlierWindowSize;
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::SetOutlierThreshold( double newOutlierThreshold )
+{
+  if ( newOutlierThreshold <= 0.0 )
+  {
+    vtkErrorMacro( "Outlier threshold must be positive. Outlier threshold not changed." );
+    return;
+  }
+  this->OutlierThreshold = newOutlierThreshold;
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::SetSampleSmoothing( bool newSampleSmoothing )
+{
+  this->SampleSmoothing = newSampleSmoothing;
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::SetSmoothingProcessNoise( double newSmoothingProcessNoise )
+{
+  if ( newSmoothingProcessNoise < 0.0 )
+  {
+    vtkErrorMacro( "Smoothing process noise cannot be negative. Smoothing process noise not changed." );
+    return;
+  }
+  this->SmoothingProcessNoise = newSmoothingProcessNoise;
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::SetSmoothingMeasurementNoise( double newSmoothingMeasurementNoise )
+{
+  if ( newSmoothingMeasurementNoise < 0.0 )
+  {
+    vtkErrorMacro( "Smoothing measurement noise cannot be negative. Smoothing measurement noise not changed." );
+    return;
+  }
+  this->SmoothingMeasurementNoise = newSmoothingMeasurementNoise;
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::InputDataModifiedEvent );
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLPathReconstructionNode::SetNextCount( int newCount )
 {
@@ -352,38 +604,92 @@ void vtkMRMLPathReconstructionNode::SetAndObserveMarkupsToModelNodeID( const cha
 vtkMRMLModelNode* vtkMRMLPathReconstructionNode::GetPointsModelNodeBySuffix( int suffix )
 {
   // update reference roles if needed
-  if ( this->ArePointsPathRolesUsingBaseNameOnly() )
+  this->MigratePointsPathRolesIfNeeded();
+
+  IndexedPointsPathPair* indexedPair = this->FindIndexedPointsPathPair( suffix );
+  if ( indexedPair == NULL )
   {
-    this->FixPointsPathRolesUsingBaseNameOnly();
+    return NULL;
   }
+  return this->GetIndexedModelNode( indexedPair->Points );
+}
 
-  std::string referenceRole = this->GetNodeReferenceRole( POINTS_MODEL_ROLE_PREFIX, suffix );
-  vtkMRMLModelNode* node = vtkMRMLModelNode::SafeDownCast( this->GetNodeReference( referenceRole.c_str() ) );
-  return node;
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::ReadPackedPoints()
+{
+  vtkMRMLPathReconstructionStorageNode* storageNode = vtkMRMLPathReconstructionStorageNode::SafeDownCast( this->GetStorageNode() );
+  if ( storageNode == NULL )
+  {
+    return;
+  }
+
+  for ( std::set< int >::iterator suffixIterator = this->ReferenceRoleSuffixes.begin(); suffixIterator != this->ReferenceRoleSuffixes.end(); suffixIterator++ )
+  {
+    // points models loaded from a scene have no data until their points are read from the packed file
+    vtkMRMLModelNode* pointsNode = this->GetPointsModelNodeBySuffix( *suffixIterator );
+    if ( pointsNode == NULL || pointsNode->GetPolyData() != NULL || !storageNode->HasPackedPoints( *suffixIterator ) )
+    {
+      continue;
+    }
+    vtkSmartPointer< vtkPolyData > pointsPolyData = vtkSmartPointer< vtkPolyData >::New();
+    if ( storageNode->ReadPackedPoints( *suffixIterator, pointsPolyData ) )
+    {
+      pointsNode->SetAndObservePolyData( pointsPolyData );
+      // points read after the storage node's ReadData are not modifications
+      this->FindIndexedPointsPathPair( *suffixIterator )->PointsReadMTime = pointsPolyData->GetMTime();
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
-vtkMRMLModelNode* vtkMRMLPathReconstructionNode::GetPathModelNodeBySuffix( int suffix )
+bool vtkMRMLPathReconstructionNode::GetModifiedSinceRead()
 {
-  // update reference roles if needed
-  if ( this->ArePointsPathRolesUsingBaseNameOnly() )
+  if ( this->Superclass::GetModifiedSinceRead() )
   {
-    this->FixPointsPathRolesUsingBaseNameOnly();
+    return true;
+  }
+  vtkMRMLStorageNode* storageNode = this->GetStorageNode();
+  if ( storageNode == NULL )
+  {
+    return false;
   }
 
-  std::string referenceRole = this->GetNodeReferenceRole( PATH_MODEL_ROLE_PREFIX, suffix );
-  vtkMRMLModelNode* node = vtkMRMLModelNode::SafeDownCast( this->GetNodeReference( referenceRole.c_str() ) );
-  return node;
+  // the points models are stored by this node's storage node, not by their own
+  for ( std::set< int >::iterator suffixIterator = this->ReferenceRoleSuffixes.begin(); suffixIterator != this->ReferenceRoleSuffixes.end(); suffixIterator++ )
+  {
+    vtkMRMLModelNode* pointsNode = this->GetPointsModelNodeBySuffix( *suffixIterator );
+    if ( pointsNode == NULL || pointsNode->GetPolyData() == NULL )
+    {
+      continue;
+    }
+    vtkMTimeType unmodifiedMTime = std::max( (vtkMTimeType)storageNode->GetStoredTime(), this->FindIndexedPointsPathPair( *suffixIterator )->PointsReadMTime );
+    if ( pointsNode->GetPolyData()->GetMTime() > unmodifiedMTime )
+    {
+      return true;
+    }
+  }
+  return false;
 }
 
 //------------------------------------------------------------------------------
-int vtkMRMLPathReconstructionNode::GetNumberOfPathPointsPairs()
+vtkMRMLModelNode* vtkMRMLPathReconstructionNode::GetPathModelNodeBySuffix( int suffix )
 {
   // update reference roles if needed
-  if ( this->ArePointsPathRolesUsingBaseNameOnly() )
+  this->MigratePointsPathRolesIfNeeded();
+
+  IndexedPointsPathPair* indexedPair = this->FindIndexedPointsPathPair( suffix );
+  if ( indexedPair == NULL )
   {
-    this->FixPointsPathRolesUsingBaseNameOnly();
+    return NULL;
   }
+  return this->GetIndexedModelNode( indexedPair->Path );
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLPathReconstructionNode::GetNumberOfPathPointsPairs()
+{
+  // update reference roles if needed
+  this->MigratePointsPathRolesIfNeeded();
 
   return this->ReferenceRoleSuffixes.size();
 }
@@ -392,10 +698,7 @@ int vtkMRMLPathReconstructionNode::GetNumberOfPathPointsPairs()
 void vtkMRMLPathReconstructionNode::GetSuffixes( vtkIntArray* suffixesArray )
 {
   // update reference roles if needed
-  if ( this->ArePointsPathRolesUsingBaseNameOnly() )
-  {
-    this->FixPointsPathRolesUsingBaseNameOnly();
-  }
+  this->MigratePointsPathRolesIfNeeded();
   
   if ( suffixesArray == NULL )
   {
@@ -427,10 +730,7 @@ int vtkMRMLPathReconstructionNode::GetSuffixOfLastPathPointsPairAdded()
 void vtkMRMLPathReconstructionNode::AddPointsPathPairModelNodeIDs( const char* pointsNodeID, const char* pathNodeID )
 {
   // update reference roles if needed
-  if ( this->ArePointsPathRolesUsingBaseNameOnly() )
-  {
-    this->FixPointsPathRolesUsingBaseNameOnly();
-  }
+  this->MigratePointsPathRolesIfNeeded();
 
   if ( this->IsModelNodeBeingObserved( pointsNodeID ) )
   {
@@ -446,26 +746,26 @@ void vtkMRMLPathReconstructionNode::AddPointsPathPairModelNodeIDs( const char* p
 
   int newSuffix = this->GetSuffixOfLastPathPointsPairAdded() + 1; // Get largest element, add 1
   this->ReferenceRoleSuffixes.insert( newSuffix );
+  IndexedPointsPathPair& indexedPair = *this->AddSuffixToIndex( newSuffix );
 
-  std::string pointsReferenceRole = this->GetNodeReferenceRole( POINTS_MODEL_ROLE_PREFIX, newSuffix );
-  this->AddNodeReferenceRole( pointsReferenceRole.c_str() );
-  this->SetAndObserveNodeReferenceID( pointsReferenceRole.c_str(), pointsNodeID );
+  const char* pointsReferenceRole = indexedPair.Points.ReferenceRole.c_str();
+  this->AddNodeReferenceRole( pointsReferenceRole );
+  this->SetAndObserveNodeReferenceID( pointsReferenceRole, pointsNodeID );
+  this->SetIndexedModelNode( indexedPair.Points, newSuffix, pointsNodeID, this->GetNodeReference( pointsReferenceRole ) );
 
-  std::string pathReferenceRole = this->GetNodeReferenceRole( PATH_MODEL_ROLE_PREFIX, newSuffix );
-  this->AddNodeReferenceRole( pathReferenceRole.c_str() );
-  this->SetAndObserveNodeReferenceID( pathReferenceRole.c_str(), pathNodeID );
+  const char* pathReferenceRole = indexedPair.Path.ReferenceRole.c_str();
+  this->AddNodeReferenceRole( pathReferenceRole );
+  this->SetAndObserveNodeReferenceID( pathReferenceRole, pathNodeID );
+  this->SetIndexedModelNode( indexedPair.Path, newSuffix, pathNodeID, this->GetNodeReference( pathReferenceRole ) );
 
-  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::PathAddedEvent );
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::PathAddedEvent, &newSuffix );
 }
 
 //------------------------------------------------------------------------------
 void vtkMRMLPathReconstructionNode::RemovePointsPathPairBySuffix( int suffix )
 {
   // update reference roles if needed
-  if ( this->ArePointsPathRolesUsingBaseNameOnly() )
-  {
-    this->FixPointsPathRolesUsingBaseNameOnly();
-  }
+  this->MigratePointsPathRolesIfNeeded();
 
   // check if it contains this node (note: std::set::contains will be added in C++20)
   if ( this->ReferenceRoleSuffixes.find( suffix ) == this->ReferenceRoleSuffixes.end() )
@@ -481,7 +781,9 @@ void vtkMRMLPathReconstructionNode::RemovePointsPathPairBySuffix( int suffix )
   this->RemoveNodeReferenceIDs( pathReferenceRole.c_str() );
   
   this->ReferenceRoleSuffixes.erase( suffix );
+  this->RemoveSuffixFromIndex( suffix );
 
+  this->InvokeCustomModifiedEvent( vtkMRMLPathReconstructionNode::PathRemovedEvent, &suffix );
   this->Modified();
 }
 
@@ -497,32 +799,508 @@ std::string vtkMRMLPathReconstructionNode::GetNodeReferenceRole( const char* pre
 //------------------------------------------------------------------------------
 bool vtkMRMLPathReconstructionNode::IsModelNodeBeingObserved( const char* nodeID )
 {
+  if ( nodeID == NULL )
+  {
+    return false;
+  }
+  return ( this->ModelNodeIDToSuffix.find( nodeID ) != this->ModelNodeIDToSuffix.end() );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::RebuildPointsPathPairIndex()
+{
+  this->PointsPathPairIndex.clear();
+  this->SparsePointsPathPairIndex.clear();
+  this->ModelNodeIDToSuffix.clear();
   for ( std::set< int >::iterator suffixIterator = this->ReferenceRoleSuffixes.begin(); suffixIterator != this->ReferenceRoleSuffixes.end(); suffixIterator++ )
   {
-    std::string pointsReferenceRole = this->GetNodeReferenceRole( POINTS_MODEL_ROLE_PREFIX, *suffixIterator );
-    vtkMRMLModelNode* pointsNode = vtkMRMLModelNode::SafeDownCast( this->GetNodeReference( pointsReferenceRole.c_str() ) );
-    if ( pointsNode != NULL )
+    int suffix = *suffixIterator;
+    IndexedPointsPathPair* indexedPair = this->AddSuffixToIndex( suffix );
+    if ( indexedPair == NULL )
     {
-      const char* pointsNodeID = pointsNode->GetID();
-      if ( strcmp( nodeID, pointsNodeID ) == 0 )
-      {
-        return true;
-      }
+      continue;
     }
-    
-    std::string pathReferenceRole = this->GetNodeReferenceRole( PATH_MODEL_ROLE_PREFIX, *suffixIterator );
-    vtkMRMLModelNode* pathNode = vtkMRMLModelNode::SafeDownCast( this->GetNodeReference( pathReferenceRole.c_str() ) );
-    if ( pathNode != NULL )
+    // nodes are resolved on first access, the scene may still be loading
+    this->SetIndexedModelNode( indexedPair->Points, suffix, this->GetNodeReferenceID( indexedPair->Points.ReferenceRole.c_str() ), NULL );
+    this->SetIndexedModelNode( indexedPair->Path, suffix, this->GetNodeReferenceID( indexedPair->Path.ReferenceRole.c_str() ), NULL );
+  }
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLPathReconstructionNode::IndexedPointsPathPair* vtkMRMLPathReconstructionNode::AddSuffixToIndex( int suffix )
+{
+  if ( suffix < 0 )
+  {
+    vtkWarningMacro( "Negative suffix " << suffix << " cannot be indexed." );
+    return NULL;
+  }
+
+  IndexedPointsPathPair unusedPair;
+  unusedPair.Valid = false;
+  unusedPair.Descriptor.Computed = false;
+  unusedPair.PointsReadMTime = 0;
+
+  IndexedPointsPathPair* indexedPair = NULL;
+  if ( suffix > MAXIMUM_DIRECTLY_INDEXED_SUFFIX )
+  {
+    if ( this->SparsePointsPathPairIndex.empty() )
+    {
+      vtkWarningMacro( "Suffix " << suffix << " is larger than " << MAXIMUM_DIRECTLY_INDEXED_SUFFIX << ". Suffixes this large are looked up more slowly." );
+    }
+    indexedPair = &( this->SparsePointsPathPairIndex.insert( std::make_pair( suffix, unusedPair ) ).first->second );
+  }
+  else
+  {
+    if ( suffix >= ( int ) this->PointsPathPairIndex.size() )
     {
-      const char* pathNodeID = pathNode->GetID();
-      if ( strcmp( nodeID, pathNodeID ) == 0 )
+      this->PointsPathPairIndex.resize( suffix + 1, unusedPair );
+    }
+    indexedPair = &( this->PointsPathPairIndex[ suffix ] );
+  }
+
+  indexedPair->Valid = true;
+  indexedPair->Descriptor.Computed = false;
+  indexedPair->PointsReadMTime = 0;
+  indexedPair->Points.ReferenceRole = this->GetNodeReferenceRole( POINTS_MODEL_ROLE_PREFIX, suffix );
+  indexedPair->Path.ReferenceRole = this->GetNodeReferenceRole( PATH_MODEL_ROLE_PREFIX, suffix );
+  return indexedPair;
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLPathReconstructionNode::IndexedPointsPathPair* vtkMRMLPathReconstructionNode::FindIndexedPointsPathPair( int suffix )
+{
+  if ( suffix < 0 )
+  {
+    return NULL;
+  }
+  if ( suffix > MAXIMUM_DIRECTLY_INDEXED_SUFFIX )
+  {
+    std::unordered_map< int, IndexedPointsPathPair >::iterator sparseIterator = this->SparsePointsPathPairIndex.find( suffix );
+    if ( sparseIterator == this->SparsePointsPathPairIndex.end() || !sparseIterator->second.Valid )
+    {
+      return NULL;
+    }
+    return &( sparseIterator->second );
+  }
+  if ( suffix >= ( int ) this->PointsPathPairIndex.size() || !this->PointsPathPairIndex[ suffix ].Valid )
+  {
+    return NULL;
+  }
+  return &( this->PointsPathPairIndex[ suffix ] );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::RemoveSuffixFromIndex( int suffix )
+{
+  IndexedPointsPathPair* indexedPair = this->FindIndexedPointsPathPair( suffix );
+  if ( indexedPair == NULL )
+  {
+    return;
+  }
+
+  this->SetIndexedModelNode( indexedPair->Points, suffix, NULL, NULL );
+  this->SetIndexedModelNode( indexedPair->Path, suffix, NULL, NULL );
+  indexedPair->Valid = false;
+  indexedPair->Descriptor.Computed = false;
+  if ( suffix > MAXIMUM_DIRECTLY_INDEXED_SUFFIX )
+  {
+    this->SparsePointsPathPairIndex.erase( suffix );
+    return;
+  }
+
+  while ( !this->PointsPathPairIndex.empty() && !this->PointsPathPairIndex.back().Valid )
+  {
+    this->PointsPathPairIndex.pop_back();
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::SetIndexedModelNode( IndexedModelNode& indexedModelNode, int suffix, const char* nodeID, vtkMRMLNode* node )
+{
+  if ( !indexedModelNode.NodeID.empty() )
+  {
+    std::unordered_map< std::string, int >::iterator reverseIterator = this->ModelNodeIDToSuffix.find( indexedModelNode.NodeID );
+    if ( reverseIterator != this->ModelNodeIDToSuffix.end() && reverseIterator->second == suffix )
+    {
+      this->ModelNodeIDToSuffix.erase( reverseIterator );
+    }
+  }
+
+  indexedModelNode.NodeID = ( nodeID != NULL ? nodeID : "" );
+  indexedModelNode.Node = vtkMRMLModelNode::SafeDownCast( node );
+  if ( !indexedModelNode.NodeID.empty() )
+  {
+    this->ModelNodeIDToSuffix[ indexedModelNode.NodeID ] = suffix;
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::UpdateIndexFromReference( vtkMRMLNodeReference* reference, bool removed )
+{
+  if ( reference == NULL || reference->GetReferenceRole() == NULL )
+  {
+    return;
+  }
+
+  const char* referenceRole = reference->GetReferenceRole();
+  const char* prefixes[ 2 ] = { POINTS_MODEL_ROLE_PREFIX, PATH_MODEL_ROLE_PREFIX };
+  for ( int prefixIndex = 0; prefixIndex < 2; prefixIndex++ )
+  {
+    size_t prefixLength = strlen( prefixes[ prefixIndex ] );
+    if ( strncmp( referenceRole, prefixes[ prefixIndex ], prefixLength ) != 0 )
+    {
+      continue;
+    }
+
+    // roles without a number are from older versions, they are not indexed
+    const char* suffixText = referenceRole + prefixLength;
+    char* suffixTextEnd = NULL;
+    long suffix = strtol( suffixText, &suffixTextEnd, 10 );
+    if ( suffixTextEnd == suffixText || *suffixTextEnd != '\0' )
+    {
+      return;
+    }
+    IndexedPointsPathPair* indexedPair = ( suffix <= VTK_INT_MAX ) ? this->FindIndexedPointsPathPair( ( int ) suffix ) : NULL;
+    if ( indexedPair == NULL )
+    {
+      return;
+    }
+
+    IndexedModelNode& indexedModelNode = ( prefixIndex == 0 ? indexedPair->Points : indexedPair->Path );
+    if ( removed )
+    {
+      this->SetIndexedModelNode( indexedModelNode, suffix, NULL, NULL );
+    }
+    else
+    {
+      this->SetIndexedModelNode( indexedModelNode, suffix, reference->GetReferencedNodeID(), reference->GetReferencedNode() );
+    }
+    return;
+  }
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLModelNode* vtkMRMLPathReconstructionNode::GetIndexedModelNode( IndexedModelNode& indexedModelNode )
+{
+  if ( indexedModelNode.Node == NULL && !indexedModelNode.NodeID.empty() )
+  {
+    // The reference may not have been resolved yet (e.g. while the scene is loading)
+    indexedModelNode.Node = vtkMRMLModelNode::SafeDownCast( this->GetNodeReference( indexedModelNode.ReferenceRole.c_str() ) );
+  }
+  return indexedModelNode.Node;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLPathReconstructionNode::GetPathCentroid( int suffix, double centroid[ 3 ] )
+{
+  const PathDescriptor* descriptor = this->GetPathDescriptor( suffix );
+  if ( descriptor == NULL )
+  {
+    return false;
+  }
+  centroid[ 0 ] = descriptor->Centroid[ 0 ];
+  centroid[ 1 ] = descriptor->Centroid[ 1 ];
+  centroid[ 2 ] = descriptor->Centroid[ 2 ];
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLPathReconstructionNode::GetPathBounds( int suffix, double bounds[ 6 ] )
+{
+  const PathDescriptor* descriptor = this->GetPathDescriptor( suffix );
+  if ( descriptor == NULL )
+  {
+    return false;
+  }
+  for ( int boundIndex = 0; boundIndex < 6; boundIndex++ )
+  {
+    bounds[ boundIndex ] = descriptor->Bounds[ boundIndex ];
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLPathReconstructionNode::GetPathFirstPoint( int suffix, double point[ 3 ] )
+{
+  const PathDescriptor* descriptor = this->GetPathDescriptor( suffix );
+  if ( descriptor == NULL )
+  {
+    return false;
+  }
+  point[ 0 ] = descriptor->FirstPoint[ 0 ];
+  point[ 1 ] = descriptor->FirstPoint[ 1 ];
+  point[ 2 ] = descriptor->FirstPoint[ 2 ];
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLPathReconstructionNode::GetPathLastPoint( int suffix, double point[ 3 ] )
+{
+  const PathDescriptor* descriptor = this->GetPathDescriptor( suffix );
+  if ( descriptor == NULL )
+  {
+    return false;
+  }
+  point[ 0 ] = descriptor->LastPoint[ 0 ];
+  point[ 1 ] = descriptor->LastPoint[ 1 ];
+  point[ 2 ] = descriptor->LastPoint[ 2 ];
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLPathReconstructionNode::GetPathPrincipalDirection( int suffix, double direction[ 3 ] )
+{
+  const PathDescriptor* descriptor = this->GetPathDescriptor( suffix );
+  if ( descriptor == NULL )
+  {
+    return false;
+  }
+  direction[ 0 ] = descriptor->PrincipalDirection[ 0 ];
+  direction[ 1 ] = descriptor->PrincipalDirection[ 1 ];
+  direction[ 2 ] = descriptor->PrincipalDirection[ 2 ];
+  return true;
+}
+
+//------------------------------------------------------------------------------
+double vtkMRMLPathReconstructionNode::GetPathArcLength( int suffix )
+{
+  const PathDescriptor* descriptor = this->GetPathDescriptor( suffix );
+  if ( descriptor == NULL )
+  {
+    return -1.0;
+  }
+  return descriptor->ArcLength;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLPathReconstructionNode::GetPathNumberOfPoints( int suffix )
+{
+  const PathDescriptor* descriptor = this->GetPathDescriptor( suffix );
+  if ( descriptor == NULL )
+  {
+    return 0;
+  }
+  return descriptor->NumberOfPoints;
+}
+
+//------------------------------------------------------------------------------
+vtkPolyData* vtkMRMLPathReconstructionNode::GetCombinedPathPolyData()
+{
+  this->UpdateCombinedPath();
+  return this->CombinedPathPolyData;
+}
+
+//------------------------------------------------------------------------------
+vtkAbstractPointLocator* vtkMRMLPathReconstructionNode::GetCombinedPathPointLocator()
+{
+  this->UpdateCombinedPath();
+  return this->CombinedPathPointLocator;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::UpdateCombinedPath()
+{
+  // update reference roles if needed
+  this->MigratePointsPathRolesIfNeeded();
+
+  std::vector< std::pair< vtkPolyData*, vtkMTimeType > > combinedPathInputs;
+  vtkIdType numberOfCombinedPoints = 0;
+  for ( std::set< int >::iterator suffixIterator = this->ReferenceRoleSuffixes.begin(); suffixIterator != this->ReferenceRoleSuffixes.end(); suffixIterator++ )
+  {
+    vtkMRMLModelNode* pathNode = this->GetPathModelNodeBySuffix( *suffixIterator );
+    vtkPolyData* pathPolyData = ( pathNode != NULL ) ? pathNode->GetPolyData() : NULL;
+    if ( pathPolyData == NULL || pathPolyData->GetNumberOfPoints() == 0 )
+    {
+      continue;
+    }
+    combinedPathInputs.push_back( std::make_pair( pathPolyData, pathPolyData->GetMTime() ) );
+    numberOfCombinedPoints += pathPolyData->GetNumberOfPoints();
+  }
+
+  if ( combinedPathInputs == this->CombinedPathInputs &&
+       ( this->CombinedPathPolyData != NULL || combinedPathInputs.empty() ) )
+  {
+    return;
+  }
+  this->CombinedPathInputs = combinedPathInputs;
+  this->CombinedPathPolyData = NULL;
+  this->CombinedPathPointLocator = NULL;
+  if ( numberOfCombinedPoints == 0 )
+  {
+    return;
+  }
+
+  vtkSmartPointer< vtkPoints > combinedPoints = vtkSmartPointer< vtkPoints >::New();
+  combinedPoints->SetNumberOfPoints( numberOfCombinedPoints );
+  vtkIdType combinedPointIndex = 0;
+  for ( std::vector< std::pair< vtkPolyData*, vtkMTimeType > >::iterator inputIterator = combinedPathInputs.begin(); inputIterator != combinedPathInputs.end(); inputIterator++ )
+  {
+    vtkPoints* pathPoints = inputIterator->first->GetPoints();
+    vtkIdType numberOfPathPoints = pathPoints->GetNumberOfPoints();
+    for ( vtkIdType pathPointIndex = 0; pathPointIndex < numberOfPathPoints; pathPointIndex++ )
+    {
+      combinedPoints->SetPoint( combinedPointIndex++, pathPoints->GetPoint( pathPointIndex ) );
+    }
+  }
+
+  this->CombinedPathPolyData = vtkSmartPointer< vtkPolyData >::New();
+  this->CombinedPathPolyData->SetPoints( combinedPoints );
+  this->CombinedPathPointLocator = vtkSmartPointer< vtkStaticPointLocator >::New();
+  this->CombinedPathPointLocator->SetDataSet( this->CombinedPathPolyData );
+  this->CombinedPathPointLocator->BuildLocator();
+}
+
+//------------------------------------------------------------------------------
+const vtkMRMLPathReconstructionNode::PathDescriptor* vtkMRMLPathReconstructionNode::GetPathDescriptor( int suffix )
+{
+  vtkMRMLModelNode* pointsNode = this->GetPointsModelNodeBySuffix( suffix );
+  if ( pointsNode == NULL )
+  {
+    return NULL;
+  }
+  vtkPolyData* pointsPolyData = pointsNode->GetPolyData();
+  if ( pointsPolyData == NULL || pointsPolyData->GetNumberOfPoints() == 0 )
+  {
+    return NULL;
+  }
+  vtkMRMLModelNode* pathNode = this->GetPathModelNodeBySuffix( suffix );
+  vtkPolyData* pathPolyData = ( pathNode != NULL ) ? pathNode->GetPolyData() : NULL;
+
+  PathDescriptor& descriptor = this->FindIndexedPointsPathPair( suffix )->Descriptor;
+  if ( descriptor.Computed &&
+       descriptor.PointsPolyData == pointsPolyData &&
+       descriptor.PointsPolyDataMTime == pointsPolyData->GetMTime() &&
+       descriptor.PathPolyData == pathPolyData &&
+       descriptor.PathPolyDataMTime == ( pathPolyData != NULL ? pathPolyData->GetMTime() : 0 ) &&
+       descriptor.PathNodeMTime == ( pathNode != NULL ? pathNode->GetMTime() : 0 ) )
+  {
+    return &descriptor;
+  }
+
+  vtkMRMLPathReconstructionNode::ComputePathDescriptor( pointsPolyData, pathNode, descriptor );
+  descriptor.PointsPolyData = pointsPolyData;
+  descriptor.PointsPolyDataMTime = pointsPolyData->GetMTime();
+  descriptor.PathPolyData = pathPolyData;
+  descriptor.PathPolyDataMTime = ( pathPolyData != NULL ? pathPolyData->GetMTime() : 0 );
+  descriptor.PathNodeMTime = ( pathNode != NULL ? pathNode->GetMTime() : 0 );
+  descriptor.Computed = true;
+  return &descriptor;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::ComputePathDescriptor( vtkPolyData* pointsPolyData, vtkMRMLModelNode* pathNode, PathDescriptor& descriptor )
+{
+  vtkPoints* points = pointsPolyData->GetPoints();
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  descriptor.NumberOfPoints = numberOfPoints;
+  points->GetPoint( 0, descriptor.FirstPoint );
+  points->GetPoint( numberOfPoints - 1, descriptor.LastPoint );
+  points->GetBounds( descriptor.Bounds );
+
+  // centroid and polyline length in one pass
+  double sum[ 3 ] = { 0.0, 0.0, 0.0 };
+  double polylineLength = 0.0;
+  double previousPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    points->GetPoint( pointIndex, point );
+    vtkMath::Add( sum, point, sum );
+    if ( pointIndex > 0 )
+    {
+      polylineLength += std::sqrt( vtkMath::Distance2BetweenPoints( previousPoint, point ) );
+    }
+    previousPoint[ 0 ] = point[ 0 ];
+    previousPoint[ 1 ] = point[ 1 ];
+    previousPoint[ 2 ] = point[ 2 ];
+  }
+  descriptor.Centroid[ 0 ] = sum[ 0 ] / numberOfPoints;
+  descriptor.Centroid[ 1 ] = sum[ 1 ] / numberOfPoints;
+  descriptor.Centroid[ 2 ] = sum[ 2 ] / numberOfPoints;
+
+  // principal direction is the eigenvector of the covariance with the largest eigenvalue
+  double covariance[ 3 ][ 3 ] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    points->GetPoint( pointIndex, point );
+    double offset[ 3 ] = { 0.0, 0.0, 0.0 };
+    vtkMath::Subtract( point, descriptor.Centroid, offset );
+    for ( int row = 0; row < 3; row++ )
+    {
+      for ( int column = 0; column < 3; column++ )
       {
-        return true;
+        covariance[ row ][ column ] += offset[ row ] * offset[ column ];
       }
     }
   }
+  double eigenvalues[ 3 ] = { 0.0, 0.0, 0.0 };
+  double eigenvectors[ 3 ][ 3 ] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  double* covarianceRows[ 3 ] = { covariance[ 0 ], covariance[ 1 ], covariance[ 2 ] };
+  double* eigenvectorRows[ 3 ] = { eigenvectors[ 0 ], eigenvectors[ 1 ], eigenvectors[ 2 ] };
+  vtkMath::Jacobi( covarianceRows, eigenvalues, eigenvectorRows ); // sorted by decreasing eigenvalue, eigenvectors in columns
+  descriptor.PrincipalDirection[ 0 ] = eigenvectors[ 0 ][ 0 ];
+  descriptor.PrincipalDirection[ 1 ] = eigenvectors[ 1 ][ 0 ];
+  descriptor.PrincipalDirection[ 2 ] = eigenvectors[ 2 ][ 0 ];
+  double firstToLast[ 3 ] = { 0.0, 0.0, 0.0 };
+  vtkMath::Subtract( descriptor.LastPoint, descriptor.FirstPoint, firstToLast );
+  if ( vtkMath::Dot( firstToLast, descriptor.PrincipalDirection ) < 0.0 )
+  {
+    vtkMath::MultiplyScalar( descriptor.PrincipalDirection, -1.0 );
+  }
+
+  // The fitted curve is smoother than the raw points, so its length is preferred.
+  // Edits of the points (e.g. TrimPaths) remove the attribute until the path is refit.
+  descriptor.ArcLength = polylineLength;
+  const char* curveLengthAttribute = NULL;
+  if ( pathNode != NULL )
+  {
+    curveLengthAttribute = pathNode->GetAttribute( vtkMRMLMarkupsToModelNode::GetOutputCurveLengthAttributeName() );
+  }
+  if ( curveLengthAttribute != NULL )
+  {
+    char* curveLengthAttributeEnd = NULL;
+    double curveLength = strtod( curveLengthAttribute, &curveLengthAttributeEnd );
+    if ( curveLengthAttributeEnd != curveLengthAttribute )
+    {
+      descriptor.ArcLength = curveLength;
+    }
+  }
+}
 
-  return false;
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::MigratePointsPathRolesIfNeeded()
+{
+  if ( this->PointsPathRolesMigrated )
+  {
+    return;
+  }
+
+  // While a scene is being imported the referenced nodes may not exist yet.
+  // UpdateReferences will do the migration once the import is done.
+  vtkMRMLScene* scene = this->GetScene();
+  if ( scene == NULL || scene->IsImporting() )
+  {
+    return;
+  }
+
+  this->MigratePointsPathRoles();
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionNode::MigratePointsPathRoles()
+{
+  if ( this->GetScene() == NULL )
+  {
+    return;
+  }
+
+  // Only attempt this once, a failed migration should not be retried on every access
+  this->PointsPathRolesMigrated = true;
+  if ( this->ArePointsPathRolesUsingBaseNameOnly() )
+  {
+    this->FixPointsPathRolesUsingBaseNameOnly();
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -530,14 +1308,12 @@ bool vtkMRMLPathReconstructionNode::ArePointsPathRolesUsingBaseNameOnly()
 {
   // Current implementation uses a base role name plus a number.
   // If the number is missing, then the role name(s) need to be updated.
-  vtkMRMLNode* pointsNode = this->GetNodeReference( POINTS_MODEL_ROLE_PREFIX );
-  if ( pointsNode != NULL )
+  if ( this->GetNodeReferenceID( POINTS_MODEL_ROLE_PREFIX ) != NULL )
   {
     return true;
   }
 
-  vtkMRMLNode* pathNode = this->GetNodeReference( PATH_MODEL_ROLE_PREFIX );
-  if ( pathNode != NULL )
+  if ( this->GetNodeReferenceID( PATH_MODEL_ROLE_PREFIX ) != NULL )
   {
     return true;
   }
@@ -592,6 +1368,7 @@ void vtkMRMLPathReconstructionNode::FixPointsPathRolesUsingBaseNameOnly()
     this->RemoveNthNodeReferenceID( PATH_MODEL_ROLE_PREFIX, pointsPathPairIndex );
   }
 
+  this->RebuildPointsPathPairIndex();
   this->EndModify( wasModify );
 
   vtkInfoMacro( "Successfully updated role names in vtkMRMLPathReconstructionNode " << this->GetName() );
@@ -628,3 +1405,36 @@ const char* vtkMRMLPathReconstructionNode::RecordingStateAsString( int id )
     return "Unknown";
   }
 }
+
+//------------------------------------------------------------------------------
+int vtkMRMLPathReconstructionNode::LevelOfDetailFromString( const char* name )
+{
+  if ( name == NULL )
+  {
+    vtkGenericWarningMacro( "Null name provided." );
+    return -1;
+  }
+  for ( int i = 0; i < LevelOfDetail_Last; i++ )
+  {
+    if ( strcmp( name, vtkMRMLPathReconstructionNode::LevelOfDetailAsString( i ) ) == 0 )
+    {
+      return i;
+    }
+  }
+  vtkGenericWarningMacro( "Unknown name provided " << name );
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+const char* vtkMRMLPathReconstructionNode::LevelOfDetailAsString( int id )
+{
+  switch ( id )
+  {
+  case LevelOfDetailPolyline: return "Polyline";
+  case LevelOfDetailCoarseTube: return "CoarseTube";
+  case LevelOfDetailFullTube: return "FullTube";
+  default:
+    vtkGenericWarningMacro( "Unknown id provided " << id );
+    return "Unknown";
+  }
+}
@@ -22,20 +22,30 @@
 // vtk includes
 #include <vtkObject.h>
 #include <vtkCommand.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
 
 // Slicer includes
-#include "vtkMRMLNode.h"
+#include "vtkMRMLStorableNode.h"
 #include "vtkMRMLScene.h"
 
+class vtkAbstractPointLocator;
 class vtkMRMLCollectPointsNode;
 class vtkMRMLTransformNode;
 class vtkMRMLMarkupsToModelNode;
 class vtkMRMLModelNode;
+class vtkPolyData;
+class vtkStaticPointLocator;
+
+// STD includes
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "vtkSlicerPathReconstructionModuleMRMLExport.h"
 
 class VTK_SLICER_PATHRECONSTRUCTION_MODULE_MRML_EXPORT vtkMRMLPathReconstructionNode
-: public vtkMRMLNode
+: public vtkMRMLStorableNode
 {
 public:
 
@@ -46,7 +56,11 @@ public:
     /// InputDataModifiedEvent is invoked when input parameters/nodes are changed (including the relevant data inside nodes).
     InputDataModifiedEvent = vtkCommand::UserEvent + 595,
     // PathAddedEvent is invoked when a path is added to this node
-    PathAddedEvent = vtkCommand::UserEvent + 596
+    PathAddedEvent = vtkCommand::UserEvent + 596,
+    // PathRemovedEvent is invoked when a path is removed from this node.
+    // For both events callData points to the int suffix of the path. If the events
+    // were compressed during StartModify/EndModify, callData is NULL.
+    PathRemovedEvent = vtkCommand::UserEvent + 597
   };
 
   enum RecordingState
@@ -56,7 +70,16 @@ public:
     RecordingState_Last // valid types go above this line
   };
 
-  vtkTypeMacro( vtkMRMLPathReconstructionNode, vtkMRMLNode );
+  // How the path is shown while it is being recorded
+  enum LevelOfDetail
+  {
+    LevelOfDetailPolyline = 0,
+    LevelOfDetailCoarseTube,
+    LevelOfDetailFullTube,
+    LevelOfDetail_Last // valid types go above this line
+  };
+
+  vtkTypeMacro( vtkMRMLPathReconstructionNode, vtkMRMLStorableNode );
   
   // Standard MRML node methods
   static vtkMRMLPathReconstructionNode *New();  
@@ -67,6 +90,19 @@ public:
   virtual void ReadXMLAttributes( const char** atts );
   virtual void WriteXML( ostream& of, int indent );
   virtual void Copy( vtkMRMLNode *node );
+  virtual void UpdateReferences();
+  virtual void UpdateReferenceID( const char* oldID, const char* newID );
+
+  // The recorded points of all paths are stored together in one binary file,
+  // see vtkMRMLPathReconstructionStorageNode
+  virtual vtkMRMLStorageNode* CreateDefaultStorageNode();
+  // Also true if the points of a path changed since the file was read or written
+  virtual bool GetModifiedSinceRead();
+
+  // Set the points of the points models that have no data yet from the file last read by the
+  // storage node. Called by the logic when a scene import ends, and by the storage node when
+  // it reads outside of an import. Points models of older scenes have their own storage node.
+  void ReadPackedPoints();
   
 protected:
 
@@ -75,6 +111,11 @@ protected:
   vtkMRMLPathReconstructionNode ( const vtkMRMLPathReconstructionNode& );
   void operator=( const vtkMRMLPathReconstructionNode& );
 
+  // Keep the suffix index in sync with the points/path reference roles
+  virtual void OnNodeReferenceAdded( vtkMRMLNodeReference* reference );
+  virtual void OnNodeReferenceRemoved( vtkMRMLNodeReference* reference );
+  virtual void OnNodeReferenceModified( vtkMRMLNodeReference* reference );
+
 public:
   void ProcessMRMLEvents( vtkObject* caller, unsigned long event, void* callData ) override;
 
@@ -82,6 +123,15 @@ public:
   vtkMRMLTransformNode* GetSamplingTransformNode();
   vtkMRMLTransformNode* GetAnchorTransformNode();
 
+  // Recording channels. Each channel samples its own transform, and gets its own points and path
+  // models while recording, so several tools can be recorded at the same time. Channel 0 is the
+  // CollectPoints sampling transform, the others are added with AddChannelSamplingTransformNodeID.
+  // All channels are relative to the CollectPoints anchor transform.
+  int GetNumberOfChannels();
+  vtkMRMLTransformNode* GetChannelSamplingTransformNode( int channel );
+  void AddChannelSamplingTransformNodeID( const char* nodeID );
+  void RemoveAllChannelSamplingTransformNodes();
+
   vtkGetMacro( PointsColorRed, double );
   vtkGetMacro( PointsColorGreen, double );
   vtkGetMacro( PointsColorBlue, double );
@@ -100,6 +150,37 @@ public:
   vtkGetMacro( NextCount, int );
   void SetNextCount( int );
 
+  // Level of detail of the path model while recording
+  vtkGetMacro( LiveLevelOfDetail, int );
+  void SetLiveLevelOfDetail( int );
+  void SetLiveLevelOfDetailToPolyline() { this->SetLiveLevelOfDetail( LevelOfDetailPolyline ); }
+  void SetLiveLevelOfDetailToCoarseTube() { this->SetLiveLevelOfDetail( LevelOfDetailCoarseTube ); }
+  void SetLiveLevelOfDetailToFullTube() { this->SetLiveLevelOfDetail( LevelOfDetailFullTube ); }
+
+  // If true, the full resolution path is generated shortly after recording stops.
+  // Otherwise the live path is kept until a refit is requested.
+  vtkGetMacro( FullResolutionOnStop, bool );
+  void SetFullResolutionOnStop( bool );
+  vtkBooleanMacro( FullResolutionOnStop, bool );
+
+  // Filtering of the recorded samples before they are added to the points model,
+  // see vtkPathSampleFilter. Spikes are rejected with a sliding median test, and positions
+  // are optionally smoothed with a constant velocity Kalman filter. Both are off by default.
+  vtkGetMacro( SampleOutlierRejection, bool );
+  void SetSampleOutlierRejection( bool );
+  vtkBooleanMacro( SampleOutlierRejection, bool );
+  vtkGetMacro( OutlierWindowSize, int ); // number of samples in the median window
+  void SetOutlierWindowSize( int );
+  vtkGetMacro( OutlierThreshold, double ); // multiple of the median distance to the median
+  void SetOutlierThreshold( double );
+  vtkGetMacro( SampleSmoothing, bool );
+  void SetSampleSmoothing( bool );
+  vtkBooleanMacro( SampleSmoothing, bool );
+  vtkGetMacro( SmoothingProcessNoise, double ); // acceleration spectral density, mm^2/s^3
+  void SetSmoothingProcessNoise( double );
+  vtkGetMacro( SmoothingMeasurementNoise, double ); // standard deviation of the samples, mm
+  void SetSmoothingMeasurementNoise( double );
+
   void CreateDefaultCollectPointsNode();
   void ApplyDefaultSettingsToCollectPointsNode( vtkMRMLCollectPointsNode* node );
   vtkMRMLCollectPointsNode* GetCollectPointsNode();
@@ -126,8 +207,50 @@ public:
   void AddPointsPathPairModelNodeIDs( const char* pointsNodeID, const char* pathNodeID );
   void RemovePointsPathPairBySuffix( int suffix );
 
+  // Descriptors of the recorded points of each path, in the coordinates of the points model.
+  // They are cached and only recomputed when the points or path model data change.
+  // Each returns false (or -1) if the path has no points.
+  bool GetPathCentroid( int suffix, double centroid[ 3 ] );
+  bool GetPathBounds( int suffix, double bounds[ 6 ] );
+  bool GetPathFirstPoint( int suffix, double point[ 3 ] );
+  bool GetPathLastPoint( int suffix, double point[ 3 ] );
+  // Unit direction of largest spread of the points (principal component), pointing from the first to the last point
+  bool GetPathPrincipalDirection( int suffix, double direction[ 3 ] );
+  // Curve length of the path model if it was fitted, otherwise the length of the polyline through the points
+  double GetPathArcLength( int suffix );
+  int GetPathNumberOfPoints( int suffix );
+
+  // Points of all path models combined into one point set, and a point locator built on them.
+  // Both are cached, and only rebuilt when a path is added or removed or a path model changes.
+  // The locator is a vtkStaticPointLocator, so FindClosestPoint can be called from several threads.
+  // Each returns NULL if there are no path points.
+  vtkPolyData* GetCombinedPathPolyData();
+  vtkAbstractPointLocator* GetCombinedPathPointLocator();
+
+  // Names of the optional point data arrays of the points models, with the time each point
+  // was recorded (1 component) and the orientation of the sampling transform (quaternion wxyz).
+  // Both are float arrays. Timestamps are seconds since the recording started, which is stored
+  // (in universal time) in the points model attribute GetRecordingStartTimeAttributeName.
+  static const char* GetPointTimestampArrayName() { return "Timestamp"; };
+  static const char* GetPointOrientationArrayName() { return "Orientation"; };
+  static const char* GetRecordingStartTimeAttributeName() { return "PathReconstruction.RecordingStartTime"; };
+
+  // Names of the points model attributes with the number of samples that were kept
+  // and dropped by the sample decimation while the path was recorded
+  static const char* GetNumberOfKeptSamplesAttributeName() { return "PathReconstruction.NumberOfKeptSamples"; };
+  static const char* GetNumberOfDroppedSamplesAttributeName() { return "PathReconstruction.NumberOfDroppedSamples"; };
+  // Name of the points model attribute with the number of samples rejected as outliers
+  static const char* GetNumberOfRejectedSamplesAttributeName() { return "PathReconstruction.NumberOfRejectedSamples"; };
+
+  // Name of the path model attribute with the fingerprint of the inputs of its last fit,
+  // see vtkSlicerPathReconstructionLogic::RefitAllPaths
+  static const char* GetFitFingerprintAttributeName() { return "PathReconstruction.FitFingerprint"; };
+
   static int RecordingStateFromString( const char* name );
   static const char* RecordingStateAsString( int id );
+
+  static int LevelOfDetailFromString( const char* name );
+  static const char* LevelOfDetailAsString( int id );
   
 private:
   // the next collected pair of points and path will have these base names:
@@ -143,6 +266,18 @@ private:
   // Determine when new paths are being recorded. Options are stopped and recording.
   int RecordingState;
 
+  // Determine how paths are displayed while recording, and whether to refine them afterwards
+  int LiveLevelOfDetail;
+  bool FullResolutionOnStop;
+
+  // Filtering of the samples while recording
+  bool SampleOutlierRejection;
+  int OutlierWindowSize;
+  double OutlierThreshold;
+  bool SampleSmoothing;
+  double SmoothingProcessNoise;
+  double SmoothingMeasurementNoise;
+
   // store the color selections made in this module (need to be copied each time a new model node is created)
   double PointsColorRed;
   double PointsColorGreen;
@@ -151,13 +286,81 @@ private:
   double PathColorGreen;
   double PathColorBlue;
 
+  // Index of the points and path model nodes, so that lookups do not need to build role names.
+  // PointsPathPairIndex is indexed directly by suffix, ModelNodeIDToSuffix is the reverse lookup.
+  // Suffixes above MAXIMUM_DIRECTLY_INDEXED_SUFFIX (e.g. from an edited scene file) are kept
+  // in SparsePointsPathPairIndex instead, so that they do not allocate a huge vector.
+  // Both are updated whenever a points/path reference role changes.
+  struct IndexedModelNode
+  {
+    std::string ReferenceRole;
+    std::string NodeID;
+    vtkWeakPointer< vtkMRMLModelNode > Node;
+  };
+  // Cached summary of the points of a path, see GetPathCentroid etc.
+  // It is up to date if the points/path data and path node are unchanged since it was computed.
+  struct PathDescriptor
+  {
+    bool Computed;
+    vtkPolyData* PointsPolyData; // only compared, never dereferenced
+    vtkMTimeType PointsPolyDataMTime;
+    vtkPolyData* PathPolyData; // only compared, never dereferenced
+    vtkMTimeType PathPolyDataMTime;
+    vtkMTimeType PathNodeMTime;
+
+    int NumberOfPoints;
+    double Centroid[ 3 ];
+    double Bounds[ 6 ];
+    double FirstPoint[ 3 ];
+    double LastPoint[ 3 ];
+    double PrincipalDirection[ 3 ];
+    double ArcLength;
+  };
+  struct IndexedPointsPathPair
+  {
+    bool Valid;
+    IndexedModelNode Points;
+    IndexedModelNode Path;
+    PathDescriptor Descriptor;
+    vtkMTimeType PointsReadMTime; // of the points data when ReadPackedPoints set it, 0 if it was not read
+  };
+  std::vector< IndexedPointsPathPair > PointsPathPairIndex;
+  std::unordered_map< int, IndexedPointsPathPair > SparsePointsPathPairIndex;
+  std::unordered_map< std::string, int > ModelNodeIDToSuffix;
+
+  void RebuildPointsPathPairIndex();
+  // Returns the added entry, NULL if the suffix cannot be indexed
+  IndexedPointsPathPair* AddSuffixToIndex( int suffix );
+  // Returns NULL if the suffix is not indexed
+  IndexedPointsPathPair* FindIndexedPointsPathPair( int suffix );
+  void RemoveSuffixFromIndex( int suffix );
+  void SetIndexedModelNode( IndexedModelNode& indexedModelNode, int suffix, const char* nodeID, vtkMRMLNode* node );
+  void UpdateIndexFromReference( vtkMRMLNodeReference* reference, bool removed );
+  vtkMRMLModelNode* GetIndexedModelNode( IndexedModelNode& indexedModelNode );
+
+
+  // returns NULL if the suffix is unknown or the path has no points
+  const PathDescriptor* GetPathDescriptor( int suffix );
+  static void ComputePathDescriptor( vtkPolyData* pointsPolyData, vtkMRMLModelNode* pathNode, PathDescriptor& descriptor );
+
+  // Cached combination of the path models, see GetCombinedPathPolyData.
+  // It is up to date if the list of path data and their modified times are unchanged.
+  std::vector< std::pair< vtkPolyData*, vtkMTimeType > > CombinedPathInputs; // only compared, never dereferenced
+  vtkSmartPointer< vtkPolyData > CombinedPathPolyData;
+  vtkSmartPointer< vtkStaticPointLocator > CombinedPathPointLocator;
+  void UpdateCombinedPath();
+
   // helper to avoid duplicates in the list. Duplicates should never occur.
   bool IsModelNodeBeingObserved( const char* nodeID );
 
   // helper to get node ID's that have prefix+suffix
   std::string GetNodeReferenceRole( const char* prefix, int suffix );
 
-  // update the reference roles from older versions
+  // update the reference roles from older versions.
+  // This is done once after the node is read from file, rather than in every accessor.
+  bool PointsPathRolesMigrated;
+  void MigratePointsPathRolesIfNeeded();
+  void MigratePointsPathRoles();
   bool ArePointsPathRolesUsingBaseNameOnly();
   void FixPointsPathRolesUsingBaseNameOnly();
 };
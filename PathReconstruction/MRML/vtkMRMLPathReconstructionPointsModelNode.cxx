@@ -0,0 +1,40 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkMRMLPathReconstructionPointsModelNode.h"
+
+// vtk includes
+#include <vtkObjectFactory.h>
+
+//------------------------------------------------------------------------------
+vtkMRMLNodeNewMacro( vtkMRMLPathReconstructionPointsModelNode );
+
+//------------------------------------------------------------------------------
+vtkMRMLPathReconstructionPointsModelNode::vtkMRMLPathReconstructionPointsModelNode()
+{
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLPathReconstructionPointsModelNode::~vtkMRMLPathReconstructionPointsModelNode()
+{
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLStorageNode* vtkMRMLPathReconstructionPointsModelNode::CreateDefaultStorageNode()
+{
+  return NULL;
+}
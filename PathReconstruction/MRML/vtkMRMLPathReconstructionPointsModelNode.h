@@ -0,0 +1,49 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkMRMLPathReconstructionPointsModelNode_h
+#define __vtkMRMLPathReconstructionPointsModelNode_h
+
+// Slicer includes
+#include "vtkMRMLModelNode.h"
+
+#include "vtkSlicerPathReconstructionModuleMRMLExport.h"
+
+// Model node of the recorded points of a path. It has no storage node of its own:
+// its points are stored with all other paths of the vtkMRMLPathReconstructionNode
+// by vtkMRMLPathReconstructionStorageNode, and read back when the scene is loaded.
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_MRML_EXPORT vtkMRMLPathReconstructionPointsModelNode
+: public vtkMRMLModelNode
+{
+public:
+  static vtkMRMLPathReconstructionPointsModelNode* New();
+  vtkTypeMacro( vtkMRMLPathReconstructionPointsModelNode, vtkMRMLModelNode );
+
+  virtual vtkMRMLNode* CreateNodeInstance();
+  virtual const char* GetNodeTagName() { return "PathReconstructionPointsModel"; };
+
+  // Returns NULL, so that saving the scene does not add a storage node
+  virtual vtkMRMLStorageNode* CreateDefaultStorageNode();
+
+protected:
+  vtkMRMLPathReconstructionPointsModelNode();
+  virtual ~vtkMRMLPathReconstructionPointsModelNode();
+  vtkMRMLPathReconstructionPointsModelNode( const vtkMRMLPathReconstructionPointsModelNode& );
+  void operator=( const vtkMRMLPathReconstructionPointsModelNode& );
+};
+
+#endif
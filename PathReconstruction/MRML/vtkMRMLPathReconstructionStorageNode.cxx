@@ -0,0 +1,456 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkMRMLPathReconstructionStorageNode.h"
+
+// MRML includes
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLPathReconstructionNode.h"
+#include "vtkMRMLScene.h"
+
+// vtk includes
+#include <vtkByteSwap.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkIntArray.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
+
+// STD includes
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// Constants ------------------------------------------------------------------
+static const char PACKED_POINTS_MAGIC[ 8 ] = { 'P', 'R', 'P', 'O', 'I', 'N', 'T', 'S' };
+static const vtkTypeUInt32 PACKED_POINTS_VERSION = 1;
+static const vtkTypeUInt64 HEADER_SIZE = 32;
+static const vtkTypeUInt64 OFFSET_TABLE_ENTRY_SIZE = 32;
+
+//------------------------------------------------------------------------------
+// Number of bytes of the data of one path, padded so the next path starts 8-byte aligned
+static vtkTypeUInt64 GetPackedDataSize( unsigned int flags, vtkTypeUInt64 numberOfPoints )
+{
+  vtkTypeUInt64 dataSize = 3 * numberOfPoints * sizeof( double );
+  if ( flags & vtkMRMLPathReconstructionStorageNode::HasTimestamps )
+  {
+    dataSize += numberOfPoints * sizeof( float );
+  }
+  if ( flags & vtkMRMLPathReconstructionStorageNode::HasOrientations )
+  {
+    dataSize += 4 * numberOfPoints * sizeof( float );
+  }
+  return ( dataSize + 7 ) & ~( (vtkTypeUInt64)7 );
+}
+
+//------------------------------------------------------------------------------
+// Little endian reading and writing of the fixed size fields
+template< class ValueType >
+static void WriteLittleEndian( std::ostream& stream, const ValueType* values, size_t numberOfValues )
+{
+  vtkByteSwap::SwapLERangeWrite( values, numberOfValues, &stream );
+}
+
+//------------------------------------------------------------------------------
+template< class ValueType >
+static bool ReadLittleEndian( std::istream& stream, ValueType* values, size_t numberOfValues )
+{
+  stream.read( reinterpret_cast< char* >( values ), numberOfValues * sizeof( ValueType ) );
+  if ( !stream )
+  {
+    return false;
+  }
+  vtkByteSwap::SwapLERange( values, numberOfValues );
+  return true;
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLNodeNewMacro( vtkMRMLPathReconstructionStorageNode );
+
+//------------------------------------------------------------------------------
+vtkMRMLPathReconstructionStorageNode::vtkMRMLPathReconstructionStorageNode()
+{
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLPathReconstructionStorageNode::~vtkMRMLPathReconstructionStorageNode()
+{
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionStorageNode::PrintSelf( ostream& os, vtkIndent indent )
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << " PackedFileName=\"" << this->PackedFileName << "\"";
+  os << indent << " NumberOfPackedPaths=\"" << this->PackedPaths.size() << "\"";
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLPathReconstructionStorageNode::CanReadInReferenceNode( vtkMRMLNode* refNode )
+{
+  return ( refNode != NULL && refNode->IsA( "vtkMRMLPathReconstructionNode" ) );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionStorageNode::InitializeSupportedReadFileTypes()
+{
+  this->SupportedReadFileTypes->InsertNextValue( "Path Reconstruction Points (.pathpoints)" );
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLPathReconstructionStorageNode::InitializeSupportedWriteFileTypes()
+{
+  this->SupportedWriteFileTypes->InsertNextValue( "Path Reconstruction Points (.pathpoints)" );
+}
+
+//------------------------------------------------------------------------------
+const char* vtkMRMLPathReconstructionStorageNode::GetDefaultWriteFileExtension()
+{
+  return "pathpoints";
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLPathReconstructionStorageNode::HasPackedPoints( int suffix )
+{
+  return ( this->PackedPaths.find( suffix ) != this->PackedPaths.end() );
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLPathReconstructionStorageNode::ReadPackedPoints( int suffix, vtkPolyData* pointsPolyData )
+{
+  if ( pointsPolyData == NULL )
+  {
+    vtkErrorMacro( "Points polydata is null. Cannot read packed points." );
+    return false;
+  }
+
+  std::map< int, PackedPath >::iterator packedPathIterator = this->PackedPaths.find( suffix );
+  if ( packedPathIterator == this->PackedPaths.end() )
+  {
+    return false;
+  }
+  const PackedPath& packedPath = packedPathIterator->second;
+
+  std::ifstream file( this->PackedFileName.c_str(), std::ios::in | std::ios::binary );
+  if ( !file )
+  {
+    vtkErrorMacro( "Could not open " << this->PackedFileName << ". Cannot read points of path " << suffix << "." );
+    return false;
+  }
+  file.seekg( (std::streamoff)packedPath.DataPosition );
+
+  vtkIdType numberOfPoints = (vtkIdType)packedPath.NumberOfPoints;
+  vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints( numberOfPoints );
+  if ( numberOfPoints > 0 &&
+       !ReadLittleEndian( file, static_cast< double* >( points->GetVoidPointer( 0 ) ), 3 * numberOfPoints ) )
+  {
+    vtkErrorMacro( "Could not read points of path " << suffix << " from " << this->PackedFileName << "." );
+    return false;
+  }
+
+  vtkSmartPointer< vtkFloatArray > timestamps;
+  if ( packedPath.Flags & HasTimestamps )
+  {
+    timestamps = vtkSmartPointer< vtkFloatArray >::New();
+    timestamps->SetName( vtkMRMLPathReconstructionNode::GetPointTimestampArrayName() );
+    timestamps->SetNumberOfComponents( 1 );
+    timestamps->SetNumberOfTuples( numberOfPoints );
+    if ( numberOfPoints > 0 && !ReadLittleEndian( file, timestamps->GetPointer( 0 ), numberOfPoints ) )
+    {
+      vtkErrorMacro( "Could not read timestamps of path " << suffix << " from " << this->PackedFileName << "." );
+      return false;
+    }
+  }
+
+  vtkSmartPointer< vtkFloatArray > orientations;
+  if ( packedPath.Flags & HasOrientations )
+  {
+    orientations = vtkSmartPointer< vtkFloatArray >::New();
+    orientations->SetName( vtkMRMLPathReconstructionNode::GetPointOrientationArrayName() );
+    orientations->SetNumberOfComponents( 4 );
+    orientations->SetNumberOfTuples( numberOfPoints );
+    if ( numberOfPoints > 0 && !ReadLittleEndian( file, orientations->GetPointer( 0 ), 4 * numberOfPoints ) )
+    {
+      vtkErrorMacro( "Could not read orientations of path " << suffix << " from " << this->PackedFileName << "." );
+      return false;
+    }
+  }
+
+  // one vertex per point
+  vtkSmartPointer< vtkIdTypeArray > vertConnectivity = vtkSmartPointer< vtkIdTypeArray >::New();
+  vertConnectivity->SetNumberOfValues( 2 * numberOfPoints );
+  vtkIdType* vertIds = vertConnectivity->GetPointer( 0 );
+  for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    vertIds[ 2 * pointIndex + 0 ] = 1;
+    vertIds[ 2 * pointIndex + 1 ] = pointIndex;
+  }
+  vtkSmartPointer< vtkCellArray > verts = vtkSmartPointer< vtkCellArray >::New();
+  verts->SetCells( numberOfPoints, vertConnectivity );
+
+  pointsPolyData->Initialize();
+  pointsPolyData->SetPoints( points );
+  pointsPolyData->SetVerts( verts );
+  if ( timestamps != NULL )
+  {
+    pointsPolyData->GetPointData()->AddArray( timestamps );
+  }
+  if ( orientations != NULL )
+  {
+    pointsPolyData->GetPointData()->AddArray( orientations );
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLPathReconstructionStorageNode::ReadDataInternal( vtkMRMLNode* refNode )
+{
+  if ( !this->CanReadInReferenceNode( refNode ) )
+  {
+    vtkErrorMacro( "Reference node is not a path reconstruction node. Cannot read packed points." );
+    return 0;
+  }
+
+  std::string fullName = this->GetFullNameFromFileName();
+  if ( fullName.empty() )
+  {
+    vtkErrorMacro( "File name not specified. Cannot read packed points." );
+    return 0;
+  }
+
+  std::ifstream file( fullName.c_str(), std::ios::in | std::ios::binary );
+  if ( !file )
+  {
+    vtkErrorMacro( "Could not open " << fullName << ". Cannot read packed points." );
+    return 0;
+  }
+
+  // only the offset table is read here, see vtkMRMLPathReconstructionNode::ReadPackedPoints
+  file.seekg( 0, std::ios::end );
+  vtkTypeUInt64 fileSize = (vtkTypeUInt64)file.tellg();
+  file.seekg( 0, std::ios::beg );
+
+  char magic[ 8 ] = { 0 };
+  file.read( magic, 8 );
+  vtkTypeUInt32 versionAndNumberOfPaths[ 2 ] = { 0, 0 };
+  vtkTypeUInt64 offsetTablePosition = 0;
+  if ( !file || memcmp( magic, PACKED_POINTS_MAGIC, 8 ) != 0 ||
+       !ReadLittleEndian( file, versionAndNumberOfPaths, 2 ) ||
+       !ReadLittleEndian( file, &offsetTablePosition, 1 ) )
+  {
+    vtkErrorMacro( fullName << " is not a path reconstruction points file." );
+    return 0;
+  }
+  if ( versionAndNumberOfPaths[ 0 ] > PACKED_POINTS_VERSION )
+  {
+    vtkErrorMacro( fullName << " was written by a newer version (" << versionAndNumberOfPaths[ 0 ] << "). Cannot read packed points." );
+    return 0;
+  }
+
+  std::map< int, PackedPath > packedPaths;
+  file.seekg( (std::streamoff)offsetTablePosition );
+  for ( vtkTypeUInt32 pathIndex = 0; pathIndex < versionAndNumberOfPaths[ 1 ]; pathIndex++ )
+  {
+    vtkTypeInt32 suffix = 0;
+    vtkTypeUInt32 flags = 0;
+    vtkTypeUInt64 sizes[ 3 ] = { 0, 0, 0 }; // number of points, data position, reserved
+    if ( !ReadLittleEndian( file, &suffix, 1 ) || !ReadLittleEndian( file, &flags, 1 ) || !ReadLittleEndian( file, sizes, 3 ) )
+    {
+      vtkErrorMacro( "Offset table of " << fullName << " is truncated. Cannot read packed points." );
+      return 0;
+    }
+    // a corrupt entry must not make ReadPackedPoints allocate more than the file holds
+    if ( sizes[ 0 ] > fileSize / ( 3 * sizeof( double ) ) || sizes[ 1 ] > fileSize ||
+         GetPackedDataSize( flags, sizes[ 0 ] ) > fileSize - sizes[ 1 ] )
+    {
+      vtkErrorMacro( "Points of path " << suffix << " do not fit in " << fullName << ". Cannot read packed points." );
+      return 0;
+    }
+    PackedPath packedPath;
+    packedPath.Flags = flags;
+    packedPath.NumberOfPoints = sizes[ 0 ];
+    packedPath.DataPosition = sizes[ 1 ];
+    packedPaths[ suffix ] = packedPath;
+  }
+
+  this->PackedPaths = packedPaths;
+  this->PackedFileName = fullName;
+
+  // During an import the points models may not be in the scene yet, the logic reads the points when it ends
+  vtkMRMLScene* scene = refNode->GetScene();
+  if ( scene == NULL || !scene->IsImporting() )
+  {
+    vtkMRMLPathReconstructionNode::SafeDownCast( refNode )->ReadPackedPoints();
+  }
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLPathReconstructionStorageNode::WriteDataInternal( vtkMRMLNode* refNode )
+{
+  vtkMRMLPathReconstructionNode* pathsNode = vtkMRMLPathReconstructionNode::SafeDownCast( refNode );
+  if ( pathsNode == NULL )
+  {
+    vtkErrorMacro( "Reference node is not a path reconstruction node. Cannot write packed points." );
+    return 0;
+  }
+
+  std::string fullName = this->GetFullNameFromFileName();
+  if ( fullName.empty() )
+  {
+    vtkErrorMacro( "File name not specified. Cannot write packed points." );
+    return 0;
+  }
+
+  // Read any points not yet read from the previous file first, it may be the file that is about to be overwritten
+  pathsNode->ReadPackedPoints();
+  std::vector< int > suffixes;
+  std::vector< vtkPolyData* > pointsPolyDatas;
+  vtkSmartPointer< vtkIntArray > allSuffixes = vtkSmartPointer< vtkIntArray >::New();
+  pathsNode->GetSuffixes( allSuffixes );
+  for ( vtkIdType suffixIndex = 0; suffixIndex < allSuffixes->GetNumberOfTuples(); suffixIndex++ )
+  {
+    int suffix = allSuffixes->GetValue( suffixIndex );
+    vtkMRMLModelNode* pointsModelNode = pathsNode->GetPointsModelNodeBySuffix( suffix );
+    if ( pointsModelNode == NULL || pointsModelNode->GetPolyData() == NULL || pointsModelNode->GetPolyData()->GetPoints() == NULL )
+    {
+      continue;
+    }
+    suffixes.push_back( suffix );
+    pointsPolyDatas.push_back( pointsModelNode->GetPolyData() );
+  }
+
+  std::map< int, PackedPath > packedPaths;
+  vtkTypeUInt64 dataPosition = HEADER_SIZE + OFFSET_TABLE_ENTRY_SIZE * suffixes.size();
+  for ( size_t pathIndex = 0; pathIndex < suffixes.size(); pathIndex++ )
+  {
+    vtkPolyData* pointsPolyData = pointsPolyDatas[ pathIndex ];
+    PackedPath packedPath;
+    packedPath.Flags = 0;
+    packedPath.NumberOfPoints = (vtkTypeUInt64)pointsPolyData->GetNumberOfPoints();
+    packedPath.DataPosition = dataPosition;
+    vtkDataArray* timestamps = pointsPolyData->GetPointData()->GetArray( vtkMRMLPathReconstructionNode::GetPointTimestampArrayName() );
+    if ( timestamps != NULL && timestamps->GetNumberOfComponents() == 1 && timestamps->GetNumberOfTuples() == pointsPolyData->GetNumberOfPoints() )
+    {
+      packedPath.Flags |= HasTimestamps;
+    }
+    vtkDataArray* orientations = pointsPolyData->GetPointData()->GetArray( vtkMRMLPathReconstructionNode::GetPointOrientationArrayName() );
+    if ( orientations != NULL && orientations->GetNumberOfComponents() == 4 && orientations->GetNumberOfTuples() == pointsPolyData->GetNumberOfPoints() )
+    {
+      packedPath.Flags |= HasOrientations;
+    }
+    dataPosition += GetPackedDataSize( packedPath.Flags, packedPath.NumberOfPoints );
+    packedPaths[ suffixes[ pathIndex ] ] = packedPath;
+  }
+
+  std::ofstream file( fullName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+  if ( !file )
+  {
+    vtkErrorMacro( "Could not open " << fullName << " for writing. Cannot write packed points." );
+    return 0;
+  }
+
+  // header
+  file.write( PACKED_POINTS_MAGIC, 8 );
+  vtkTypeUInt32 versionAndNumberOfPaths[ 2 ] = { PACKED_POINTS_VERSION, (vtkTypeUInt32)suffixes.size() };
+  WriteLittleEndian( file, versionAndNumberOfPaths, 2 );
+  vtkTypeUInt64 offsetTablePositionAndReserved[ 2 ] = { HEADER_SIZE, 0 };
+  WriteLittleEndian( file, offsetTablePositionAndReserved, 2 );
+
+  // offset table
+  for ( size_t pathIndex = 0; pathIndex < suffixes.size(); pathIndex++ )
+  {
+    const PackedPath& packedPath = packedPaths[ suffixes[ pathIndex ] ];
+    vtkTypeInt32 suffix = suffixes[ pathIndex ];
+    vtkTypeUInt32 flags = packedPath.Flags;
+    vtkTypeUInt64 sizes[ 3 ] = { packedPath.NumberOfPoints, packedPath.DataPosition, 0 };
+    WriteLittleEndian( file, &suffix, 1 );
+    WriteLittleEndian( file, &flags, 1 );
+    WriteLittleEndian( file, sizes, 3 );
+  }
+
+  // data, in the order of the offset table
+  std::vector< double > values;
+  std::vector< float > sampleValues;
+  for ( size_t pathIndex = 0; pathIndex < suffixes.size(); pathIndex++ )
+  {
+    vtkPolyData* pointsPolyData = pointsPolyDatas[ pathIndex ];
+    const PackedPath& packedPath = packedPaths[ suffixes[ pathIndex ] ];
+    vtkIdType numberOfPoints = (vtkIdType)packedPath.NumberOfPoints;
+    if ( numberOfPoints == 0 )
+    {
+      continue;
+    }
+
+    values.resize( 3 * numberOfPoints );
+    for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+    {
+      pointsPolyData->GetPoint( pointIndex, &values[ 3 * pointIndex ] );
+    }
+    WriteLittleEndian( file, &values[ 0 ], values.size() );
+
+    if ( packedPath.Flags & HasTimestamps )
+    {
+      vtkDataArray* timestamps = pointsPolyData->GetPointData()->GetArray( vtkMRMLPathReconstructionNode::GetPointTimestampArrayName() );
+      sampleValues.resize( numberOfPoints );
+      for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+      {
+        sampleValues[ pointIndex ] = (float)timestamps->GetComponent( pointIndex, 0 );
+      }
+      WriteLittleEndian( file, &sampleValues[ 0 ], sampleValues.size() );
+    }
+
+    if ( packedPath.Flags & HasOrientations )
+    {
+      vtkDataArray* orientations = pointsPolyData->GetPointData()->GetArray( vtkMRMLPathReconstructionNode::GetPointOrientationArrayName() );
+      sampleValues.resize( 4 * numberOfPoints );
+      for ( vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+      {
+        for ( int component = 0; component < 4; component++ )
+        {
+          sampleValues[ 4 * pointIndex + component ] = (float)orientations->GetComponent( pointIndex, component );
+        }
+      }
+      WriteLittleEndian( file, &sampleValues[ 0 ], sampleValues.size() );
+    }
+
+    // pad to the start of the next path
+    vtkTypeUInt64 paddedEnd = packedPath.DataPosition + GetPackedDataSize( packedPath.Flags, packedPath.NumberOfPoints );
+    while ( (vtkTypeUInt64)file.tellp() < paddedEnd )
+    {
+      file.put( 0 );
+    }
+  }
+
+  file.close();
+  if ( !file )
+  {
+    vtkErrorMacro( "Could not write " << fullName << "." );
+    return 0;
+  }
+
+  this->PackedPaths = packedPaths;
+  this->PackedFileName = fullName;
+  return 1;
+}
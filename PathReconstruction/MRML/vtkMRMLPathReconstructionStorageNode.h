@@ -0,0 +1,95 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkMRMLPathReconstructionStorageNode_h
+#define __vtkMRMLPathReconstructionStorageNode_h
+
+// Slicer includes
+#include "vtkMRMLStorageNode.h"
+
+class vtkPolyData;
+
+// STD includes
+#include <map>
+#include <string>
+
+#include "vtkSlicerPathReconstructionModuleMRMLExport.h"
+
+// Stores the recorded points of every path of a vtkMRMLPathReconstructionNode in one binary file.
+//
+// File layout (little endian, all sections 8-byte aligned so the file can be memory mapped):
+//   header:       char[8] "PRPOINTS", uint32 version, uint32 number of paths, uint64 offset table position, uint64 reserved
+//   offset table: per path, int32 suffix, uint32 flags, uint64 number of points, uint64 data position, uint64 reserved
+//   data:         per path, double xyz[ 3n ], then float timestamps[ n ] if flags has HasTimestamps,
+//                 then float orientation quaternions (wxyz)[ 4n ] if flags has HasOrientations,
+//                 then zero padding to the next multiple of 8 bytes
+//
+// Reading loads the offset table. The points are then set on the points models by
+// vtkMRMLPathReconstructionNode::ReadPackedPoints, once the points models are in the scene.
+class VTK_SLICER_PATHRECONSTRUCTION_MODULE_MRML_EXPORT vtkMRMLPathReconstructionStorageNode
+: public vtkMRMLStorageNode
+{
+public:
+  enum PathFlags
+  {
+    HasTimestamps = 1,
+    HasOrientations = 2
+  };
+
+  static vtkMRMLPathReconstructionStorageNode* New();
+  vtkTypeMacro( vtkMRMLPathReconstructionStorageNode, vtkMRMLStorageNode );
+  void PrintSelf( ostream& os, vtkIndent indent );
+
+  virtual vtkMRMLNode* CreateNodeInstance();
+  virtual const char* GetNodeTagName() { return "PathReconstructionStorage"; };
+
+  virtual bool CanReadInReferenceNode( vtkMRMLNode* refNode );
+
+  // Whether the file that was last read or written has points for the suffix
+  bool HasPackedPoints( int suffix );
+
+  // Read the points (and timestamps and orientations, if stored) of one path from the
+  // file that was last read or written. Returns false if they could not be read.
+  bool ReadPackedPoints( int suffix, vtkPolyData* pointsPolyData );
+
+protected:
+  vtkMRMLPathReconstructionStorageNode();
+  virtual ~vtkMRMLPathReconstructionStorageNode();
+  vtkMRMLPathReconstructionStorageNode( const vtkMRMLPathReconstructionStorageNode& );
+  void operator=( const vtkMRMLPathReconstructionStorageNode& );
+
+  virtual void InitializeSupportedReadFileTypes();
+  virtual void InitializeSupportedWriteFileTypes();
+  virtual const char* GetDefaultWriteFileExtension();
+
+  virtual int ReadDataInternal( vtkMRMLNode* refNode );
+  virtual int WriteDataInternal( vtkMRMLNode* refNode );
+
+private:
+  struct PackedPath
+  {
+    unsigned int Flags;
+    vtkTypeUInt64 NumberOfPoints;
+    vtkTypeUInt64 DataPosition;
+  };
+
+  // offset table of PackedFileName, by suffix
+  std::map< int, PackedPath > PackedPaths;
+  std::string PackedFileName;
+};
+
+#endif
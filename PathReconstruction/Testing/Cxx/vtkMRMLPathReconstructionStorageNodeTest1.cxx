@@ -0,0 +1,229 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Write the points of two paths to a packed file, one with timestamps and orientations
+// and one without, and read them into another scene. A truncated copy of the file must be rejected.
+// Usage: vtkMRMLPathReconstructionStorageNodeTest1 temporaryDirectory
+
+// PathReconstruction includes
+#include "vtkMRMLPathReconstructionNode.h"
+#include "vtkMRMLPathReconstructionPointsModelNode.h"
+#include "vtkMRMLPathReconstructionStorageNode.h"
+
+// MRML includes
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScene.h>
+
+// vtk includes
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const int NUMBER_OF_POINTS = 10;
+
+//------------------------------------------------------------------------------
+vtkSmartPointer< vtkPolyData > CreatePointsPolyData( bool withSampleArrays )
+{
+  vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
+  vtkSmartPointer< vtkCellArray > verts = vtkSmartPointer< vtkCellArray >::New();
+  vtkSmartPointer< vtkFloatArray > timestamps = vtkSmartPointer< vtkFloatArray >::New();
+  timestamps->SetName( vtkMRMLPathReconstructionNode::GetPointTimestampArrayName() );
+  vtkSmartPointer< vtkFloatArray > orientations = vtkSmartPointer< vtkFloatArray >::New();
+  orientations->SetName( vtkMRMLPathReconstructionNode::GetPointOrientationArrayName() );
+  orientations->SetNumberOfComponents( 4 );
+  for ( int pointIndex = 0; pointIndex < NUMBER_OF_POINTS; pointIndex++ )
+  {
+    vtkIdType pointId = points->InsertNextPoint( pointIndex, 2.0 * pointIndex, -0.5 * pointIndex );
+    verts->InsertNextCell( 1, &pointId );
+    timestamps->InsertNextValue( 0.1f * pointIndex );
+    orientations->InsertNextTuple4( 1.0, 0.0, 0.0, 0.01 * pointIndex );
+  }
+
+  vtkSmartPointer< vtkPolyData > polyData = vtkSmartPointer< vtkPolyData >::New();
+  polyData->SetPoints( points );
+  polyData->SetVerts( verts );
+  if ( withSampleArrays )
+  {
+    polyData->GetPointData()->AddArray( timestamps );
+    polyData->GetPointData()->AddArray( orientations );
+  }
+  return polyData;
+}
+
+//------------------------------------------------------------------------------
+// Path reconstruction node with numberOfPaths pairs of points (without data) and path models,
+// and a storage node for fileName
+vtkMRMLPathReconstructionNode* AddPathsNode( vtkMRMLScene* scene, int numberOfPaths, const std::string& fileName )
+{
+  vtkSmartPointer< vtkMRMLPathReconstructionNode > pathsNode = vtkSmartPointer< vtkMRMLPathReconstructionNode >::New();
+  scene->AddNode( pathsNode );
+  for ( int pathIndex = 0; pathIndex < numberOfPaths; pathIndex++ )
+  {
+    vtkSmartPointer< vtkMRMLPathReconstructionPointsModelNode > pointsNode = vtkSmartPointer< vtkMRMLPathReconstructionPointsModelNode >::New();
+    scene->AddNode( pointsNode );
+    vtkSmartPointer< vtkMRMLModelNode > pathNode = vtkSmartPointer< vtkMRMLModelNode >::New();
+    scene->AddNode( pathNode );
+    pathsNode->AddPointsPathPairModelNodeIDs( pointsNode->GetID(), pathNode->GetID() );
+  }
+  vtkSmartPointer< vtkMRMLPathReconstructionStorageNode > storageNode = vtkSmartPointer< vtkMRMLPathReconstructionStorageNode >::New();
+  storageNode->SetFileName( fileName.c_str() );
+  scene->AddNode( storageNode );
+  pathsNode->SetAndObserveStorageNodeID( storageNode->GetID() );
+  return pathsNode;
+}
+
+//------------------------------------------------------------------------------
+bool CheckPoints( vtkPolyData* polyData, bool withSampleArrays, const char* description )
+{
+  if ( polyData == NULL || polyData->GetNumberOfPoints() != NUMBER_OF_POINTS || polyData->GetNumberOfVerts() != NUMBER_OF_POINTS )
+  {
+    std::cerr << description << ": expected " << NUMBER_OF_POINTS << " points and vertices." << std::endl;
+    return false;
+  }
+  vtkSmartPointer< vtkPolyData > expected = CreatePointsPolyData( true );
+  vtkFloatArray* expectedTimestamps = vtkFloatArray::SafeDownCast( expected->GetPointData()->GetArray( vtkMRMLPathReconstructionNode::GetPointTimestampArrayName() ) );
+  vtkFloatArray* expectedOrientations = vtkFloatArray::SafeDownCast( expected->GetPointData()->GetArray( vtkMRMLPathReconstructionNode::GetPointOrientationArrayName() ) );
+  vtkFloatArray* timestamps = vtkFloatArray::SafeDownCast( polyData->GetPointData()->GetArray( vtkMRMLPathReconstructionNode::GetPointTimestampArrayName() ) );
+  vtkFloatArray* orientations = vtkFloatArray::SafeDownCast( polyData->GetPointData()->GetArray( vtkMRMLPathReconstructionNode::GetPointOrientationArrayName() ) );
+  if ( ( timestamps != NULL ) != withSampleArrays || ( orientations != NULL ) != withSampleArrays )
+  {
+    std::cerr << description << ": timestamps and orientations should " << ( withSampleArrays ? "" : "not " ) << "be present." << std::endl;
+    return false;
+  }
+
+  for ( vtkIdType pointIndex = 0; pointIndex < NUMBER_OF_POINTS; pointIndex++ )
+  {
+    double point[ 3 ] = { 0.0, 0.0, 0.0 };
+    double expectedPoint[ 3 ] = { 0.0, 0.0, 0.0 };
+    polyData->GetPoint( pointIndex, point );
+    expected->GetPoint( pointIndex, expectedPoint );
+    if ( point[ 0 ] != expectedPoint[ 0 ] || point[ 1 ] != expectedPoint[ 1 ] || point[ 2 ] != expectedPoint[ 2 ] )
+    {
+      std::cerr << description << ": point " << pointIndex << " differs." << std::endl;
+      return false;
+    }
+    if ( !withSampleArrays )
+    {
+      continue;
+    }
+    if ( timestamps->GetValue( pointIndex ) != expectedTimestamps->GetValue( pointIndex ) )
+    {
+      std::cerr << description << ": timestamp " << pointIndex << " differs." << std::endl;
+      return false;
+    }
+    for ( int component = 0; component < 4; component++ )
+    {
+      if ( orientations->GetComponent( pointIndex, component ) != expectedOrientations->GetComponent( pointIndex, component ) )
+      {
+        std::cerr << description << ": orientation " << pointIndex << " differs." << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLPathReconstructionStorageNodeTest1( int argc, char* argv[] )
+{
+  if ( argc < 2 )
+  {
+    std::cerr << "Usage: vtkMRMLPathReconstructionStorageNodeTest1 temporaryDirectory" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string fileName = std::string( argv[ 1 ] ) + "/vtkMRMLPathReconstructionStorageNodeTest1.pathpoints";
+  std::string truncatedFileName = std::string( argv[ 1 ] ) + "/vtkMRMLPathReconstructionStorageNodeTest1Truncated.pathpoints";
+
+  // write
+  vtkNew< vtkMRMLScene > writeScene;
+  vtkMRMLPathReconstructionNode* writePathsNode = AddPathsNode( writeScene.GetPointer(), 2, fileName );
+  writePathsNode->GetPointsModelNodeBySuffix( 0 )->SetAndObservePolyData( CreatePointsPolyData( true ) );
+  writePathsNode->GetPointsModelNodeBySuffix( 1 )->SetAndObservePolyData( CreatePointsPolyData( false ) );
+  if ( !writePathsNode->GetStorageNode()->WriteData( writePathsNode ) )
+  {
+    std::cerr << "Could not write " << fileName << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // read into points models without data
+  vtkNew< vtkMRMLScene > readScene;
+  vtkMRMLPathReconstructionNode* readPathsNode = AddPathsNode( readScene.GetPointer(), 2, fileName );
+  if ( !readPathsNode->GetStorageNode()->ReadData( readPathsNode ) )
+  {
+    std::cerr << "Could not read " << fileName << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if ( !CheckPoints( readPathsNode->GetPointsModelNodeBySuffix( 0 )->GetPolyData(), true, "Path with timestamps and orientations" ) ||
+       !CheckPoints( readPathsNode->GetPointsModelNodeBySuffix( 1 )->GetPolyData(), false, "Path without timestamps and orientations" ) )
+  {
+    return EXIT_FAILURE;
+  }
+  if ( readPathsNode->GetModifiedSinceRead() )
+  {
+    std::cerr << "Points that were just read are reported as modified." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // keep the header and offset table, but only part of the data
+  std::vector< char > contents;
+  {
+    std::ifstream file( fileName.c_str(), std::ios::in | std::ios::binary );
+    contents.assign( std::istreambuf_iterator< char >( file ), std::istreambuf_iterator< char >() );
+  }
+  const size_t truncatedSize = 32 + 2 * 32 + 16;
+  if ( contents.size() <= truncatedSize )
+  {
+    std::cerr << fileName << " is only " << contents.size() << " bytes." << std::endl;
+    return EXIT_FAILURE;
+  }
+  {
+    std::ofstream file( truncatedFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    file.write( &contents[ 0 ], truncatedSize );
+  }
+
+  vtkNew< vtkMRMLScene > truncatedScene;
+  vtkMRMLPathReconstructionNode* truncatedPathsNode = AddPathsNode( truncatedScene.GetPointer(), 2, truncatedFileName );
+  if ( truncatedPathsNode->GetStorageNode()->ReadData( truncatedPathsNode ) )
+  {
+    std::cerr << "Truncated file " << truncatedFileName << " was read." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if ( truncatedPathsNode->GetPointsModelNodeBySuffix( 0 )->GetPolyData() != NULL )
+  {
+    std::cerr << "Points were set from the truncated file." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
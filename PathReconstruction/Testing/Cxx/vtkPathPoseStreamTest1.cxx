@@ -0,0 +1,146 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Write poses to a file and read them back. A file whose header claims more poses
+// than the file holds must be rejected, and leave the poses that were read before.
+// Usage: vtkPathPoseStreamTest1 temporaryDirectory
+
+// PathReconstruction includes
+#include "vtkPathPoseStream.h"
+
+// vtk includes
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+
+const int NUMBER_OF_POSES = 5;
+
+//------------------------------------------------------------------------------
+void SetPoseMatrix( int poseIndex, vtkMatrix4x4* matrix )
+{
+  matrix->Identity();
+  matrix->SetElement( 0, 3, 1.5 * poseIndex );
+  matrix->SetElement( 1, 3, -2.0 * poseIndex );
+  matrix->SetElement( 2, 3, 100.0 + poseIndex );
+  matrix->SetElement( 0, 1, 0.25 );
+}
+
+}
+
+//------------------------------------------------------------------------------
+int vtkPathPoseStreamTest1( int argc, char* argv[] )
+{
+  if ( argc < 2 )
+  {
+    std::cerr << "Usage: vtkPathPoseStreamTest1 temporaryDirectory" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string fileName = std::string( argv[ 1 ] ) + "/vtkPathPoseStreamTest1.poses";
+  std::string badCountFileName = std::string( argv[ 1 ] ) + "/vtkPathPoseStreamTest1BadCount.poses";
+
+  vtkNew< vtkPathPoseStream > writeStream;
+  vtkNew< vtkMatrix4x4 > matrix;
+  for ( int poseIndex = 0; poseIndex < NUMBER_OF_POSES; poseIndex++ )
+  {
+    SetPoseMatrix( poseIndex, matrix.GetPointer() );
+    writeStream->AddPose( 0.02 * poseIndex, poseIndex % 2, poseIndex / 3, matrix.GetPointer() );
+  }
+  if ( !writeStream->WriteFile( fileName.c_str() ) )
+  {
+    std::cerr << "Could not write " << fileName << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew< vtkPathPoseStream > readStream;
+  if ( !readStream->ReadFile( fileName.c_str() ) )
+  {
+    std::cerr << "Could not read " << fileName << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if ( readStream->GetNumberOfPoses() != NUMBER_OF_POSES )
+  {
+    std::cerr << "Read " << readStream->GetNumberOfPoses() << " poses, expected " << NUMBER_OF_POSES << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+  vtkNew< vtkMatrix4x4 > readMatrix;
+  for ( int poseIndex = 0; poseIndex < NUMBER_OF_POSES; poseIndex++ )
+  {
+    if ( readStream->GetPoseTimestamp( poseIndex ) != writeStream->GetPoseTimestamp( poseIndex ) ||
+         readStream->GetPoseChannel( poseIndex ) != poseIndex % 2 ||
+         readStream->GetPoseSegment( poseIndex ) != poseIndex / 3 )
+    {
+      std::cerr << "Timestamp, channel or segment of pose " << poseIndex << " differs." << std::endl;
+      return EXIT_FAILURE;
+    }
+    SetPoseMatrix( poseIndex, matrix.GetPointer() );
+    readStream->GetPoseMatrix( poseIndex, readMatrix.GetPointer() );
+    for ( int row = 0; row < 4; row++ )
+    {
+      for ( int column = 0; column < 4; column++ )
+      {
+        if ( readMatrix->GetElement( row, column ) != matrix->GetElement( row, column ) )
+        {
+          std::cerr << "Matrix of pose " << poseIndex << " differs." << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+
+  // the number of poses is the uint64 after the magic, version and reserved fields
+  std::string contents;
+  {
+    std::ifstream file( fileName.c_str(), std::ios::in | std::ios::binary );
+    contents.assign( std::istreambuf_iterator< char >( file ), std::istreambuf_iterator< char >() );
+  }
+  const size_t numberOfPosesPosition = 16;
+  if ( contents.size() < numberOfPosesPosition + 8 )
+  {
+    std::cerr << fileName << " is only " << contents.size() << " bytes." << std::endl;
+    return EXIT_FAILURE;
+  }
+  for ( int byteIndex = 0; byteIndex < 8; byteIndex++ )
+  {
+    contents[ numberOfPosesPosition + byteIndex ] = ( byteIndex < 6 ) ? (char)0xFF : 0; // little endian, about 2^48 poses
+  }
+  {
+    std::ofstream file( badCountFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    file.write( contents.data(), contents.size() );
+  }
+
+  if ( readStream->ReadFile( badCountFileName.c_str() ) )
+  {
+    std::cerr << "File with a bad number of poses " << badCountFileName << " was read." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if ( readStream->GetNumberOfPoses() != NUMBER_OF_POSES )
+  {
+    std::cerr << "A failed read changed the poses." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
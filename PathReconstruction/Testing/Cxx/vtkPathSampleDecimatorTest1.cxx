@@ -0,0 +1,104 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Kept and dropped sample counts of the decimator with its default parameters
+// (minimum distance 0.25 mm, maximum distance 5 mm, minimum speed 0.5 mm/s, maximum angle 5 degrees)
+// on a straight line, a pause and a bend.
+
+// PathReconstruction includes
+#include "vtkPathSampleDecimator.h"
+
+// vtk includes
+#include <vtkNew.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+void AddSample( vtkPathSampleDecimator* decimator, double timestamp, double x, double y )
+{
+  double position[ 3 ] = { x, y, 0.0 };
+  decimator->AcceptSample( timestamp, position );
+}
+
+//------------------------------------------------------------------------------
+bool CheckCounts( vtkPathSampleDecimator* decimator, vtkIdType expectedKept, vtkIdType expectedDropped, const char* description )
+{
+  if ( decimator->GetNumberOfKeptSamples() != expectedKept || decimator->GetNumberOfDroppedSamples() != expectedDropped )
+  {
+    std::cerr << description << ": kept " << decimator->GetNumberOfKeptSamples() << " and dropped " << decimator->GetNumberOfDroppedSamples()
+              << " samples, expected " << expectedKept << " and " << expectedDropped << "." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+int vtkPathSampleDecimatorTest1( int vtkNotUsed( argc ), char* vtkNotUsed( argv )[] )
+{
+  vtkNew< vtkPathSampleDecimator > decimator;
+
+  // Straight line, 1 mm every 0.1 s from x = 0 to 20. The first two samples are kept,
+  // then every sample 5 mm from the last kept one: x = 0, 1, 6, 11, 16.
+  for ( int sampleIndex = 0; sampleIndex <= 20; sampleIndex++ )
+  {
+    AddSample( decimator.GetPointer(), 0.1 * sampleIndex, sampleIndex, 0.0 );
+  }
+  if ( !CheckCounts( decimator.GetPointer(), 5, 16, "Straight line" ) )
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Pause after two samples: 5 samples closer than the minimum distance,
+  // then 10 samples 0.3 mm away, 1 s apart, so slower than the minimum speed.
+  decimator->Reset();
+  AddSample( decimator.GetPointer(), 0.0, 0.0, 0.0 );
+  AddSample( decimator.GetPointer(), 0.1, 1.0, 0.0 );
+  for ( int sampleIndex = 0; sampleIndex < 5; sampleIndex++ )
+  {
+    AddSample( decimator.GetPointer(), 0.2 + 0.1 * sampleIndex, 1.1, 0.0 );
+  }
+  for ( int sampleIndex = 0; sampleIndex < 10; sampleIndex++ )
+  {
+    AddSample( decimator.GetPointer(), 1.1 + sampleIndex, 1.3, 0.0 );
+  }
+  if ( !CheckCounts( decimator.GetPointer(), 2, 15, "Pause" ) )
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Bend: along x, then a 90 degree turn along y. The first sample after the turn is kept,
+  // the following ones continue in the new direction and are dropped.
+  decimator->Reset();
+  AddSample( decimator.GetPointer(), 0.0, 0.0, 0.0 );
+  AddSample( decimator.GetPointer(), 0.1, 1.0, 0.0 );
+  AddSample( decimator.GetPointer(), 0.2, 1.0, 1.0 );
+  AddSample( decimator.GetPointer(), 0.3, 1.0, 2.0 );
+  AddSample( decimator.GetPointer(), 0.4, 1.0, 3.0 );
+  if ( !CheckCounts( decimator.GetPointer(), 3, 2, "Bend" ) )
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Outlier rejection (Hampel test, window of 7, threshold 3) on a straight line with a single spike.
+// Only the spike is rejected, and the other samples pass through unchanged.
+
+// PathReconstruction includes
+#include "vtkPathSampleFilter.h"
+
+// vtk includes
+#include <vtkNew.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+//------------------------------------------------------------------------------
+int vtkPathSampleFilterTest1( int vtkNotUsed( argc ), char* vtkNotUsed( argv )[] )
+{
+  const int numberOfSamples = 20;
+  const int spikeIndex = 10;
+
+  vtkNew< vtkPathSampleFilter > filter;
+  filter->SetOutlierRejection( true );
+  filter->SetOutlierWindowSize( 7 );
+  filter->SetOutlierThreshold( 3.0 );
+  filter->SetSmoothing( false );
+
+  // 0.1 mm apart along x, the spike is 20 mm off the line
+  for ( int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++ )
+  {
+    double position[ 3 ] = { 0.1 * sampleIndex, ( sampleIndex == spikeIndex ) ? 20.0 : 0.0, 0.0 };
+    double filteredPosition[ 3 ] = { 0.0, 0.0, 0.0 };
+    bool accepted = filter->FilterSample( 0.05 * sampleIndex, position, filteredPosition );
+    if ( accepted != ( sampleIndex != spikeIndex ) )
+    {
+      std::cerr << "Sample " << sampleIndex << " was " << ( accepted ? "accepted" : "rejected" ) << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if ( accepted && ( filteredPosition[ 0 ] != position[ 0 ] || filteredPosition[ 1 ] != position[ 1 ] || filteredPosition[ 2 ] != position[ 2 ] ) )
+    {
+      std::cerr << "Sample " << sampleIndex << " was changed without smoothing." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if ( filter->GetNumberOfRejectedSamples() != 1 )
+  {
+    std::cerr << "Rejected " << filter->GetNumberOfRejectedSamples() << " samples, expected 1." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  filter->Reset();
+  if ( filter->GetNumberOfRejectedSamples() != 0 )
+  {
+    std::cerr << "Reset did not clear the number of rejected samples." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
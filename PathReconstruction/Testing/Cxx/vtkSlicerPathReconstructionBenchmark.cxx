@@ -0,0 +1,539 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Benchmark of the PathReconstruction MRML and Logic kits on synthetic scenes.
+// Each repeat builds a new scene with N catheters of M samples each, recorded from a
+// simulated tracker, and times the operations listed in RunBenchmark. Results are
+// written as JSON (default) or CSV so they can be compared across releases.
+//
+// Usage:
+//   vtkSlicerPathReconstructionBenchmark [--catheters N] [--samples M] [--repeats R]
+//     [--samples-per-update K] [--lookups L] [--level-of-detail Polyline|CoarseTube|FullTube]
+//     [--output results.json|results.csv]
+
+// PathReconstruction includes
+#include "vtkMRMLPathReconstructionNode.h"
+#include "vtkSlicerPathReconstructionLogic.h"
+
+// MarkupsToModel includes
+#include "vtkMRMLMarkupsToModelNode.h"
+#include "vtkSlicerMarkupsToModelLogic.h"
+
+// CollectPoints includes
+#include "vtkMRMLCollectPointsNode.h"
+
+// MRML includes
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScene.h>
+
+// vtk includes
+#include <vtkIntArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkVersion.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+struct BenchmarkParameters
+{
+  BenchmarkParameters()
+  : NumberOfCatheters( 20 )
+  , NumberOfSamples( 500 )
+  , NumberOfRepeats( 3 )
+  , SamplesPerUpdate( 5 )
+  , NumberOfLookups( 100 )
+  , LiveLevelOfDetail( vtkMRMLPathReconstructionNode::LevelOfDetailCoarseTube )
+  {
+  }
+
+  int NumberOfCatheters;
+  int NumberOfSamples;
+  int NumberOfRepeats;
+  int SamplesPerUpdate; // samples that arrive between two ProcessPendingSamples calls
+  int NumberOfLookups; // sweeps over all suffixes
+  int LiveLevelOfDetail;
+  std::string OutputFileName;
+};
+
+//------------------------------------------------------------------------------
+// Elapsed time of each measurement of one operation. A measurement may cover
+// several operations (e.g., all samples of a catheter), then its time is divided evenly.
+struct BenchmarkTiming
+{
+  BenchmarkTiming()
+  : NumberOfOperations( 0 )
+  , TotalSeconds( 0.0 )
+  {
+  }
+
+  std::string Name;
+  long long NumberOfOperations;
+  double TotalSeconds;
+  std::vector< double > SecondsPerOperation;
+};
+
+//------------------------------------------------------------------------------
+class BenchmarkResults
+{
+public:
+  void Add( const std::string& name, double seconds, long long numberOfOperations = 1 )
+  {
+    if ( numberOfOperations <= 0 )
+    {
+      return;
+    }
+    BenchmarkTiming& timing = this->GetTiming( name );
+    timing.NumberOfOperations += numberOfOperations;
+    timing.TotalSeconds += seconds;
+    timing.SecondsPerOperation.push_back( seconds / numberOfOperations );
+  }
+
+  const std::vector< BenchmarkTiming >& GetTimings() const
+  {
+    return this->Timings;
+  }
+
+private:
+  BenchmarkTiming& GetTiming( const std::string& name )
+  {
+    for ( std::vector< BenchmarkTiming >::iterator timingIterator = this->Timings.begin(); timingIterator != this->Timings.end(); timingIterator++ )
+    {
+      if ( timingIterator->Name == name )
+      {
+        return *timingIterator;
+      }
+    }
+    // keep the order in which operations were first measured
+    this->Timings.push_back( BenchmarkTiming() );
+    this->Timings.back().Name = name;
+    return this->Timings.back();
+  }
+
+  std::vector< BenchmarkTiming > Timings;
+};
+
+//------------------------------------------------------------------------------
+// Tip position of the tracked wire: each catheter is a helix, offset from the others
+void GetSyntheticSamplePosition( int catheterIndex, int sampleIndex, double position[ 3 ] )
+{
+  const double helixRadiusMm = 2.0;
+  const double helixPitchMm = 0.5;
+  const double catheterSpacingMm = 10.0;
+  double angleRadians = 0.05 * sampleIndex;
+  position[ 0 ] = catheterSpacingMm * ( catheterIndex % 10 ) + helixRadiusMm * std::cos( angleRadians );
+  position[ 1 ] = catheterSpacingMm * ( catheterIndex / 10 ) + helixRadiusMm * std::sin( angleRadians );
+  position[ 2 ] = helixPitchMm * sampleIndex;
+}
+
+//------------------------------------------------------------------------------
+// Split the attributes written by WriteXML into the name/value list expected by ReadXMLAttributes
+void ParseXMLAttributes( const std::string& xml, std::vector< std::string >& attributes )
+{
+  attributes.clear();
+  size_t position = 0;
+  while ( true )
+  {
+    size_t equalsPosition = xml.find( "=\"", position );
+    if ( equalsPosition == std::string::npos )
+    {
+      return;
+    }
+    size_t nameStart = xml.find_last_of( " \t\n", equalsPosition );
+    nameStart = ( nameStart == std::string::npos ) ? 0 : nameStart + 1;
+    size_t valueStart = equalsPosition + 2;
+    size_t valueEnd = xml.find( '"', valueStart );
+    if ( valueEnd == std::string::npos )
+    {
+      return;
+    }
+    attributes.push_back( xml.substr( nameStart, equalsPosition - nameStart ) );
+    attributes.push_back( xml.substr( valueStart, valueEnd - valueStart ) );
+    position = valueEnd + 1;
+  }
+}
+
+//------------------------------------------------------------------------------
+void SetUpScene( vtkMRMLScene* scene, vtkSlicerPathReconstructionLogic* pathReconstructionLogic, vtkSlicerMarkupsToModelLogic* markupsToModelLogic )
+{
+  scene->RegisterNodeClass( vtkSmartPointer< vtkMRMLCollectPointsNode >::New() );
+  markupsToModelLogic->SetMRMLScene( scene );
+  pathReconstructionLogic->SetMRMLScene( scene );
+}
+
+//------------------------------------------------------------------------------
+void RunBenchmark( const BenchmarkParameters& parameters, BenchmarkResults& results )
+{
+  vtkSmartPointer< vtkMRMLScene > scene = vtkSmartPointer< vtkMRMLScene >::New();
+  // the MarkupsToModel logic generates the output of non-curve models and of serial refits
+  vtkSmartPointer< vtkSlicerMarkupsToModelLogic > markupsToModelLogic = vtkSmartPointer< vtkSlicerMarkupsToModelLogic >::New();
+  vtkSmartPointer< vtkSlicerPathReconstructionLogic > pathReconstructionLogic = vtkSmartPointer< vtkSlicerPathReconstructionLogic >::New();
+  SetUpScene( scene, pathReconstructionLogic, markupsToModelLogic );
+
+  vtkSmartPointer< vtkMRMLLinearTransformNode > samplingTransformNode = vtkSmartPointer< vtkMRMLLinearTransformNode >::New();
+  samplingTransformNode->SetName( "StylusTipToReference" );
+  scene->AddNode( samplingTransformNode );
+
+  vtkSmartPointer< vtkMRMLPathReconstructionNode > pathReconstructionNode = vtkSmartPointer< vtkMRMLPathReconstructionNode >::New();
+  scene->AddNode( pathReconstructionNode );
+  pathReconstructionNode->CreateDefaultCollectPointsNode();
+  pathReconstructionNode->CreateDefaultMarkupsToModelNode();
+  pathReconstructionNode->GetCollectPointsNode()->SetAndObserveSamplingTransformNodeID( samplingTransformNode->GetID() );
+  pathReconstructionNode->SetLiveLevelOfDetail( parameters.LiveLevelOfDetail );
+
+  vtkSmartPointer< vtkMatrix4x4 > samplingMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  double startSeconds = 0.0;
+
+  // record
+  for ( int catheterIndex = 0; catheterIndex < parameters.NumberOfCatheters; catheterIndex++ )
+  {
+    startSeconds = vtkTimerLog::GetUniversalTime();
+    pathReconstructionLogic->ToggleRecording( pathReconstructionNode );
+    results.Add( "StartRecording", vtkTimerLog::GetUniversalTime() - startSeconds );
+
+    double pushSeconds = 0.0;
+    double processSeconds = 0.0;
+    int numberOfProcessCalls = 0;
+    for ( int sampleIndex = 0; sampleIndex < parameters.NumberOfSamples; sampleIndex++ )
+    {
+      double position[ 3 ] = { 0.0, 0.0, 0.0 };
+      GetSyntheticSamplePosition( catheterIndex, sampleIndex, position );
+      samplingMatrix->SetElement( 0, 3, position[ 0 ] );
+      samplingMatrix->SetElement( 1, 3, position[ 1 ] );
+      samplingMatrix->SetElement( 2, 3, position[ 2 ] );
+
+      startSeconds = vtkTimerLog::GetUniversalTime();
+      samplingTransformNode->SetMatrixTransformToParent( samplingMatrix );
+      pushSeconds += vtkTimerLog::GetUniversalTime() - startSeconds;
+
+      if ( ( sampleIndex + 1 ) % parameters.SamplesPerUpdate == 0 )
+      {
+        startSeconds = vtkTimerLog::GetUniversalTime();
+        pathReconstructionLogic->ProcessPendingSamples();
+        processSeconds += vtkTimerLog::GetUniversalTime() - startSeconds;
+        numberOfProcessCalls++;
+      }
+    }
+    results.Add( "SampleTransformUpdate", pushSeconds, parameters.NumberOfSamples );
+    results.Add( "ProcessPendingSamples", processSeconds, numberOfProcessCalls );
+    results.Add( "SampleAppend", pushSeconds + processSeconds, parameters.NumberOfSamples );
+
+    startSeconds = vtkTimerLog::GetUniversalTime();
+    pathReconstructionLogic->ToggleRecording( pathReconstructionNode );
+    results.Add( "StopRecording", vtkTimerLog::GetUniversalTime() - startSeconds );
+
+    startSeconds = vtkTimerLog::GetUniversalTime();
+    pathReconstructionLogic->GenerateFullResolutionPaths( pathReconstructionNode );
+    results.Add( "GenerateFullResolutionPath", vtkTimerLog::GetUniversalTime() - startSeconds );
+  }
+
+  // refit
+  pathReconstructionLogic->SetParallelRefit( true );
+  startSeconds = vtkTimerLog::GetUniversalTime();
+  pathReconstructionLogic->RefitAllPaths( pathReconstructionNode, true );
+  results.Add( "RefitAllPathsParallel", vtkTimerLog::GetUniversalTime() - startSeconds );
+
+  pathReconstructionLogic->SetParallelRefit( false );
+  startSeconds = vtkTimerLog::GetUniversalTime();
+  pathReconstructionLogic->RefitAllPaths( pathReconstructionNode, true );
+  results.Add( "RefitAllPathsSerial", vtkTimerLog::GetUniversalTime() - startSeconds );
+
+  startSeconds = vtkTimerLog::GetUniversalTime();
+  pathReconstructionLogic->RefitAllPaths( pathReconstructionNode );
+  results.Add( "RefitAllPathsUpToDate", vtkTimerLog::GetUniversalTime() - startSeconds );
+
+  // suffix lookups
+  vtkSmartPointer< vtkIntArray > suffixes = vtkSmartPointer< vtkIntArray >::New();
+  startSeconds = vtkTimerLog::GetUniversalTime();
+  pathReconstructionNode->GetSuffixes( suffixes );
+  results.Add( "GetSuffixes", vtkTimerLog::GetUniversalTime() - startSeconds );
+
+  int numberOfSuffixes = suffixes->GetNumberOfTuples();
+  int numberOfNodesFound = 0;
+  for ( int lookupIndex = 0; lookupIndex < parameters.NumberOfLookups; lookupIndex++ )
+  {
+    startSeconds = vtkTimerLog::GetUniversalTime();
+    for ( int suffixIndex = 0; suffixIndex < numberOfSuffixes; suffixIndex++ )
+    {
+      int suffix = suffixes->GetValue( suffixIndex );
+      numberOfNodesFound += ( pathReconstructionNode->GetPointsModelNodeBySuffix( suffix ) != NULL ) ? 1 : 0;
+      numberOfNodesFound += ( pathReconstructionNode->GetPathModelNodeBySuffix( suffix ) != NULL ) ? 1 : 0;
+    }
+    results.Add( "SuffixLookup", vtkTimerLog::GetUniversalTime() - startSeconds, 2 * numberOfSuffixes );
+  }
+  if ( numberOfNodesFound != 2 * numberOfSuffixes * parameters.NumberOfLookups )
+  {
+    std::cerr << "Warning: " << ( 2 * numberOfSuffixes * parameters.NumberOfLookups - numberOfNodesFound ) << " suffix lookups did not find a model node." << std::endl;
+  }
+
+  // node round trip
+  std::stringstream nodeXMLStream;
+  startSeconds = vtkTimerLog::GetUniversalTime();
+  pathReconstructionNode->WriteXML( nodeXMLStream, 0 );
+  results.Add( "NodeWriteXML", vtkTimerLog::GetUniversalTime() - startSeconds );
+
+  std::vector< std::string > attributes;
+  ParseXMLAttributes( nodeXMLStream.str(), attributes );
+  std::vector< const char* > attributePointers;
+  for ( std::vector< std::string >::iterator attributeIterator = attributes.begin(); attributeIterator != attributes.end(); attributeIterator++ )
+  {
+    attributePointers.push_back( attributeIterator->c_str() );
+  }
+  attributePointers.push_back( NULL );
+
+  vtkSmartPointer< vtkMRMLPathReconstructionNode > readPathReconstructionNode = vtkSmartPointer< vtkMRMLPathReconstructionNode >::New();
+  startSeconds = vtkTimerLog::GetUniversalTime();
+  readPathReconstructionNode->ReadXMLAttributes( &attributePointers[ 0 ] );
+  results.Add( "NodeReadXMLAttributes", vtkTimerLog::GetUniversalTime() - startSeconds );
+
+  // scene round trip
+  scene->SetSaveToXMLString( 1 );
+  startSeconds = vtkTimerLog::GetUniversalTime();
+  scene->Commit();
+  results.Add( "SceneWriteXML", vtkTimerLog::GetUniversalTime() - startSeconds );
+  std::string sceneXML = scene->GetSceneXMLString();
+
+  {
+    vtkSmartPointer< vtkMRMLScene > readScene = vtkSmartPointer< vtkMRMLScene >::New();
+    vtkSmartPointer< vtkSlicerMarkupsToModelLogic > readMarkupsToModelLogic = vtkSmartPointer< vtkSlicerMarkupsToModelLogic >::New();
+    vtkSmartPointer< vtkSlicerPathReconstructionLogic > readPathReconstructionLogic = vtkSmartPointer< vtkSlicerPathReconstructionLogic >::New();
+    SetUpScene( readScene, readPathReconstructionLogic, readMarkupsToModelLogic );
+    readScene->SetLoadFromXMLString( 1 );
+    readScene->SetSceneXMLString( sceneXML );
+    startSeconds = vtkTimerLog::GetUniversalTime();
+    readScene->Import();
+    results.Add( "SceneReadXML", vtkTimerLog::GetUniversalTime() - startSeconds );
+    readPathReconstructionLogic->SetMRMLScene( NULL );
+    readMarkupsToModelLogic->SetMRMLScene( NULL );
+  }
+
+  // delete
+  int numberOfPathsToDeleteOneByOne = numberOfSuffixes / 2;
+  for ( int deleteIndex = 0; deleteIndex < numberOfPathsToDeleteOneByOne; deleteIndex++ )
+  {
+    startSeconds = vtkTimerLog::GetUniversalTime();
+    pathReconstructionLogic->DeleteLastPath( pathReconstructionNode );
+    results.Add( "DeleteLastPath", vtkTimerLog::GetUniversalTime() - startSeconds );
+  }
+
+  int numberOfRemainingPaths = pathReconstructionNode->GetNumberOfPathPointsPairs();
+  startSeconds = vtkTimerLog::GetUniversalTime();
+  pathReconstructionLogic->DeleteAllPaths( pathReconstructionNode );
+  results.Add( "DeleteAllPaths", vtkTimerLog::GetUniversalTime() - startSeconds, numberOfRemainingPaths );
+
+  pathReconstructionLogic->SetMRMLScene( NULL );
+  markupsToModelLogic->SetMRMLScene( NULL );
+}
+
+//------------------------------------------------------------------------------
+void ComputeStatistics( const BenchmarkTiming& timing, double& meanSeconds, double& minimumSeconds, double& maximumSeconds, double& medianSeconds )
+{
+  meanSeconds = ( timing.NumberOfOperations > 0 ) ? timing.TotalSeconds / timing.NumberOfOperations : 0.0;
+  minimumSeconds = 0.0;
+  maximumSeconds = 0.0;
+  medianSeconds = 0.0;
+  if ( timing.SecondsPerOperation.empty() )
+  {
+    return;
+  }
+  std::vector< double > sortedSeconds = timing.SecondsPerOperation;
+  std::sort( sortedSeconds.begin(), sortedSeconds.end() );
+  minimumSeconds = sortedSeconds.front();
+  maximumSeconds = sortedSeconds.back();
+  medianSeconds = sortedSeconds[ sortedSeconds.size() / 2 ];
+}
+
+//------------------------------------------------------------------------------
+void WriteResultsCSV( const BenchmarkParameters& parameters, const BenchmarkResults& results, std::ostream& os )
+{
+  os << "operation,catheters,samples,repeats,measurements,operations,totalSeconds,meanSeconds,medianSeconds,minimumSeconds,maximumSeconds" << std::endl;
+  const std::vector< BenchmarkTiming >& timings = results.GetTimings();
+  for ( std::vector< BenchmarkTiming >::const_iterator timingIterator = timings.begin(); timingIterator != timings.end(); timingIterator++ )
+  {
+    double meanSeconds, minimumSeconds, maximumSeconds, medianSeconds;
+    ComputeStatistics( *timingIterator, meanSeconds, minimumSeconds, maximumSeconds, medianSeconds );
+    os << timingIterator->Name << ","
+       << parameters.NumberOfCatheters << ","
+       << parameters.NumberOfSamples << ","
+       << parameters.NumberOfRepeats << ","
+       << timingIterator->SecondsPerOperation.size() << ","
+       << timingIterator->NumberOfOperations << ","
+       << timingIterator->TotalSeconds << ","
+       << meanSeconds << ","
+       << medianSeconds << ","
+       << minimumSeconds << ","
+       << maximumSeconds << std::endl;
+  }
+}
+
+//------------------------------------------------------------------------------
+void WriteResultsJSON( const BenchmarkParameters& parameters, const BenchmarkResults& results, std::ostream& os )
+{
+  os << "{" << std::endl;
+  os << "  \"benchmark\": \"vtkSlicerPathReconstructionBenchmark\"," << std::endl;
+  os << "  \"vtkVersion\": \"" << vtkVersion::GetVTKVersion() << "\"," << std::endl;
+  os << "  \"parameters\": {" << std::endl;
+  os << "    \"catheters\": " << parameters.NumberOfCatheters << "," << std::endl;
+  os << "    \"samples\": " << parameters.NumberOfSamples << "," << std::endl;
+  os << "    \"repeats\": " << parameters.NumberOfRepeats << "," << std::endl;
+  os << "    \"samplesPerUpdate\": " << parameters.SamplesPerUpdate << "," << std::endl;
+  os << "    \"lookups\": " << parameters.NumberOfLookups << "," << std::endl;
+  os << "    \"liveLevelOfDetail\": \"" << vtkMRMLPathReconstructionNode::LevelOfDetailAsString( parameters.LiveLevelOfDetail ) << "\"" << std::endl;
+  os << "  }," << std::endl;
+  os << "  \"results\": [" << std::endl;
+  const std::vector< BenchmarkTiming >& timings = results.GetTimings();
+  for ( std::vector< BenchmarkTiming >::const_iterator timingIterator = timings.begin(); timingIterator != timings.end(); timingIterator++ )
+  {
+    double meanSeconds, minimumSeconds, maximumSeconds, medianSeconds;
+    ComputeStatistics( *timingIterator, meanSeconds, minimumSeconds, maximumSeconds, medianSeconds );
+    os << "    {"
+       << " \"operation\": \"" << timingIterator->Name << "\","
+       << " \"measurements\": " << timingIterator->SecondsPerOperation.size() << ","
+       << " \"operations\": " << timingIterator->NumberOfOperations << ","
+       << " \"totalSeconds\": " << timingIterator->TotalSeconds << ","
+       << " \"meanSeconds\": " << meanSeconds << ","
+       << " \"medianSeconds\": " << medianSeconds << ","
+       << " \"minimumSeconds\": " << minimumSeconds << ","
+       << " \"maximumSeconds\": " << maximumSeconds
+       << " }" << ( ( timingIterator + 1 != timings.end() ) ? "," : "" ) << std::endl;
+  }
+  os << "  ]" << std::endl;
+  os << "}" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+bool ParseArguments( int argc, char* argv[], BenchmarkParameters& parameters )
+{
+  for ( int argumentIndex = 1; argumentIndex < argc; argumentIndex++ )
+  {
+    std::string argument = argv[ argumentIndex ];
+    if ( argumentIndex + 1 >= argc )
+    {
+      std::cerr << "Missing value for argument " << argument << std::endl;
+      return false;
+    }
+    const char* value = argv[ ++argumentIndex ];
+    if ( argument == "--catheters" )
+    {
+      parameters.NumberOfCatheters = atoi( value );
+    }
+    else if ( argument == "--samples" )
+    {
+      parameters.NumberOfSamples = atoi( value );
+    }
+    else if ( argument == "--repeats" )
+    {
+      parameters.NumberOfRepeats = atoi( value );
+    }
+    else if ( argument == "--samples-per-update" )
+    {
+      parameters.SamplesPerUpdate = atoi( value );
+    }
+    else if ( argument == "--lookups" )
+    {
+      parameters.NumberOfLookups = atoi( value );
+    }
+    else if ( argument == "--level-of-detail" )
+    {
+      parameters.LiveLevelOfDetail = vtkMRMLPathReconstructionNode::LevelOfDetailFromString( value );
+      if ( parameters.LiveLevelOfDetail < 0 )
+      {
+        std::cerr << "Unrecognized level of detail " << value << std::endl;
+        return false;
+      }
+    }
+    else if ( argument == "--output" )
+    {
+      parameters.OutputFileName = value;
+    }
+    else
+    {
+      std::cerr << "Unrecognized argument " << argument << std::endl;
+      return false;
+    }
+  }
+
+  if ( parameters.NumberOfCatheters < 1 || parameters.NumberOfSamples < 2 || parameters.NumberOfRepeats < 1 ||
+       parameters.SamplesPerUpdate < 1 || parameters.NumberOfLookups < 0 )
+  {
+    std::cerr << "Invalid arguments. Need at least 1 catheter, 2 samples, 1 repeat and 1 sample per update." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool EndsWith( const std::string& text, const std::string& ending )
+{
+  return text.size() >= ending.size() && text.compare( text.size() - ending.size(), ending.size(), ending ) == 0;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+int main( int argc, char* argv[] )
+{
+  BenchmarkParameters parameters;
+  if ( !ParseArguments( argc, argv, parameters ) )
+  {
+    std::cerr << "Usage: " << argv[ 0 ] << " [--catheters N] [--samples M] [--repeats R] [--samples-per-update K]"
+              << " [--lookups L] [--level-of-detail Polyline|CoarseTube|FullTube] [--output results.json|results.csv]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  BenchmarkResults results;
+  for ( int repeatIndex = 0; repeatIndex < parameters.NumberOfRepeats; repeatIndex++ )
+  {
+    RunBenchmark( parameters, results );
+  }
+
+  if ( parameters.OutputFileName.empty() )
+  {
+    WriteResultsJSON( parameters, results, std::cout );
+    return EXIT_SUCCESS;
+  }
+
+  std::ofstream outputFile( parameters.OutputFileName.c_str() );
+  if ( !outputFile.is_open() )
+  {
+    std::cerr << "Could not open " << parameters.OutputFileName << " for writing." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if ( EndsWith( parameters.OutputFileName, ".csv" ) )
+  {
+    WriteResultsCSV( parameters, results, outputFile );
+  }
+  else
+  {
+    WriteResultsJSON( parameters, results, outputFile );
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Distances between two parallel tubes of radius 1 whose axes are 5 apart.
+// Every surface-to-surface distance is between 3 (facing sides) and 5 (far sides).
+
+// PathReconstruction includes
+#include "vtkMRMLPathReconstructionNode.h"
+#include "vtkSlicerPathVerificationLogic.h"
+
+// MRML includes
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLTableNode.h>
+
+// vtk includes
+#include <vtkDataArray.h>
+#include <vtkLineSource.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTable.h>
+#include <vtkTubeFilter.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Path reconstruction node with one path: a tube around the line from (x,0,0) to (x,0,100)
+vtkMRMLPathReconstructionNode* AddTubePath( vtkMRMLScene* scene, double x )
+{
+  vtkNew< vtkLineSource > lineSource;
+  lineSource->SetPoint1( x, 0.0, 0.0 );
+  lineSource->SetPoint2( x, 0.0, 100.0 );
+  lineSource->SetResolution( 50 );
+  vtkNew< vtkTubeFilter > tubeFilter;
+  tubeFilter->SetInputConnection( lineSource->GetOutputPort() );
+  tubeFilter->SetRadius( 1.0 );
+  tubeFilter->SetNumberOfSides( 20 );
+  tubeFilter->Update();
+
+  vtkSmartPointer< vtkMRMLModelNode > pointsNode = vtkSmartPointer< vtkMRMLModelNode >::New();
+  vtkSmartPointer< vtkPolyData > pointsPolyData = vtkSmartPointer< vtkPolyData >::New();
+  pointsPolyData->DeepCopy( lineSource->GetOutput() );
+  pointsNode->SetAndObservePolyData( pointsPolyData );
+  scene->AddNode( pointsNode );
+
+  vtkSmartPointer< vtkMRMLModelNode > pathNode = vtkSmartPointer< vtkMRMLModelNode >::New();
+  vtkSmartPointer< vtkPolyData > pathPolyData = vtkSmartPointer< vtkPolyData >::New();
+  pathPolyData->DeepCopy( tubeFilter->GetOutput() );
+  pathNode->SetAndObservePolyData( pathPolyData );
+  scene->AddNode( pathNode );
+
+  vtkSmartPointer< vtkMRMLPathReconstructionNode > pathsNode = vtkSmartPointer< vtkMRMLPathReconstructionNode >::New();
+  scene->AddNode( pathsNode );
+  pathsNode->AddPointsPathPairModelNodeIDs( pointsNode->GetID(), pathNode->GetID() );
+  return pathsNode;
+}
+
+}
+
+//------------------------------------------------------------------------------
+int vtkSlicerPathVerificationLogicTest1( int vtkNotUsed( argc ), char* vtkNotUsed( argv )[] )
+{
+  vtkNew< vtkMRMLScene > scene;
+  vtkMRMLPathReconstructionNode* referencePathsNode = AddTubePath( scene.GetPointer(), 0.0 );
+  vtkMRMLPathReconstructionNode* comparePathsNode = AddTubePath( scene.GetPointer(), 5.0 );
+  vtkNew< vtkMRMLTableNode > distancesTableNode;
+  scene->AddNode( distancesTableNode.GetPointer() );
+  vtkNew< vtkMRMLTableNode > summaryTableNode;
+  scene->AddNode( summaryTableNode.GetPointer() );
+
+  vtkNew< vtkSlicerPathVerificationLogic > logic;
+  logic->SetMRMLScene( scene.GetPointer() );
+  if ( !logic->ComputeStatistics( referencePathsNode, comparePathsNode, NULL, distancesTableNode.GetPointer(), summaryTableNode.GetPointer() ) )
+  {
+    std::cerr << "ComputeStatistics failed." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkDataArray* distances = vtkDataArray::SafeDownCast( distancesTableNode->GetTable()->GetColumnByName( "Distance" ) );
+  if ( distances == NULL || distances->GetNumberOfTuples() == 0 )
+  {
+    std::cerr << "There are no distances." << std::endl;
+    return EXIT_FAILURE;
+  }
+  double distanceRange[ 2 ] = { 0.0, 0.0 };
+  distances->GetRange( distanceRange );
+  // the tube surfaces are polygons, so allow for the facets inside the circles
+  const double tolerance = 0.1;
+  if ( distanceRange[ 0 ] < 3.0 - tolerance || distanceRange[ 0 ] > 3.0 + tolerance || distanceRange[ 1 ] > 5.0 + tolerance )
+  {
+    std::cerr << "Distances are in [ " << distanceRange[ 0 ] << ", " << distanceRange[ 1 ] << " ], expected in [ 3, 5 ]." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkDataArray* means = vtkDataArray::SafeDownCast( summaryTableNode->GetTable()->GetColumnByName( "Mean" ) );
+  if ( means == NULL || means->GetNumberOfTuples() != 1 )
+  {
+    std::cerr << "Expected one row in the summary table." << std::endl;
+    return EXIT_FAILURE;
+  }
+  double mean = means->GetTuple1( 0 );
+  if ( mean < 3.0 || mean > 5.0 )
+  {
+    std::cerr << "Mean distance is " << mean << ", expected in [ 3, 5 ]." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,292 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "qSlicerPathReconstructionTableModel.h"
+
+// MRML includes
+#include <vtkMRMLModelNode.h>
+#include "vtkMRMLPathReconstructionNode.h"
+
+// vtk includes
+#include <vtkIntArray.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// Qt includes
+#include <QVector>
+
+// STD includes
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+/// \ingroup Slicer_QtModules_PathReconstruction
+class qSlicerPathReconstructionTableModelPrivate
+{
+  Q_DECLARE_PUBLIC( qSlicerPathReconstructionTableModel );
+protected:
+  qSlicerPathReconstructionTableModel* const q_ptr;
+
+public:
+  qSlicerPathReconstructionTableModelPrivate( qSlicerPathReconstructionTableModel& object );
+
+  // Row of the suffix, or the row where it would be inserted to keep the list sorted
+  int lowerBoundRow( int suffix ) const;
+
+  vtkWeakPointer< vtkMRMLPathReconstructionNode > PathReconstructionNode;
+  QVector< int > Suffixes; // sorted, same order as vtkMRMLPathReconstructionNode::GetSuffixes
+};
+
+// --------------------------------------------------------------------------
+qSlicerPathReconstructionTableModelPrivate::qSlicerPathReconstructionTableModelPrivate( qSlicerPathReconstructionTableModel& object ) : q_ptr( &object )
+{
+}
+
+// --------------------------------------------------------------------------
+int qSlicerPathReconstructionTableModelPrivate::lowerBoundRow( int suffix ) const
+{
+  QVector< int >::const_iterator suffixIterator = std::lower_bound( this->Suffixes.constBegin(), this->Suffixes.constEnd(), suffix );
+  return suffixIterator - this->Suffixes.constBegin();
+}
+
+//-----------------------------------------------------------------------------
+qSlicerPathReconstructionTableModel::qSlicerPathReconstructionTableModel( QObject* parent ) : Superclass( parent ) , d_ptr( new qSlicerPathReconstructionTableModelPrivate( *this ) )
+{
+}
+
+//-----------------------------------------------------------------------------
+qSlicerPathReconstructionTableModel::~qSlicerPathReconstructionTableModel()
+{
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLNode* qSlicerPathReconstructionTableModel::pathReconstructionNode() const
+{
+  Q_D( const qSlicerPathReconstructionTableModel );
+  return d->PathReconstructionNode;
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerPathReconstructionTableModel::suffixForRow( int row ) const
+{
+  Q_D( const qSlicerPathReconstructionTableModel );
+  if ( row < 0 || row >= d->Suffixes.size() )
+  {
+    return -1;
+  }
+  return d->Suffixes[ row ];
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionTableModel::setPathReconstructionNode( vtkMRMLNode* node )
+{
+  Q_D( qSlicerPathReconstructionTableModel );
+
+  vtkMRMLPathReconstructionNode* pathReconstructionNode = vtkMRMLPathReconstructionNode::SafeDownCast( node );
+  if ( pathReconstructionNode == d->PathReconstructionNode )
+  {
+    return;
+  }
+
+  this->qvtkReconnect( d->PathReconstructionNode, pathReconstructionNode, vtkMRMLPathReconstructionNode::PathAddedEvent, this, SLOT( onPathAdded( vtkObject*, void* ) ) );
+  this->qvtkReconnect( d->PathReconstructionNode, pathReconstructionNode, vtkMRMLPathReconstructionNode::PathRemovedEvent, this, SLOT( onPathRemoved( vtkObject*, void* ) ) );
+  this->qvtkReconnect( d->PathReconstructionNode, pathReconstructionNode, vtkCommand::ModifiedEvent, this, SLOT( onNodeModified() ) );
+
+  d->PathReconstructionNode = pathReconstructionNode;
+
+  this->resetFromMRML();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionTableModel::resetFromMRML()
+{
+  Q_D( qSlicerPathReconstructionTableModel );
+
+  this->beginResetModel();
+  d->Suffixes.clear();
+  if ( d->PathReconstructionNode != NULL )
+  {
+    vtkSmartPointer< vtkIntArray > suffixes = vtkSmartPointer< vtkIntArray >::New();
+    d->PathReconstructionNode->GetSuffixes( suffixes );
+    int numberOfSuffixes = suffixes->GetNumberOfTuples();
+    d->Suffixes.reserve( numberOfSuffixes );
+    for ( int suffixIndex = 0; suffixIndex < numberOfSuffixes; suffixIndex++ )
+    {
+      d->Suffixes.append( suffixes->GetValue( suffixIndex ) );
+    }
+  }
+  this->endResetModel();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionTableModel::onPathAdded( vtkObject* vtkNotUsed( caller ), void* callData )
+{
+  Q_D( qSlicerPathReconstructionTableModel );
+
+  if ( callData == NULL )
+  {
+    // events were compressed, so it is not known which paths were added
+    this->resetFromMRML();
+    return;
+  }
+
+  int suffix = *( static_cast< int* >( callData ) );
+  int row = d->lowerBoundRow( suffix );
+  if ( row < d->Suffixes.size() && d->Suffixes[ row ] == suffix )
+  {
+    return; // already listed
+  }
+
+  this->beginInsertRows( QModelIndex(), row, row );
+  d->Suffixes.insert( row, suffix );
+  this->endInsertRows();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionTableModel::onPathRemoved( vtkObject* vtkNotUsed( caller ), void* callData )
+{
+  Q_D( qSlicerPathReconstructionTableModel );
+
+  if ( callData == NULL )
+  {
+    // events were compressed, so it is not known which paths were removed
+    this->resetFromMRML();
+    return;
+  }
+
+  int suffix = *( static_cast< int* >( callData ) );
+  int row = d->lowerBoundRow( suffix );
+  if ( row >= d->Suffixes.size() || d->Suffixes[ row ] != suffix )
+  {
+    return; // not listed
+  }
+
+  this->beginRemoveRows( QModelIndex(), row, row );
+  d->Suffixes.remove( row );
+  this->endRemoveRows();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionTableModel::onNodeModified()
+{
+  Q_D( qSlicerPathReconstructionTableModel );
+
+  if ( d->PathReconstructionNode == NULL )
+  {
+    return;
+  }
+
+  // The suffix list is kept in sync by the add/remove events. The check is queued because
+  // ModifiedEvent may arrive before the corresponding add/remove event.
+  if ( d->Suffixes.size() != d->PathReconstructionNode->GetNumberOfPathPointsPairs() )
+  {
+    QMetaObject::invokeMethod( this, "resetFromMRMLIfOutOfSync", Qt::QueuedConnection );
+  }
+
+  // Node names may have changed. Views only request data for the visible rows.
+  if ( !d->Suffixes.isEmpty() )
+  {
+    emit dataChanged( this->index( 0, PointsNameColumn ), this->index( d->Suffixes.size() - 1, PathNameColumn ) );
+  }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionTableModel::resetFromMRMLIfOutOfSync()
+{
+  Q_D( qSlicerPathReconstructionTableModel );
+
+  // catches changes that were made without add/remove events (e.g., reading the node from a file)
+  int numberOfPaths = ( d->PathReconstructionNode != NULL ) ? d->PathReconstructionNode->GetNumberOfPathPointsPairs() : 0;
+  if ( d->Suffixes.size() != numberOfPaths )
+  {
+    this->resetFromMRML();
+  }
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerPathReconstructionTableModel::rowCount( const QModelIndex& parent ) const
+{
+  Q_D( const qSlicerPathReconstructionTableModel );
+  if ( parent.isValid() )
+  {
+    return 0;
+  }
+  return d->Suffixes.size();
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerPathReconstructionTableModel::columnCount( const QModelIndex& parent ) const
+{
+  if ( parent.isValid() )
+  {
+    return 0;
+  }
+  return NumberOfColumns;
+}
+
+//-----------------------------------------------------------------------------
+QVariant qSlicerPathReconstructionTableModel::data( const QModelIndex& index, int role ) const
+{
+  Q_D( const qSlicerPathReconstructionTableModel );
+
+  if ( role != Qt::DisplayRole || !index.isValid() || index.row() >= d->Suffixes.size() || d->PathReconstructionNode == NULL )
+  {
+    return QVariant();
+  }
+
+  int suffix = d->Suffixes[ index.row() ];
+  vtkMRMLModelNode* modelNode = NULL;
+  switch ( index.column() )
+  {
+  case SuffixColumn:
+    return QString::number( suffix );
+  case PointsNameColumn:
+    modelNode = d->PathReconstructionNode->GetPointsModelNodeBySuffix( suffix );
+    break;
+  case PathNameColumn:
+    modelNode = d->PathReconstructionNode->GetPathModelNodeBySuffix( suffix );
+    break;
+  default:
+    return QVariant();
+  }
+
+  if ( modelNode == NULL || modelNode->GetName() == NULL )
+  {
+    return QString( "NULL" );
+  }
+  return QString::fromStdString( modelNode->GetName() );
+}
+
+//-----------------------------------------------------------------------------
+QVariant qSlicerPathReconstructionTableModel::headerData( int section, Qt::Orientation orientation, int role ) const
+{
+  if ( role != Qt::DisplayRole || orientation != Qt::Horizontal )
+  {
+    return this->Superclass::headerData( section, orientation, role );
+  }
+
+  switch ( section )
+  {
+  case SuffixColumn:
+    return QString( "ID" );
+  case PointsNameColumn:
+    return QString( "Markups" );
+  case PathNameColumn:
+    return QString( "Model" );
+  default:
+    return QVariant();
+  }
+}
@@ -0,0 +1,88 @@
+/*==============================================================================
+
+  Copyright (c) Thomas Vaughan
+  Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qSlicerPathReconstructionTableModel_h
+#define __qSlicerPathReconstructionTableModel_h
+
+// Qt includes
+#include <QAbstractTableModel>
+
+// CTK includes
+#include <ctkVTKObject.h>
+
+#include "qSlicerPathReconstructionModuleWidgetsExport.h"
+
+class qSlicerPathReconstructionTableModelPrivate;
+class vtkMRMLNode;
+class vtkObject;
+
+/// \ingroup Slicer_QtModules_PathReconstruction
+/// Table model listing the points-path pairs of a path reconstruction node, one row per suffix.
+/// Only the suffix list is cached. Node names are looked up when a row is painted, and
+/// rows are inserted/removed one at a time in response to PathAddedEvent/PathRemovedEvent,
+/// so the cost of an update does not depend on the number of paths.
+class Q_SLICER_QTMODULES_PATHRECONSTRUCTION_WIDGETS_EXPORT qSlicerPathReconstructionTableModel
+  : public QAbstractTableModel
+{
+  Q_OBJECT
+  QVTK_OBJECT
+
+public:
+  typedef QAbstractTableModel Superclass;
+  qSlicerPathReconstructionTableModel( QObject* parent=0 );
+  virtual ~qSlicerPathReconstructionTableModel();
+
+  enum Columns
+  {
+    SuffixColumn = 0,
+    PointsNameColumn,
+    PathNameColumn,
+    NumberOfColumns // valid columns go above this line
+  };
+
+  /// Get the path reconstruction node shown by the model
+  Q_INVOKABLE vtkMRMLNode* pathReconstructionNode() const;
+
+  /// Get the suffix of the points-path pair shown in a row, -1 if the row is invalid
+  Q_INVOKABLE int suffixForRow( int row ) const;
+
+  virtual int rowCount( const QModelIndex& parent = QModelIndex() ) const;
+  virtual int columnCount( const QModelIndex& parent = QModelIndex() ) const;
+  virtual QVariant data( const QModelIndex& index, int role = Qt::DisplayRole ) const;
+  virtual QVariant headerData( int section, Qt::Orientation orientation, int role = Qt::DisplayRole ) const;
+
+public slots:
+  void setPathReconstructionNode( vtkMRMLNode* node );
+
+  /// Re-read the whole suffix list from the node
+  void resetFromMRML();
+
+protected slots:
+  void onPathAdded( vtkObject* caller, void* callData );
+  void onPathRemoved( vtkObject* caller, void* callData );
+  void onNodeModified();
+  void resetFromMRMLIfOutOfSync();
+
+protected:
+  QScopedPointer< qSlicerPathReconstructionTableModelPrivate > d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE( qSlicerPathReconstructionTableModel );
+  Q_DISABLE_COPY( qSlicerPathReconstructionTableModel );
+};
+
+#endif
@@ -15,6 +15,7 @@
 
 ==============================================================================*/
 
+#include "qSlicerPathReconstructionTableModel.h"
 #include "qSlicerPathReconstructionTableWidget.h"
 
 #include "vtkSlicerPathReconstructionLogic.h"
@@ -34,7 +35,6 @@
 #include <QDebug>
 #include <QtGui>
 #include <QtPlugin>
-#include <QTableWidgetItem>
 
 //-----------------------------------------------------------------------------
 /// \ingroup Slicer_QtModules_PathReconstruction
@@ -48,11 +48,13 @@ public:
   qSlicerPathReconstructionTableWidgetPrivate( qSlicerPathReconstructionTableWidget& object);
   vtkWeakPointer< vtkMRMLPathReconstructionNode > PathReconstructionNode;
   vtkWeakPointer< vtkSlicerPathReconstructionLogic > PathReconstructionLogic;
+  qSlicerPathReconstructionTableModel* PathsTableModel;
 };
 
 // --------------------------------------------------------------------------
 qSlicerPathReconstructionTableWidgetPrivate::qSlicerPathReconstructionTableWidgetPrivate( qSlicerPathReconstructionTableWidget& object ) : q_ptr( &object )
 {
+  this->PathsTableModel = NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -73,6 +75,14 @@ void qSlicerPathReconstructionTableWidget::setup()
   Q_D( qSlicerPathReconstructionTableWidget );
   d->setupUi( this );
 
+  d->PathsTableModel = new qSlicerPathReconstructionTableModel( this );
+  d->PathsTable->setModel( d->PathsTableModel );
+#if (QT_VERSION < QT_VERSION_CHECK(5, 0, 0))
+  d->PathsTable->horizontalHeader()->setResizeMode( QHeaderView::Stretch );
+#else
+  d->PathsTable->horizontalHeader()->setSectionResizeMode( QHeaderView::Stretch );
+#endif
+
   // This cannot be called by the constructor, because Slicer may not exist when the constructor is called
   d->PathReconstructionLogic = NULL;
   if (qSlicerApplication::application() != NULL && qSlicerApplication::application()->moduleManager() != NULL)
@@ -95,6 +105,9 @@ void qSlicerPathReconstructionTableWidget::setup()
   connect( d->FittingParametersComboBox, SIGNAL( currentNodeChanged( vtkMRMLNode* ) ), this, SLOT( onFittingParametersChanged() ) );
   connect( d->FittingColorPicker, SIGNAL( colorChanged( QColor ) ), this, SLOT( onFittingColorChanged( QColor ) ) );
   connect( d->RefitPathsButton, SIGNAL( clicked() ), this, SLOT( onRefitPathsButtonClicked() ) );
+
+  // The table should scroll to the bottom when new paths are added
+  connect( d->PathsTableModel, SIGNAL( rowsInserted( const QModelIndex&, int, int ) ), d->PathsTable, SLOT( scrollToBottom() ) );
 }
 
 //-----------------------------------------------------------------------------
@@ -105,12 +118,19 @@ vtkMRMLNode* qSlicerPathReconstructionTableWidget::currentNode() const
 }
 
 //-----------------------------------------------------------------------------
-QTableWidget* qSlicerPathReconstructionTableWidget::tableWidget() const
+QTableView* qSlicerPathReconstructionTableWidget::tableView() const
 {
   Q_D( const qSlicerPathReconstructionTableWidget );
   return d->PathsTable;
 }
 
+//-----------------------------------------------------------------------------
+qSlicerPathReconstructionTableModel* qSlicerPathReconstructionTableWidget::tableModel() const
+{
+  Q_D( const qSlicerPathReconstructionTableWidget );
+  return d->PathsTableModel;
+}
+
 //------------------------------------------------------------------------------
 qMRMLNodeComboBox* qSlicerPathReconstructionTableWidget::pathReconstructionNodeComboBox() const
 {
@@ -139,10 +159,8 @@ void qSlicerPathReconstructionTableWidget::setPathReconstructionNode( vtkMRMLNod
   this->qvtkReconnect( d->PathReconstructionNode, pathReconstructionNode, vtkCommand::ModifiedEvent, this, SLOT( updateGUIFromMRML() ) );
   this->qvtkReconnect( d->PathReconstructionNode, pathReconstructionNode, vtkMRMLPathReconstructionNode::InputDataModifiedEvent, this, SLOT( updateGUIFromMRML() ) );
 
-  // The table should scroll to the bottom when new paths are added
-  this->qvtkReconnect( d->PathReconstructionNode, pathReconstructionNode, vtkMRMLPathReconstructionNode::PathAddedEvent, d->PathsTable, SLOT( scrollToBottom() ) );
-
   d->PathReconstructionNode = pathReconstructionNode;
+  d->PathsTableModel->setPathReconstructionNode( pathReconstructionNode );
 
   this->updateGUIFromMRML();
 }
@@ -261,7 +279,6 @@ void qSlicerPathReconstructionTableWidget::updateGUIFromMRML()
     d->FittingParametersComboBox->setEnabled( false );
     d->FittingColorPicker->setEnabled( false );
     d->RefitPathsButton->setEnabled( false );
-    d->PathsTable->setRowCount( 0 );
     return;
   }
 
@@ -289,62 +306,4 @@ void qSlicerPathReconstructionTableWidget::updateGUIFromMRML()
     d->RefitPathsButton->setEnabled( false );
   }
   d->FittingParametersComboBox->blockSignals( wasBlockedFittingParameters );
-
-  // Update the fiducials table
-  bool wasBlockedTableWidget = d->PathsTable->blockSignals( true );
-
-  const int suffixColumn = 0;
-  const int pointsNameColumn = 1;
-  const int pathNameColumn = 2;
-  const int numberOfColumns = 3;
-
-  d->PathsTable->clear();
-  d->PathsTable->setColumnCount( numberOfColumns );
-  d->PathsTable->setHorizontalHeaderLabels( QStringList() << "ID" << "Markups" << "Model" );
-#if (QT_VERSION < QT_VERSION_CHECK(5, 0, 0))
-  d->PathsTable->horizontalHeader()->setResizeMode( QHeaderView::Stretch );
-#else
-  d->PathsTable->horizontalHeader()->setSectionResizeMode( QHeaderView::Stretch );
-#endif
-  d->PathsTable->setContextMenuPolicy( Qt::CustomContextMenu );
-  d->PathsTable->setSelectionBehavior( QAbstractItemView::SelectRows ); // only select rows rather than cells
-
-  vtkSmartPointer< vtkIntArray > suffixes = vtkSmartPointer< vtkIntArray >::New();
-  currentPathReconstructionNode->GetSuffixes( suffixes );
-  int numberOfSuffixes = suffixes->GetNumberOfTuples();
-  d->PathsTable->setRowCount( numberOfSuffixes );
-  for ( int suffixIndex = 0; suffixIndex < numberOfSuffixes; suffixIndex++ )
-  {
-    int suffix = suffixes->GetTuple1( suffixIndex );
-    QTableWidgetItem* suffixItem = new QTableWidgetItem( QString::number( suffix ) );
-    d->PathsTable->setItem( suffixIndex, suffixColumn, suffixItem );
-
-    std::string pointsName;
-    vtkMRMLModelNode* pointsNode = currentPathReconstructionNode->GetPointsModelNodeBySuffix( suffix );
-    if ( pointsNode == NULL )
-    {
-      pointsName = "NULL";
-    }
-    else
-    {
-      pointsName = pointsNode->GetName();
-    }
-    QTableWidgetItem* pointsNameItem = new QTableWidgetItem( QString::fromStdString( pointsName ) );
-    d->PathsTable->setItem( suffixIndex, pointsNameColumn, pointsNameItem );
-
-    std::string pathName;
-    vtkMRMLModelNode* pathNode = currentPathReconstructionNode->GetPathModelNodeBySuffix( suffix );
-    if ( pathNode == NULL )
-    {
-      pathName = "NULL";
-    }
-    else
-    {
-      pathName = pathNode->GetName();
-    }
-    QTableWidgetItem* pathNameItem = new QTableWidgetItem( QString::fromStdString( pathName ) );
-    d->PathsTable->setItem( suffixIndex, pathNameColumn, pathNameItem );
-  }
-
-  d->PathsTable->blockSignals( wasBlockedTableWidget );
 }
@@ -28,6 +28,7 @@
 #include "qSlicerPathReconstructionModuleWidgetsExport.h"
 #include "ui_qSlicerPathReconstructionTableWidget.h"
 
+class qSlicerPathReconstructionTableModel;
 class qSlicerPathReconstructionTableWidgetPrivate;
 
 /// \ingroup Slicer_QtModules_CreateModels
@@ -44,8 +45,11 @@ public:
   /// Get the currently selected node.
   Q_INVOKABLE vtkMRMLNode* currentNode() const;
 
-  /// Get the table widget
-  Q_INVOKABLE QTableWidget* tableWidget() const;
+  /// Get the table view
+  Q_INVOKABLE QTableView* tableView() const;
+
+  /// Get the model that lists the paths of the current node
+  Q_INVOKABLE qSlicerPathReconstructionTableModel* tableModel() const;
 
   /// Get the node selector combo box
   Q_INVOKABLE qMRMLNodeComboBox* pathReconstructionNodeComboBox() const;
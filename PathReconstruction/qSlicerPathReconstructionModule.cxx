@@ -17,6 +17,7 @@
 
 // Qt includes
 #include <QtPlugin>
+#include <QTimer>
 
 // PathReconstruction Logic includes
 #include <vtkSlicerPathReconstructionLogic.h>
@@ -37,6 +38,10 @@ class qSlicerPathReconstructionModulePrivate
 {
 public:
   qSlicerPathReconstructionModulePrivate();
+
+  // drains the sample buffers of the logic, also when the module widget is not shown.
+  // It only runs while the logic has pending work, so an idle scene costs nothing.
+  QTimer ProcessPendingSamplesTimer;
 };
 
 //-----------------------------------------------------------------------------
@@ -106,7 +111,45 @@ QIcon qSlicerPathReconstructionModule::icon()const
 //-----------------------------------------------------------------------------
 void qSlicerPathReconstructionModule::setup()
 {
+  Q_D( qSlicerPathReconstructionModule );
   this->Superclass::setup();
+
+  const int processPendingSamplesIntervalMs = 20;
+  d->ProcessPendingSamplesTimer.setInterval( processPendingSamplesIntervalMs );
+  connect( &d->ProcessPendingSamplesTimer, SIGNAL( timeout() ), this, SLOT( processPendingSamples() ) );
+  qvtkConnect( this->logic(), vtkSlicerPathReconstructionLogic::PendingWorkEvent, this, SLOT( onPendingWork() ) );
+  this->onPendingWork();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionModule::onPendingWork()
+{
+  Q_D( qSlicerPathReconstructionModule );
+  vtkSlicerPathReconstructionLogic* pathReconstructionLogic = vtkSlicerPathReconstructionLogic::SafeDownCast( this->logic() );
+  if ( pathReconstructionLogic == NULL || d->ProcessPendingSamplesTimer.isActive() )
+  {
+    return;
+  }
+  if ( pathReconstructionLogic->HasPendingWork() )
+  {
+    d->ProcessPendingSamplesTimer.start();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionModule::processPendingSamples()
+{
+  Q_D( qSlicerPathReconstructionModule );
+  vtkSlicerPathReconstructionLogic* pathReconstructionLogic = vtkSlicerPathReconstructionLogic::SafeDownCast( this->logic() );
+  if ( pathReconstructionLogic == NULL )
+  {
+    return;
+  }
+  pathReconstructionLogic->ProcessPendingSamples();
+  if ( !pathReconstructionLogic->HasPendingWork() )
+  {
+    d->ProcessPendingSamplesTimer.stop();
+  }
 }
 
 //-----------------------------------------------------------------------------
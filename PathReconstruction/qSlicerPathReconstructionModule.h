@@ -21,6 +21,9 @@
 // SlicerQt includes
 #include "qSlicerLoadableModule.h"
 
+// CTK includes
+#include <ctkVTKObject.h>
+
 #include "qSlicerPathReconstructionModuleExport.h"
 
 class qSlicerPathReconstructionModulePrivate;
@@ -30,6 +33,7 @@ class Q_SLICER_QTMODULES_PATHRECONSTRUCTION_EXPORT qSlicerPathReconstructionModu
   public qSlicerLoadableModule
 {
   Q_OBJECT
+  QVTK_OBJECT
 #ifdef Slicer_HAVE_QT5
   Q_PLUGIN_METADATA(IID "org.slicer.modules.loadable.qSlicerLoadableModule/1.0");
 #endif
@@ -72,6 +76,14 @@ protected:
   /// Create and return the logic associated to this module
   virtual vtkMRMLAbstractLogic* createLogic();
 
+protected slots:
+  /// Start the timer that calls processPendingSamples, if the logic has work to do
+  void onPendingWork();
+
+  /// Move samples queued during buffered recording into the points models.
+  /// Stops the timer when the logic has no more work to do.
+  void processPendingSamples();
+
 protected:
   QScopedPointer<qSlicerPathReconstructionModulePrivate> d_ptr;
 
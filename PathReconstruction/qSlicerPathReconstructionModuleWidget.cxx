@@ -18,7 +18,9 @@
 // Qt includes
 #include <QtGui>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QMenu>
+#include <QTimer>
 
 // SlicerQt includes
 #include "qSlicerPathReconstructionModuleWidget.h"
@@ -49,6 +51,11 @@ public:
   vtkWeakPointer< vtkMRMLPathReconstructionNode > PathReconstructionNode;
 
   QMenu* DeleteMenu;
+
+  // Coalesces node events into a single GUI update
+  QTimer* GUIUpdateTimer;
+  QElapsedTimer TimeSinceLastGUIUpdate;
+  double MaximumGUIUpdateRate; // updates per second
 };
 
 //-----------------------------------------------------------------------------
@@ -57,6 +64,9 @@ public:
 qSlicerPathReconstructionModuleWidgetPrivate::qSlicerPathReconstructionModuleWidgetPrivate( qSlicerPathReconstructionModuleWidget& object )
 : q_ptr( &object )
 {
+  this->DeleteMenu = NULL;
+  this->GUIUpdateTimer = NULL;
+  this->MaximumGUIUpdateRate = 30.0;
 }
 
 //-----------------------------------------------------------------------------
@@ -86,6 +96,11 @@ void qSlicerPathReconstructionModuleWidget::setup()
   d->setupUi( this );
   this->Superclass::setup();
 
+  d->GUIUpdateTimer = new QTimer( this );
+  d->GUIUpdateTimer->setSingleShot( true );
+  connect( d->GUIUpdateTimer, SIGNAL( timeout() ), this, SLOT( updateGUIFromMRML() ) );
+  d->TimeSinceLastGUIUpdate.start();
+
   vtkMRMLScene* scene = d->logic()->GetMRMLScene();
   this->setMRMLScene( scene );
   d->PathsTableWidget->setMRMLScene( scene ); // This may no longer be necessary
@@ -156,6 +171,46 @@ void qSlicerPathReconstructionModuleWidget::exit()
   Superclass::exit();
 }
 
+//-----------------------------------------------------------------------------
+double qSlicerPathReconstructionModuleWidget::maximumGUIUpdateRate() const
+{
+  Q_D( const qSlicerPathReconstructionModuleWidget );
+  return d->MaximumGUIUpdateRate;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionModuleWidget::setMaximumGUIUpdateRate( double updatesPerSecond )
+{
+  Q_D( qSlicerPathReconstructionModuleWidget );
+  if ( updatesPerSecond <= 0.0 )
+  {
+    qWarning() << Q_FUNC_INFO << ": maximum GUI update rate must be positive";
+    return;
+  }
+  d->MaximumGUIUpdateRate = updatesPerSecond;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPathReconstructionModuleWidget::requestGUIUpdate()
+{
+  Q_D( qSlicerPathReconstructionModuleWidget );
+  if ( d->GUIUpdateTimer == NULL )
+  {
+    this->updateGUIFromMRML();
+    return;
+  }
+
+  if ( d->GUIUpdateTimer->isActive() )
+  {
+    return; // an update is already pending, it will pick up this change too
+  }
+
+  // wait until the minimum interval since the last update has passed (0 = next event loop iteration)
+  qint64 minimumIntervalMs = (qint64)( 1000.0 / d->MaximumGUIUpdateRate );
+  qint64 remainingMs = minimumIntervalMs - d->TimeSinceLastGUIUpdate.elapsed();
+  d->GUIUpdateTimer->start( remainingMs > 0 ? (int)remainingMs : 0 );
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerPathReconstructionModuleWidget::blockAllSignals( bool block )
 {
@@ -207,8 +262,8 @@ void qSlicerPathReconstructionModuleWidget::onParameterNodeSelected()
 {
   Q_D( qSlicerPathReconstructionModuleWidget );
   vtkMRMLPathReconstructionNode* selectedPathReconstructionNode = vtkMRMLPathReconstructionNode::SafeDownCast( d->ParameterNodeComboBox->currentNode() );
-  qvtkReconnect( d->PathReconstructionNode, selectedPathReconstructionNode, vtkMRMLPathReconstructionNode::InputDataModifiedEvent, this, SLOT( updateGUIFromMRML() ) );
-  qvtkReconnect( d->PathReconstructionNode, selectedPathReconstructionNode, vtkCommand::ModifiedEvent, this, SLOT( updateGUIFromMRML() ) );
+  qvtkReconnect( d->PathReconstructionNode, selectedPathReconstructionNode, vtkMRMLPathReconstructionNode::InputDataModifiedEvent, this, SLOT( requestGUIUpdate() ) );
+  qvtkReconnect( d->PathReconstructionNode, selectedPathReconstructionNode, vtkCommand::ModifiedEvent, this, SLOT( requestGUIUpdate() ) );
   d->PathReconstructionNode = selectedPathReconstructionNode;
   d->PathsTableWidget->setPathReconstructionNode( selectedPathReconstructionNode );
   this->updateGUIFromMRML();
@@ -435,17 +490,7 @@ void qSlicerPathReconstructionModuleWidget::onDeleteAllClicked()
   
   pathReconstructionNode->SetNextCount( 1 );
 
-  int whileLoopSafetyCounter = 500;
-  while ( pathReconstructionNode->GetNumberOfPathPointsPairs() > 0 && whileLoopSafetyCounter > 0 )
-  {
-    d->logic()->DeleteLastPath( pathReconstructionNode );
-    whileLoopSafetyCounter--;
-  }
-
-  if ( whileLoopSafetyCounter <= 0 )
-  {
-    qCritical() << Q_FUNC_INFO << ": tried to delete all paths, but may have gotten caught in infinite loop. Stopping.";
-  }
+  d->logic()->DeleteAllPaths( pathReconstructionNode );
 
   this->updateGUIFromMRML();
 }
@@ -455,6 +500,13 @@ void qSlicerPathReconstructionModuleWidget::updateGUIFromMRML()
 {
   Q_D( qSlicerPathReconstructionModuleWidget );
 
+  // this update covers any pending request
+  if ( d->GUIUpdateTimer != NULL )
+  {
+    d->GUIUpdateTimer->stop();
+  }
+  d->TimeSinceLastGUIUpdate.restart();
+
   vtkMRMLPathReconstructionNode* pathReconstructionNode = vtkMRMLPathReconstructionNode::SafeDownCast( d->ParameterNodeComboBox->currentNode() );
   if ( pathReconstructionNode == NULL )
   {
@@ -463,27 +515,29 @@ void qSlicerPathReconstructionModuleWidget::updateGUIFromMRML()
     return;
   }
 
-  // assume at first everything should be enabled, disable on an individual basis
-  this->enableAllWidgets( true );
-
   // temporarily block signals so nothing gets triggered when updating the GUI
   this->blockAllSignals( true );
 
+  // widgets are only set if their value differs, since most updates (e.g., new samples while recording) change nothing here
   vtkMRMLCollectPointsNode* collectPointsNode = pathReconstructionNode->GetCollectPointsNode();
-  d->CollectPointsComboBox->setCurrentNode( collectPointsNode );
+  if ( d->CollectPointsComboBox->currentNode() != collectPointsNode )
+  {
+    d->CollectPointsComboBox->setCurrentNode( collectPointsNode );
+  }
 
-  if ( collectPointsNode == NULL )
+  vtkMRMLTransformNode* samplingTransformNode = NULL;
+  vtkMRMLTransformNode* anchorTransformNode = NULL;
+  if ( collectPointsNode != NULL )
   {
-    d->SamplingTransformComboBox->setEnabled( false );
-    d->SamplingTransformComboBox->setCurrentNode( NULL );
-    d->AnchorTransformComboBox->setEnabled( false );
-    d->AnchorTransformComboBox->setCurrentNode( NULL );
+    samplingTransformNode = pathReconstructionNode->GetSamplingTransformNode();
+    anchorTransformNode = pathReconstructionNode->GetAnchorTransformNode();
   }
-  else
+  if ( d->SamplingTransformComboBox->currentNode() != samplingTransformNode )
   {
-    vtkMRMLTransformNode* samplingTransformNode = pathReconstructionNode->GetSamplingTransformNode();
     d->SamplingTransformComboBox->setCurrentNode( samplingTransformNode );
-    vtkMRMLTransformNode* anchorTransformNode = pathReconstructionNode->GetAnchorTransformNode();
+  }
+  if ( d->AnchorTransformComboBox->currentNode() != anchorTransformNode )
+  {
     d->AnchorTransformComboBox->setCurrentNode( anchorTransformNode );
   }
 
@@ -492,46 +546,56 @@ void qSlicerPathReconstructionModuleWidget::updateGUIFromMRML()
   double pointsGreen = pathReconstructionNode->GetPointsColorGreen();
   double pointsBlue = pathReconstructionNode->GetPointsColorBlue();
   pointsColor.setRgbF( pointsRed, pointsGreen, pointsBlue );
-  d->CollectPointsColorPicker->setColor( pointsColor );
+  if ( d->CollectPointsColorPicker->color() != pointsColor )
+  {
+    d->CollectPointsColorPicker->setColor( pointsColor );
+  }
 
   QString pointsBaseLabel = QString( pathReconstructionNode->GetPointsBaseName().c_str() );
-  d->PointsBaseNameLineEdit->setText( pointsBaseLabel );
+  if ( d->PointsBaseNameLineEdit->text() != pointsBaseLabel )
+  {
+    d->PointsBaseNameLineEdit->setText( pointsBaseLabel );
+  }
 
   QString pathBaseLabel = QString( pathReconstructionNode->GetPathBaseName().c_str() );
-  d->PathBaseNameLineEdit->setText( pathBaseLabel );
+  if ( d->PathBaseNameLineEdit->text() != pathBaseLabel )
+  {
+    d->PathBaseNameLineEdit->setText( pathBaseLabel );
+  }
 
   int nextCount = pathReconstructionNode->GetNextCount();
-  d->NextCountSpinBox->setValue( nextCount );
-
-  if ( pathReconstructionNode->GetRecordingState() == vtkMRMLPathReconstructionNode::Stopped )
+  if ( d->NextCountSpinBox->value() != nextCount )
   {
-    d->RecordingButton->setChecked( false );
-    d->RecordingButton->setText( "Start Recording" );
-    if ( !d->logic()->IsRecordingPossible( pathReconstructionNode ) )
-    {
-      d->RecordingButton->setEnabled( false );
-    }
+    d->NextCountSpinBox->setValue( nextCount );
   }
-  else
+
+  bool isRecording = ( pathReconstructionNode->GetRecordingState() != vtkMRMLPathReconstructionNode::Stopped );
+  if ( d->RecordingButton->isChecked() != isRecording )
   {
-    d->RecordingButton->setChecked( true );
-    d->RecordingButton->setText( "Stop Recording" );
-    // shouldn't need to support change of inputs while recording
-    d->DeleteButton->setEnabled( false );
-    d->SamplingTransformComboBox->setEnabled( false );
-    d->AnchorTransformComboBox->setEnabled( false );
-    d->CollectPointsComboBox->setEnabled( false );
-    d->CollectPointsColorPicker->setEnabled( false );
-    d->NextCountSpinBox->setEnabled( false );
-    d->PointsBaseNameLineEdit->setEnabled( false );
-    d->PathBaseNameLineEdit->setEnabled( false );
+    d->RecordingButton->setChecked( isRecording );
   }
-
-  int numberOfPaths = pathReconstructionNode->GetNumberOfPathPointsPairs();
-  if ( numberOfPaths == 0 )
+  QString recordingButtonText = isRecording ? QString( "Stop Recording" ) : QString( "Start Recording" );
+  if ( d->RecordingButton->text() != recordingButtonText )
   {
-    d->DeleteButton->setEnabled( false );
+    d->RecordingButton->setText( recordingButtonText );
   }
 
+  // decide the enabled state of each widget first, so that no widget is toggled back and forth
+  // shouldn't need to support change of inputs while recording
+  bool inputsEnabled = !isRecording;
+  bool transformsEnabled = inputsEnabled && ( collectPointsNode != NULL );
+  bool recordingButtonEnabled = isRecording || d->logic()->IsRecordingPossible( pathReconstructionNode );
+  bool deleteButtonEnabled = inputsEnabled && ( pathReconstructionNode->GetNumberOfPathPointsPairs() > 0 );
+
+  d->SamplingTransformComboBox->setEnabled( transformsEnabled );
+  d->AnchorTransformComboBox->setEnabled( transformsEnabled );
+  d->NextCountSpinBox->setEnabled( inputsEnabled );
+  d->PointsBaseNameLineEdit->setEnabled( inputsEnabled );
+  d->CollectPointsComboBox->setEnabled( inputsEnabled );
+  d->CollectPointsColorPicker->setEnabled( inputsEnabled );
+  d->PathBaseNameLineEdit->setEnabled( inputsEnabled );
+  d->RecordingButton->setEnabled( recordingButtonEnabled );
+  d->DeleteButton->setEnabled( deleteButtonEnabled );
+
   this->blockAllSignals( false );
 }
@@ -37,8 +37,12 @@ public:
   qSlicerPathReconstructionModuleWidget(QWidget *parent=0);
   virtual ~qSlicerPathReconstructionModuleWidget();
 
+  /// Maximum number of GUI updates per second in response to node events. Default is 30.
+  double maximumGUIUpdateRate() const;
+
 public slots:
   void setMRMLScene( vtkMRMLScene* scene );
+  void setMaximumGUIUpdateRate( double updatesPerSecond );
 
 protected slots:
   void blockAllSignals( bool block );
@@ -56,6 +60,9 @@ protected slots:
   void onRecordingButtonClicked();
   void onDeleteButtonClicked();
   void onDeleteAllClicked();
+  /// Schedule an update of the GUI. Requests are coalesced, so that the GUI
+  /// is updated at most once per event loop iteration and at most at the maximum rate.
+  void requestGUIUpdate();
   void updateGUIFromMRML();
 
 protected:
@@ -17,7 +17,7 @@ class PathVerification(ScriptedLoadableModule):
     ScriptedLoadableModule.__init__(self, parent)
     self.parent.title = "PathVerification"
     self.parent.categories = ["IGT"]
-    self.parent.dependencies = []
+    self.parent.dependencies = ["PathReconstruction"]
     self.parent.contributors = ["Thomas Vaughan (Queen's University)"]
     self.parent.helpText = """Measure accuracy between two paths"""
     self.parent.helpText += self.getDefaultModuleDocumentationLink()
@@ -218,6 +218,11 @@ class PathVerificationWidget(ScriptedLoadableModuleWidget):
     self.outputSummaryTableComboBox.setMRMLScene( slicer.mrmlScene )
     verificationFormLayout.addRow("Summary Table: ", self.outputSummaryTableComboBox)
 
+    self.oneToOneCorrespondenceCheckBox = qt.QCheckBox()
+    self.oneToOneCorrespondenceCheckBox.checked = False
+    self.oneToOneCorrespondenceCheckBox.setToolTip("Match each reference path to at most one compare path")
+    verificationFormLayout.addRow("One-to-one correspondence: ", self.oneToOneCorrespondenceCheckBox)
+
     self.computeButton = qt.QPushButton("Compute")
     self.computeButton.enabled = False
     verificationFormLayout.addRow(self.computeButton)
@@ -356,10 +361,12 @@ class PathVerificationWidget(ScriptedLoadableModuleWidget):
       outputDistancesTableNode.SetName( label + "Distances" )
       slicer.mrmlScene.AddNode(outputDistancesTableNode)
       self.outputDistancesTableComboBox.setCurrentNode(outputDistancesTableNode)
+    oneToOneCorrespondence = self.oneToOneCorrespondenceCheckBox.checked
     logic = PathVerificationLogic()
     logic.computeStatistics(referencePathsNode, comparePathsNode, \
                             compareToReferenceTransformNode, \
-                            outputDistancesTableNode, outputSummaryTableNode)
+                            outputDistancesTableNode, outputSummaryTableNode, \
+                            oneToOneCorrespondence)
 
   def onSegmentExportButton(self):
     segmentationNode = self.segmentationComboBox.currentNode()
@@ -396,129 +403,34 @@ class PathVerificationLogic(ScriptedLoadableModuleLogic):
   https://github.com/Slicer/Slicer/blob/master/Base/Python/slicer/ScriptedLoadableModule.py
   """
 
-  def exportSegmentsToPath( self, segmentationNode, pathsNode ):
-    segmentationsLogic = slicer.modules.segmentations.logic()
-    modelHierarchyNode = slicer.vtkMRMLModelHierarchyNode()
-    slicer.mrmlScene.AddNode( modelHierarchyNode )
-    modelHierarchyName = pathsNode.GetName() + "_Models"
-    modelHierarchyNode.SetName( modelHierarchyName )
-    segmentationsLogic.ExportVisibleSegmentsToModelHierarchy( segmentationNode, modelHierarchyNode )
+  # Shared by all instances, so the reference path index is kept between runs
+  verificationLogic = None
+
+  def getVerificationLogic( self ):
+    if PathVerificationLogic.verificationLogic is None:
+      PathVerificationLogic.verificationLogic = slicer.vtkSlicerPathVerificationLogic()
+    return PathVerificationLogic.verificationLogic
 
+  def exportSegmentsToPath( self, segmentationNode, pathsNode ):
     if not pathsNode.GetMarkupsToModelNode():
       markupsToModelNode = slicer.vtkMRMLMarkupsToModelNode()
       slicer.mrmlScene.AddNode( markupsToModelNode )
       pathsNode.SetAndObserveMarkupsToModelNodeID( markupsToModelNode.GetID() )
 
-    numberOfCatheters = modelHierarchyNode.GetNumberOfChildrenNodes()
-    for catheterIndex in xrange( 0, numberOfCatheters ):
-      catheterPointsNode = modelHierarchyNode.GetNthChildNode( catheterIndex ).GetModelNode()
-      catheterPointsNode.SetName( pathsNode.GetName() + "_CatheterPoints" + str( catheterIndex ) )
-      catheterPathNode = slicer.vtkMRMLModelNode()
-      slicer.mrmlScene.AddNode( catheterPathNode )
-      catheterPathNode.SetName( pathsNode.GetName() + "_CatheterPath" + str( catheterIndex ) )
-      catheterPathNode.CreateDefaultDisplayNodes()
-      pathsNode.AddPointsPathPairModelNodeIDs( catheterPointsNode.GetID(), catheterPathNode.GetID() )
+    # Each visible segment is reduced to ordered centerline points by the C++ logic
+    verificationLogic = self.getVerificationLogic()
+    if not verificationLogic.ExtractPathsFromSegmentation( segmentationNode, pathsNode ):
+      logging.error("No paths could be extracted from the segmentation.")
+      return False
+    return True
 
   def trimPoints( self, pathsNode, nearTrimDistance, farTrimDistance ):
     if not pathsNode:
       logging.error("Trim paths node is null.")
       return False
 
-    # Iterate through each path
-    suffixArray = vtk.vtkIntArray()
-    pathsNode.GetSuffixes( suffixArray )
-    numberOfSuffixes = suffixArray.GetNumberOfTuples()
-    if numberOfSuffixes <= 0:
-      logging.warning("There are no paths")
-      return
-    
-    # Record the direction of each catheter
-    directions = {}
-    for suffixIndex in xrange( 0, numberOfSuffixes ):
-      suffix = int(suffixArray.GetComponent( suffixIndex, 0 ) )
-      pointsModelNode = pathsNode.GetPointsModelNodeBySuffix( suffix )
-      points = pointsModelNode.GetPolyData().GetPoints()
-      # find farthest two points
-      firstPoint = points.GetPoint( 0 )
-      lastPoint = points.GetPoint( points.GetNumberOfPoints() - 1 )
-      direction = [ 0, 0, 0 ]
-      direction[ 0 ] = lastPoint[ 0 ] - firstPoint[ 0 ]
-      direction[ 1 ] = lastPoint[ 1 ] - firstPoint[ 1 ]
-      direction[ 2 ] = lastPoint[ 2 ] - firstPoint[ 2 ]
-      directions[ suffix ] = direction
-
-    # Determine the 'average' direction of catetheters
-    sumOfDirections = [ 0, 0, 0 ]
-    firstDirection = [ 0, 0, 0 ]
-    for suffixIndex in xrange( 0, numberOfSuffixes ):
-      suffix = int(suffixArray.GetComponent( suffixIndex, 0 ) )
-      direction = directions[ suffix ]
-      if suffixIndex == 0:
-        firstDirection = direction
-      invertDirection = ( vtk.vtkMath.Dot( firstDirection, direction ) > 0 )
-      if invertDirection == True:
-        sumOfDirections[ 0 ] -= direction[ 0 ]
-        sumOfDirections[ 1 ] -= direction[ 1 ]
-        sumOfDirections[ 2 ] -= direction[ 2 ]
-      else:
-        sumOfDirections[ 0 ] += direction[ 0 ]
-        sumOfDirections[ 1 ] += direction[ 1 ]
-        sumOfDirections[ 2 ] += direction[ 2 ]
-    averageDirection = [ 0, 0, 0 ]
-    averageDirection[ 0 ] = sumOfDirections[ 0 ] / numberOfSuffixes
-    averageDirection[ 1 ] = sumOfDirections[ 1 ] / numberOfSuffixes
-    averageDirection[ 2 ] = sumOfDirections[ 2 ] / numberOfSuffixes
-    vtk.vtkMath.Normalize( averageDirection )
-
-    # Determine threshold values for filtering out points
-    shortestMinimumAlongAverageDirection = float( "-inf" )
-    shortestMaximumAlongAverageDirection = float( "inf" )
-    for suffixIndex in xrange( 0, numberOfSuffixes ):
-      suffix = int(suffixArray.GetComponent( suffixIndex, 0 ) )
-      pointsModelNode = pathsNode.GetPointsModelNodeBySuffix( suffix )
-      points = pointsModelNode.GetPolyData().GetPoints()
-      numberOfPoints = points.GetNumberOfPoints()
-      minimumAlongAverageDirection = float( "inf" )
-      maximumAlongAverageDirection = float( "-inf" )
-      for pointIndex in xrange( 0, numberOfPoints ):
-        point = points.GetPoint( pointIndex )
-        pointAlongAverageDirection = vtk.vtkMath.Dot( point, averageDirection )
-        if pointAlongAverageDirection < minimumAlongAverageDirection:
-          minimumAlongAverageDirection = pointAlongAverageDirection
-        if pointAlongAverageDirection > maximumAlongAverageDirection:
-          maximumAlongAverageDirection = pointAlongAverageDirection
-      if minimumAlongAverageDirection > shortestMinimumAlongAverageDirection:
-        shortestMinimumAlongAverageDirection = minimumAlongAverageDirection
-      if maximumAlongAverageDirection < shortestMaximumAlongAverageDirection:
-        shortestMaximumAlongAverageDirection = maximumAlongAverageDirection
-    shortestMinimumAlongAverageDirection += nearTrimDistance
-    shortestMaximumAlongAverageDirection -= farTrimDistance
-    
-    # Do the actual filtering
-    for suffixIndex in xrange( 0, numberOfSuffixes ):
-      suffix = int(suffixArray.GetComponent( suffixIndex, 0 ) )
-      pointsModelNode = pathsNode.GetPointsModelNodeBySuffix( suffix )
-      points = pointsModelNode.GetPolyData().GetPoints()
-      numberOfPoints = points.GetNumberOfPoints()
-      # make new list of points that are within the non-trimmed region
-      newPoints = vtk.vtkPoints()
-      newVerts = vtk.vtkCellArray()
-      for pointIndex in xrange( 0, numberOfPoints ):
-        point = points.GetPoint( pointIndex )
-        pointAlongAverageDirection = vtk.vtkMath.Dot( point, averageDirection )
-        if pointAlongAverageDirection < shortestMinimumAlongAverageDirection:
-          continue
-        if pointAlongAverageDirection > shortestMaximumAlongAverageDirection:
-          continue
-        newPoints.InsertNextPoint( point )
-        newPointIndex = newPoints.GetNumberOfPoints() - 1
-        newVerts.InsertNextCell( 1, [ newPointIndex ] )
-      # assign to points model node
-      newPolyData = vtk.vtkPolyData()
-      newPolyData.SetVerts( newVerts )
-      newPolyData.SetPoints( newPoints )
-      pointsModelNode.SetAndObservePolyData( newPolyData )
-    return True
+    # Projection and filtering of the points is done by the C++ logic
+    return slicer.modules.pathreconstruction.logic().TrimPaths( pathsNode, nearTrimDistance, farTrimDistance )
   
   def refitPath( self, pathNode ):
     markupsToModelNode = pathNode.GetMarkupsToModelNode()
@@ -542,19 +454,6 @@ class PathVerificationLogic(ScriptedLoadableModuleLogic):
 
     return True
 
-  def computeCombinePolyData( self, pathsNode, combinedPolyData ):
-    appender = vtk.vtkAppendPolyData()
-    suffixArray = vtk.vtkIntArray()
-    pathsNode.GetSuffixes( suffixArray )
-    numberOfSuffixes = suffixArray.GetNumberOfTuples()
-    for suffixIndex in xrange( 0, numberOfSuffixes ):
-      suffix = int(suffixArray.GetComponent( suffixIndex, 0 ) )
-      pathModelNode = pathsNode.GetPathModelNodeBySuffix( suffix )
-      polyData = pathModelNode.GetPolyData()
-      appender.AddInputData( polyData )
-    appender.Update()
-    combinedPolyData.DeepCopy( appender.GetOutput() )
-
   def computeEndMarkups( self, pathsNode, endMarkupsNode ):
     endMarkupsNode.RemoveAllMarkups()
     suffixArray = vtk.vtkIntArray()
@@ -611,28 +510,13 @@ class PathVerificationLogic(ScriptedLoadableModuleLogic):
       logging.error("A node is null. Check nodes for null.")
       return False
 
-    referenceCombinedPolyData = vtk.vtkPolyData()
-    self.computeCombinePolyData( referencePathsNode, referenceCombinedPolyData )
-    compareCombinedPolyData = vtk.vtkPolyData()
-    self.computeCombinePolyData( comparePathsNode, compareCombinedPolyData )
-
     # transform is preliminary, only contains the initial alignment
-    # still need to run ICP on the combined model pairs
-    initialAlignmentTransform = compareToInitialTransformNode.GetTransformToParent()
-    initialAlignmentTransformFilter = vtk.vtkTransformPolyDataFilter()
-    initialAlignmentTransformFilter.SetTransform( initialAlignmentTransform )
-    initialAlignmentTransformFilter.SetInputData( compareCombinedPolyData )
-    initialAlignmentTransformFilter.Update()
-    initiallyAlignedCompareCombinedPolyData = initialAlignmentTransformFilter.GetOutput()
-    icpTransform = vtk.vtkIterativeClosestPointTransform()
-    icpTransform.SetSource( initiallyAlignedCompareCombinedPolyData )
-    icpTransform.SetTarget( referenceCombinedPolyData )
-    icpTransform.GetLandmarkTransform().SetModeToRigidBody()
-    icpTransform.Update()
-
-    icpMatrix = vtk.vtkMatrix4x4()
-    icpTransform.GetMatrix( icpMatrix )
-    initialToReferenceTransformNode.SetMatrixTransformToParent( icpMatrix )
+    # still need to run ICP on the combined paths (in parallel by the C++ logic)
+    verificationLogic = self.getVerificationLogic()
+    if not verificationLogic.ComputeRegistrationICP( referencePathsNode, comparePathsNode, \
+                                                     compareToInitialTransformNode, initialToReferenceTransformNode ):
+      logging.error("ICP registration failed.")
+      return False
 
     # Update transform hierarchy
     compareToInitialTransformNode.SetAndObserveTransformNodeID( initialToReferenceTransformNode.GetID() )
@@ -671,158 +555,20 @@ class PathVerificationLogic(ScriptedLoadableModuleLogic):
   
   def computeStatistics( self, referencePathsNode, comparePathsNode, \
                                compareToReferenceLinearTransformNode, \
-                               outputDistancesTableNode, outputSummaryTableNode ):
-    # set up the arrays that will go into the output table nodes
-    # these are for raw distances
-    distancesLabelArray = vtk.vtkStringArray()
-    distancesLabelArray.SetName( "Label" )
-    distancesSuffixArray = vtk.vtkIntArray()
-    distancesSuffixArray.SetName( "Suffix" )
-    distancesValueArray = vtk.vtkDoubleArray()
-    distancesValueArray.SetName( "Distance" )
-    # these are for summary statistics
-    summaryLabelArray = vtk.vtkStringArray()
-    summaryLabelArray.SetName( "Label" )
-    summarySuffixArray = vtk.vtkIntArray()
-    summarySuffixArray.SetName( "Suffix" )
-    summaryLengthArray = vtk.vtkDoubleArray()
-    summaryLengthArray.SetName( "Length" )
-    summaryInputPointCountArray = vtk.vtkIntArray()
-    summaryInputPointCountArray.SetName( "Point Count" )
-    summaryDistanceCountArray = vtk.vtkIntArray()
-    summaryDistanceCountArray.SetName( "Distance Count" )
-    summaryMeanArray = vtk.vtkDoubleArray()
-    summaryMeanArray.SetName( "Mean" )
-    summaryStdevArray = vtk.vtkDoubleArray()
-    summaryStdevArray.SetName( "Stdev" )
-    summaryPercentile000Array = vtk.vtkDoubleArray()
-    summaryPercentile000Array.SetName( "0th Percentile")
-    summaryPercentile005Array = vtk.vtkDoubleArray()
-    summaryPercentile005Array.SetName( "5th Percentile")
-    summaryPercentile025Array = vtk.vtkDoubleArray()
-    summaryPercentile025Array.SetName( "25th Percentile")
-    summaryPercentile050Array = vtk.vtkDoubleArray()
-    summaryPercentile050Array.SetName( "50th Percentile")
-    summaryPercentile075Array = vtk.vtkDoubleArray()
-    summaryPercentile075Array.SetName( "75th Percentile")
-    summaryPercentile095Array = vtk.vtkDoubleArray()
-    summaryPercentile095Array.SetName( "95th Percentile")
-    summaryPercentile100Array = vtk.vtkDoubleArray()
-    summaryPercentile100Array.SetName( "100th Percentile")
-    summaryAngleDifferenceDegrees = vtk.vtkDoubleArray()
-    summaryAngleDifferenceDegrees.SetName( "Angle Difference (Degrees)")
-
-    # compute them
-    comparePathsName = comparePathsNode.GetName() # used as a general text label in the outputs
-    compareSuffixArray = vtk.vtkIntArray()
-    comparePathsNode.GetSuffixes( compareSuffixArray )
-    numberOfCompareSuffixes = compareSuffixArray.GetNumberOfTuples()
-    for compareSuffixIndex in xrange( 0, numberOfCompareSuffixes ):
-      compareSuffix = int(compareSuffixArray.GetComponent( compareSuffixIndex, 0 ) )
-      comparePathModelNode = comparePathsNode.GetPathModelNodeBySuffix( compareSuffix )
-      unregisteredComparePathPolyData = comparePathModelNode.GetPolyData()
-      compareToReferenceTransformFilter = vtk.vtkTransformPolyDataFilter()
-      compareToReferenceTransformFilter.SetTransform( compareToReferenceLinearTransformNode.GetTransformToParent() )
-      compareToReferenceTransformFilter.SetInputData( unregisteredComparePathPolyData )
-      compareToReferenceTransformFilter.Update()
-      registeredComparePathPolyData = compareToReferenceTransformFilter.GetOutput()
-
-      # Find the corresponding path node
-      correspondingReferencePathPolyData = None
-      distanceToCorrespondingPathNode = float("inf")
-      comparePathCenterOfMassFilter = vtk.vtkCenterOfMass()
-      comparePathCenterOfMassFilter.SetInputData( registeredComparePathPolyData )
-      comparePathCenterOfMassFilter.Update()
-      comparePathCenterOfMass = comparePathCenterOfMassFilter.GetCenter()
-      referenceSuffixArray = vtk.vtkIntArray()
-      referencePathsNode.GetSuffixes( referenceSuffixArray )
-      numberOfReferenceSuffixes = referenceSuffixArray.GetNumberOfTuples()
-      for referenceSuffixIndex in xrange( 0, numberOfReferenceSuffixes ):
-        referenceSuffix = int(referenceSuffixArray.GetComponent( referenceSuffixIndex, 0 ) )
-        referencePathModelNode = referencePathsNode.GetPathModelNodeBySuffix( referenceSuffix )
-        referencePathCenterOfMassFilter = vtk.vtkCenterOfMass()
-        referencePathPolyData = referencePathModelNode.GetPolyData()
-        referencePathCenterOfMassFilter.SetInputData( referencePathModelNode.GetPolyData() )
-        referencePathCenterOfMassFilter.Update()
-        referencePathCenterOfMass = referencePathCenterOfMassFilter.GetCenter()
-        distanceToReferencePath = vtk.vtkMath.Distance2BetweenPoints( comparePathCenterOfMass, referencePathCenterOfMass )
-        if ( distanceToReferencePath < distanceToCorrespondingPathNode ):
-          distanceToCorrespondingPathNode = distanceToReferencePath
-          correspondingReferencePathPolyData = referencePathPolyData
-
-      # Measure distances between the two paths
-      polyDataDistanceFilter = slicer.vtkPolyDataDistanceHistogramFilter()
-      polyDataDistanceFilter.SetInputComparePolyData( registeredComparePathPolyData )
-      polyDataDistanceFilter.SetInputReferencePolyData( correspondingReferencePathPolyData )
-      polyDataDistanceFilter.Update()
-
-      rawDistances = polyDataDistanceFilter.GetOutputDistances()
-      numberOfRawDistances = rawDistances.GetNumberOfTuples()
-      for rawDistanceIndex in xrange( 0, numberOfRawDistances ):
-        distancesLabelArray.InsertNextValue( comparePathsName )
-        distancesSuffixArray.InsertNextTuple1( compareSuffix )
-        rawDistance = rawDistances.GetComponent( rawDistanceIndex, 0 )
-        distancesValueArray.InsertNextTuple1( rawDistance )
-
-      # Measure angle difference
-      comparePolyDataPoints = registeredComparePathPolyData.GetPoints()
-      comparePathFirstPoint = comparePolyDataPoints.GetPoint(0)
-      comparePathLastPoint = comparePolyDataPoints.GetPoint(comparePolyDataPoints.GetNumberOfPoints()-1)
-      comparePathDirection = [ 0, 0, 0 ]
-      comparePathDirection[ 0 ] = comparePathLastPoint[ 0 ] - comparePathFirstPoint[ 0 ]
-      comparePathDirection[ 1 ] = comparePathLastPoint[ 1 ] - comparePathFirstPoint[ 1 ]
-      comparePathDirection[ 2 ] = comparePathLastPoint[ 2 ] - comparePathFirstPoint[ 2 ]
-      referencePolyDataPoints = correspondingReferencePathPolyData.GetPoints()
-      referencePathFirstPoint = referencePolyDataPoints.GetPoint(0)
-      referencePathLastPoint = referencePolyDataPoints.GetPoint(referencePolyDataPoints.GetNumberOfPoints()-1)
-      referencePathDirection = [ 0, 0, 0 ]
-      referencePathDirection[ 0 ] = referencePathLastPoint[ 0 ] - referencePathFirstPoint[ 0 ]
-      referencePathDirection[ 1 ] = referencePathLastPoint[ 1 ] - referencePathFirstPoint[ 1 ]
-      referencePathDirection[ 2 ] = referencePathLastPoint[ 2 ] - referencePathFirstPoint[ 2 ]
-      angleDifferenceRadians = vtk.vtkMath.AngleBetweenVectors(comparePathDirection,referencePathDirection)
-      angleDifferenceDegrees = angleDifferenceRadians * 180 / vtk.vtkMath.Pi()
-
-      summaryLabelArray.InsertNextValue( comparePathsName )
-      summarySuffixArray.InsertNextTuple1( compareSuffix )
-      catheterLength = float( comparePathModelNode.GetAttribute( slicer.vtkMRMLMarkupsToModelNode.GetOutputCurveLengthAttributeName() ) )
-      summaryLengthArray.InsertNextTuple1( catheterLength )
-      comparePointsModelNode = comparePathsNode.GetPointsModelNodeBySuffix( compareSuffix )
-      numberOfPoints = comparePointsModelNode.GetPolyData().GetPoints().GetNumberOfPoints()
-      summaryInputPointCountArray.InsertNextTuple1( numberOfPoints )
-      summaryDistanceCountArray.InsertNextTuple1( numberOfRawDistances / 4 )
-      summaryMeanArray.InsertNextTuple1( polyDataDistanceFilter.GetAverageHausdorffDistance() )
-      summaryStdevArray.InsertNextTuple1( polyDataDistanceFilter.GetStandardDeviationHausdorffDistance() )
-      summaryPercentile000Array.InsertNextTuple1( polyDataDistanceFilter.GetNthPercentileHausdorffDistance( 0 ) )
-      summaryPercentile005Array.InsertNextTuple1( polyDataDistanceFilter.GetNthPercentileHausdorffDistance( 5 ) )
-      summaryPercentile025Array.InsertNextTuple1( polyDataDistanceFilter.GetNthPercentileHausdorffDistance( 25 ) )
-      summaryPercentile050Array.InsertNextTuple1( polyDataDistanceFilter.GetNthPercentileHausdorffDistance( 50 ) )
-      summaryPercentile075Array.InsertNextTuple1( polyDataDistanceFilter.GetNthPercentileHausdorffDistance( 75 ) )
-      summaryPercentile095Array.InsertNextTuple1( polyDataDistanceFilter.GetNthPercentileHausdorffDistance( 95 ) )
-      summaryPercentile100Array.InsertNextTuple1( polyDataDistanceFilter.GetNthPercentileHausdorffDistance( 100 ) )
-      summaryAngleDifferenceDegrees.InsertNextTuple1( angleDifferenceDegrees )
-      # Label, catheter suffix, mean distance, stdev, 0th, 5th, 25th, 50th, 75th, 95th, 100th, angle difference
-
-    # Assign the arrays to the table nodes
-    outputDistancesTableNode.RemoveAllColumns()
-    outputDistancesTableNode.AddColumn( distancesLabelArray )
-    outputDistancesTableNode.AddColumn( distancesSuffixArray )
-    outputDistancesTableNode.AddColumn( distancesValueArray )
-    outputSummaryTableNode.RemoveAllColumns()
-    outputSummaryTableNode.AddColumn( summaryLabelArray )
-    outputSummaryTableNode.AddColumn( summarySuffixArray )
-    outputSummaryTableNode.AddColumn( summaryLengthArray )
-    outputSummaryTableNode.AddColumn( summaryInputPointCountArray )
-    outputSummaryTableNode.AddColumn( summaryDistanceCountArray )
-    outputSummaryTableNode.AddColumn( summaryMeanArray )
-    outputSummaryTableNode.AddColumn( summaryStdevArray )
-    outputSummaryTableNode.AddColumn( summaryPercentile000Array )
-    outputSummaryTableNode.AddColumn( summaryPercentile005Array )
-    outputSummaryTableNode.AddColumn( summaryPercentile025Array )
-    outputSummaryTableNode.AddColumn( summaryPercentile050Array )
-    outputSummaryTableNode.AddColumn( summaryPercentile075Array )
-    outputSummaryTableNode.AddColumn( summaryPercentile095Array )
-    outputSummaryTableNode.AddColumn( summaryPercentile100Array )
-    outputSummaryTableNode.AddColumn( summaryAngleDifferenceDegrees )
+                               outputDistancesTableNode, outputSummaryTableNode, \
+                               oneToOneCorrespondence=False ):
+    # Correspondences and distances are computed in parallel by the C++ logic.
+    # Distances table columns: Label, Suffix, Distance
+    # Summary table columns: Label, Suffix, Length, Point Count, Distance Count, Mean, Stdev,
+    # 0th, 5th, 25th, 50th, 75th, 95th, 100th Percentile, Angle Difference (Degrees), Reference Suffix
+    verificationLogic = self.getVerificationLogic()
+    if oneToOneCorrespondence:
+      verificationLogic.SetCorrespondenceMethodToOneToOne()
+    else:
+      verificationLogic.SetCorrespondenceMethodToNearestCentroid()
+    return verificationLogic.ComputeStatistics( referencePathsNode, comparePathsNode, \
+                                                compareToReferenceLinearTransformNode, \
+                                                outputDistancesTableNode, outputSummaryTableNode )
 
 class PathVerificationTest(ScriptedLoadableModuleTest):
   """